@@ -0,0 +1,188 @@
+/*  Reference library for one-to-many trajectory queries
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __LIBRARY_H__
+#define __LIBRARY_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Trajectory.hpp"
+#include "PointDistance.hpp"
+#include "Pairwise.hpp"
+#include "LowerBounds.hpp"
+#include "../Hausdorff distance/Hausdorff.hpp"
+#include "../Hausdorff distance/HausdorffIndex.hpp"
+#include "../Frechet_distance/Frechet.hpp"
+
+namespace DistanceMetrics
+{
+    /* @brief A fixed set of reference trajectories, pre-processed once so that many queries can be answered against it.
+     *
+     * The references are copied into one flat TrajectoryBatch. Each one is also packed and shuffled once as a
+     * Hausdorff::PreparedTrajectory, which caches its permutation and bounding box, and references of at least
+     * indexThreshold points get a Hausdorff::KdTree as well. A query therefore only pays for preparing itself.
+     */
+    template <typename T>
+    class Library
+    {
+    public:
+        /* @brief Pre-processes a batch of references, which must all be non-empty.
+           @param[in] references The reference trajectories.
+           @param[in] indexThreshold Smallest reference (and query) size for which Hausdorff uses k-d trees.
+           @param[in] seed Seed of the cached permutations; reference t uses seed + t, so results are reproducible.
+        */
+        explicit Library(TrajectoryBatch<T> references, std::size_t indexThreshold = 1024, std::uint64_t seed = 0)
+            : batch_(std::move(references)), indexThreshold_(indexThreshold)
+        {
+            prepared_.reserve(batch_.size());
+            trees_.resize(batch_.size());
+            for (std::size_t t = 0; t < batch_.size(); ++t)
+            {
+                const TrajectoryView<T> reference = batch_.view(t);
+                if (reference.empty())
+                {
+                    throw std::runtime_error("One of the trajectories passed to Library is empty.");
+                }
+                prepared_.emplace_back(reference, seed + t);
+                if (reference.size() >= indexThreshold_) trees_[t].reset(new Hausdorff::KdTree<T>(reference));
+            }
+        }
+
+        explicit Library(const std::vector<TrajectoryView<T>>& references, std::size_t indexThreshold = 1024, std::uint64_t seed = 0)
+            : Library(TrajectoryBatch<T>(references), indexThreshold, seed)
+        {
+        }
+
+        std::size_t size() const { return batch_.size(); }
+        std::size_t dimension() const { return batch_.dimension(); }
+        bool empty() const { return batch_.empty(); }
+        TrajectoryView<T> view(std::size_t t) const { return batch_.view(t); }
+        const TrajectoryBatch<T>& batch() const { return batch_; }
+
+        /* @brief Finds the k references nearest to a query.
+         *
+         * Every reference is first given an O(dimension) lower bound from the cached bounding boxes (and, for Frechet,
+         * the endpoints), and the candidates are evaluated in order of that bound by threads. All threads share the
+         * current k-th best distance: it is the cutoff handed to the early-abandoning variants of the distances, and a
+         * candidate whose bound exceeds it is skipped without being read. Because the candidates are sorted by bound,
+         * once one is skipped every later one is too.
+           @returns Up to k neighbours, nearest first.
+           @param[in] query The query trajectory, of the library's dimension.
+           @param[in] k Number of neighbours to return.
+           @param[in] metric Which distance to use; Hausdorff is the symmetric Hausdorff distance.
+           @param[in] threads Number of worker threads; 0 uses every hardware thread.
+        */
+        std::vector<Neighbour> nearest(const TrajectoryView<T>& query, std::size_t k, Metric metric, unsigned threads = 0) const
+        {
+            if (query.empty())
+            {
+                throw std::runtime_error("The query passed to Library::nearest is empty.");
+            }
+            if (!empty() && query.dimension() != dimension())
+            {
+                throw std::runtime_error("The query passed to Library::nearest has the wrong dimension.");
+            }
+            if (k == 0 || empty()) return std::vector<Neighbour>();
+            threads = detail::resolveThreads(threads);
+
+            const Hausdorff::PreparedTrajectory<T> preparedQuery(query);
+            std::unique_ptr<Hausdorff::KdTree<T>> queryTree;
+            if (metric == Metric::Hausdorff && query.size() >= indexThreshold_) queryTree.reset(new Hausdorff::KdTree<T>(query));
+
+            std::vector<T> bounds(size());
+            for (std::size_t t = 0; t < size(); ++t) bounds[t] = lowerBound(preparedQuery, query, t, metric);
+            std::vector<std::size_t> order(size());
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::sort(order.begin(), order.end(), [&](std::size_t x, std::size_t y) { return bounds[x] < bounds[y]; });
+
+            auto further = [](const Neighbour& x, const Neighbour& y) { return x.distance < y.distance; };
+            std::priority_queue<Neighbour, std::vector<Neighbour>, decltype(further)> best(further);  // Top is the k-th best
+            std::mutex bestMutex;
+            std::atomic<double> threshold(std::numeric_limits<double>::infinity());
+            std::vector<Frechet::Workspace<T>> workspaces(metric == Metric::Frechet ? threads : 0);
+            std::vector<Hausdorff::Workspace<T>> treeWorkspaces(queryTree ? threads : 0);
+
+            detail::parallelFor(order.size(), threads, [&](unsigned worker, std::size_t position)
+            {
+                const std::size_t t = order[position];
+                const double limit = threshold.load(std::memory_order_acquire);
+                if (bounds[t] > limit) return;
+                double distance = 0.0;
+                if (metric == Metric::Frechet)
+                {
+                    distance = Frechet::frechetDistance(query, batch_.view(t), limit, workspaces[worker]);
+                }
+                else if (queryTree && trees_[t])
+                {
+                    distance = symmetricHausdorffDistance(*queryTree, *trees_[t], limit, treeWorkspaces[worker]);
+                }
+                else
+                {
+                    distance = symmetricHausdorffDistance(preparedQuery, prepared_[t], limit);
+                }
+
+                std::lock_guard<std::mutex> lock(bestMutex);
+                const bool full = best.size() == k;
+                if (full && !(distance < best.top().distance)) return;
+                if (full) best.pop();
+                best.push(Neighbour { t, distance });
+                if (best.size() == k) threshold.store(best.top().distance, std::memory_order_release);
+            });
+
+            std::vector<Neighbour> result(best.size());
+            for (std::size_t idx = result.size(); idx > 0; --idx)
+            {
+                result[idx - 1] = best.top();
+                best.pop();
+            }
+            return result;
+        }
+
+        std::vector<Neighbour> nearest(const std::vector<std::vector<T>>& query, std::size_t k, Metric metric, unsigned threads = 0) const
+        {
+            const Trajectory<T> packed(query);
+            return nearest(packed.view(), k, metric, threads);
+        }
+
+    private:
+        /* @brief Lower bound on the distance from the query to reference t, from the cached boxes and the endpoints. */
+        T lowerBound(const Hausdorff::PreparedTrajectory<T>& preparedQuery, const TrajectoryView<T>& query, std::size_t t, Metric metric) const
+        {
+            const Hausdorff::PreparedTrajectory<T>& reference = prepared_[t];
+            const T box = std::max(Hausdorff::detail::boxLowerBound(preparedQuery.lower(), preparedQuery.upper(), reference.lower(), reference.upper(), dimension()),
+                                   Hausdorff::detail::boxLowerBound(reference.lower(), reference.upper(), preparedQuery.lower(), preparedQuery.upper(), dimension()));
+            const T bound = std::sqrt(box);
+            return metric == Metric::Frechet ? std::max(bound, endpointLowerBound<T>(query, batch_.view(t))) : bound;
+        }
+
+        TrajectoryBatch<T> batch_;
+        std::size_t indexThreshold_;
+        std::vector<Hausdorff::PreparedTrajectory<T>> prepared_;
+        std::vector<std::unique_ptr<Hausdorff::KdTree<T>>> trees_;
+    };
+};
+#endif
@@ -0,0 +1,152 @@
+/*  Lower bounds and filter-and-refine search
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __LOWER_BOUNDS_H__
+#define __LOWER_BOUNDS_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <vector>
+#include "Trajectory.hpp"
+#include "PointDistance.hpp"
+#include "Pairwise.hpp"
+
+namespace DistanceMetrics
+{
+    /* @brief Distance between the first points and between the last points of two trajectories, whichever is larger.
+     *        Every Frechet coupling pairs both, so this is a lower bound on the Frechet distance; it says nothing
+     *        about the Hausdorff distance.
+       @returns The endpoint lower bound; O(1).
+    */
+    template <typename T, typename PointSetA, typename PointSetB>
+    T endpointLowerBound(const PointSetA& a, const PointSetB& b)
+    {
+        return std::sqrt(std::max(squaredDistance<T>(a, 0, b, 0), squaredDistance<T>(a, a.size() - 1, b, b.size() - 1)));
+    }
+
+    /* @brief Lower bound on the symmetric Hausdorff distance, and therefore on the Frechet distance, computed from the
+     *        bounding boxes of the two trajectories: the gap between the boxes, or how far either box sticks out of the
+     *        other along one axis.
+       @returns The bounding-box lower bound; O(n + m).
+    */
+    template <typename T, typename PointSetA, typename PointSetB>
+    T boundingBoxLowerBound(const PointSetA& a, const PointSetB& b)
+    {
+        std::vector<T> lowerA, upperA, lowerB, upperB;
+        Hausdorff::detail::boundingBox(a, lowerA, upperA);
+        Hausdorff::detail::boundingBox(b, lowerB, upperB);
+        return std::sqrt(std::max(Hausdorff::detail::boxLowerBound(lowerA.data(), upperA.data(), lowerB.data(), upperB.data(), a.dimension()),
+                                  Hausdorff::detail::boxLowerBound(lowerB.data(), upperB.data(), lowerA.data(), upperA.data(), a.dimension())));
+    }
+
+    /* @brief Distance between the centroids of two trajectories.
+     *
+     * This is *not* a lower bound on either metric (a trajectory that lingers near one end moves its centroid without
+     * changing either distance), so it is only used to order candidates, never to reject them.
+       @returns The centroid distance; O(n + m).
+    */
+    template <typename T, typename PointSetA, typename PointSetB>
+    T centroidDistance(const PointSetA& a, const PointSetB& b)
+    {
+        T sum = 0.0;
+        for (std::size_t k = 0; k < a.dimension(); ++k)
+        {
+            T centroidA = 0.0, centroidB = 0.0;
+            for (std::size_t i = 0; i < a.size(); ++i) centroidA += a(i, k);
+            for (std::size_t j = 0; j < b.size(); ++j) centroidB += b(j, k);
+            const T difference = centroidA / static_cast<T>(a.size()) - centroidB / static_cast<T>(b.size());
+            sum += difference * difference;
+        }
+        return std::sqrt(sum);
+    }
+
+    /* @brief Tightest of the valid lower bounds above for the given metric.
+       @returns A lower bound on the distance between a and b; O(n + m).
+    */
+    template <typename T>
+    T lowerBound(const TrajectoryView<T>& a, const TrajectoryView<T>& b, Metric metric)
+    {
+        Hausdorff::detail::checkInputs(a, b);
+        const T box = boundingBoxLowerBound<T>(a, b);
+        return metric == Metric::Frechet ? std::max(box, endpointLowerBound<T>(a, b)) : box;
+    }
+
+    /* @brief One result of a nearest-trajectory search. */
+    struct Neighbour
+    {
+        std::size_t index;  // Position in the reference set
+        double distance;
+    };
+
+    /* @brief Finds the k references nearest to a query trajectory by filter-and-refine.
+     *
+     * Candidates are visited in order of centroid distance, so that close references are usually refined first and the
+     * k-th best distance tightens quickly. A candidate whose lower bound already exceeds the current k-th best is
+     * skipped; the others are refined with the cutoff variants of symmetricHausdorffDistance and frechetDistance,
+     * which abandon the exact computation as soon as it cannot enter the result.
+       @returns Up to k neighbours, nearest first.
+       @param[in] query The query trajectory.
+       @param[in] references The reference trajectories, all of the query's dimension.
+       @param[in] k Number of neighbours to return.
+       @param[in] metric Which distance to use; Hausdorff is the symmetric Hausdorff distance.
+    */
+    template <typename T>
+    std::vector<Neighbour> nearestNeighbours(const TrajectoryView<T>& query, const std::vector<TrajectoryView<T>>& references, std::size_t k, Metric metric)
+    {
+        const std::size_t count = references.size();
+        std::vector<T> bounds(count), order(count);
+        for (std::size_t r = 0; r < count; ++r)
+        {
+            bounds[r] = lowerBound(query, references[r], metric);
+            order[r] = centroidDistance<T>(query, references[r]);
+        }
+        std::vector<std::size_t> candidates(count);
+        std::iota(candidates.begin(), candidates.end(), std::size_t(0));
+        std::sort(candidates.begin(), candidates.end(), [&](std::size_t x, std::size_t y) { return order[x] < order[y]; });
+
+        auto further = [](const Neighbour& x, const Neighbour& y) { return x.distance < y.distance; };
+        std::priority_queue<Neighbour, std::vector<Neighbour>, decltype(further)> best(further);  // Top is the k-th best
+        Hausdorff::Workspace<T> hausdorffWorkspace;
+        Frechet::Workspace<T> frechetWorkspace;
+        for (std::size_t r : candidates)
+        {
+            if (k == 0) break;
+            const bool full = best.size() == k;
+            /* Kept in double: rounded to a float T, the k-th best could fall below itself and abandon an equal candidate */
+            const double cutoff = full ? best.top().distance : std::numeric_limits<double>::infinity();
+            if (full && bounds[r] > cutoff) continue;
+            const double distance = (metric == Metric::Hausdorff)
+                ? symmetricHausdorffDistance(query, references[r], cutoff, hausdorffWorkspace)
+                : Frechet::frechetDistance(query, references[r], cutoff, frechetWorkspace);
+            if (full && !(distance < best.top().distance)) continue;
+            if (full) best.pop();
+            best.push(Neighbour { r, distance });
+        }
+
+        std::vector<Neighbour> result(best.size());
+        for (std::size_t idx = result.size(); idx > 0; --idx)
+        {
+            result[idx - 1] = best.top();
+            best.pop();
+        }
+        return result;
+    }
+};
+#endif
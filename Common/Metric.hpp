@@ -0,0 +1,257 @@
+/*  Point metric policies
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __METRIC_H__
+#define __METRIC_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "Trajectory.hpp"
+#include "PointDistance.hpp"
+
+/* Both engines only ever compare point distances and take maxima and minima of them, so they work on any value that is
+ * monotone in the distance and convert once at the end. Every policy therefore provides:
+ *
+ *   measure<D>(a, i, b, j)  the comparable value between point i of a and point j of b (e.g. the squared distance)
+ *   finish(value)           the distance corresponding to a comparable value (e.g. its square root)
+ *   threshold(distance)     the largest comparable value whose finished distance is at most distance, so that a cutoff
+ *                           compares exactly as it would against finished distances; negative distances map below
+ *                           every value
+ *   check(dimension)        throws if the policy cannot be used with trajectories of that dimension
+ *
+ * D is the compile-time dimension, or DynamicDimension.
+ */
+namespace DistanceMetrics
+{
+    namespace metrics
+    {
+        namespace detail
+        {
+            /* @brief Nudges guess, a rounded comparable value of distance, to the largest value that finishes to at most distance. */
+            template <typename T, typename Distance, typename Finish>
+            T exactThreshold(T guess, Distance distance, Finish&& finish)
+            {
+                const T infinity = std::numeric_limits<T>::infinity();
+                if (!(guess < infinity)) return guess;
+                for (int step = 0; step < 64 && guess >= 0 && finish(guess) > distance; ++step) guess = std::nextafter(guess, -infinity);
+                for (int step = 0; step < 64; ++step)
+                {
+                    const T next = std::nextafter(guess, infinity);
+                    if (!(finish(next) <= distance)) break;
+                    guess = next;
+                }
+                return guess;
+            }
+
+            template <typename T>
+            T squaredThreshold(T distance)
+            {
+                if (distance < 0) return T(-1);
+                return exactThreshold(distance * distance, distance, [](T value) { return std::sqrt(value); });
+            }
+        };
+
+        /* @brief Base of every point metric policy; used to tell policies apart from cutoffs in overload resolution. */
+        struct Policy
+        {
+            void check(std::size_t) const {}
+        };
+
+        template <typename P>
+        using IsPolicy = std::is_base_of<Policy, P>;
+
+        /* @brief Euclidean distance, compared as squared distances with a single square root at the end. This is
+         *        the metric of the overloads that take no policy, and it uses the SIMD kernels.
+        */
+        template <typename T>
+        struct Euclidean : Policy
+        {
+            template <std::size_t D = DynamicDimension, typename PointSetA, typename PointSetB>
+            T measure(const PointSetA& a, std::size_t i, const PointSetB& b, std::size_t j) const
+            {
+                return squaredDistance<T, D>(a, i, b, j);
+            }
+            T finish(T value) const { return std::sqrt(value); }
+            T threshold(T distance) const { return detail::squaredThreshold(distance); }
+        };
+
+        /* @brief Squared Euclidean distance itself; like Euclidean without the final square root, and also SIMD. */
+        template <typename T>
+        struct SquaredEuclidean : Policy
+        {
+            template <std::size_t D = DynamicDimension, typename PointSetA, typename PointSetB>
+            T measure(const PointSetA& a, std::size_t i, const PointSetB& b, std::size_t j) const
+            {
+                return squaredDistance<T, D>(a, i, b, j);
+            }
+            T finish(T value) const { return value; }
+            T threshold(T distance) const { return distance; }
+        };
+
+        /* @brief Euclidean distance with a non-negative weight per coordinate, sqrt(sum_k w_k (a_k - b_k)^2), for state
+         *        vectors that mix positions and velocities.
+         *
+         * Hausdorff applies sqrt(w) while packing both trajectories into its workspace, after which the weighted distance is
+         * the plain Euclidean distance and the SIMD kernels apply; scale() exposes the same transformation, so that scaled
+         * copies can be prepared once for use across many calls.
+         */
+        template <typename T>
+        struct WeightedEuclidean : Policy
+        {
+            explicit WeightedEuclidean(std::vector<T> w) : weights(std::move(w))
+            {
+                for (T weight : weights)
+                {
+                    if (!(weight >= 0)) throw std::runtime_error("The weights passed to WeightedEuclidean must be non-negative.");
+                }
+            }
+
+            void check(std::size_t dimension) const
+            {
+                if (weights.size() != dimension)
+                {
+                    throw std::runtime_error("WeightedEuclidean needs one weight per coordinate.");
+                }
+            }
+
+            template <std::size_t D = DynamicDimension, typename PointSetA, typename PointSetB>
+            T measure(const PointSetA& a, std::size_t i, const PointSetB& b, std::size_t j) const
+            {
+                using A = AccumulatorType<T>;
+                const std::size_t dimension = (D == DynamicDimension) ? a.dimension() : D;
+                A sum = 0.0;
+                for (std::size_t k = 0; k < dimension; ++k) sum += static_cast<A>(weights[k]) * DistanceMetrics::detail::squaredDifference<A>(a(i, k), b(j, k));
+                return static_cast<T>(sum);
+            }
+            T finish(T value) const { return std::sqrt(value); }
+            T threshold(T distance) const { return detail::squaredThreshold(distance); }
+
+            /* @brief Copy of a point set with coordinate k multiplied by sqrt(w_k). */
+            template <typename PointSet>
+            Trajectory<T> scale(const PointSet& points) const
+            {
+                check(points.dimension());
+                Trajectory<T> scaled(points.size(), points.dimension());
+                for (std::size_t k = 0; k < points.dimension(); ++k)
+                {
+                    const T factor = std::sqrt(weights[k]);
+                    for (std::size_t i = 0; i < points.size(); ++i) scaled(i, k) = points(i, k) * factor;
+                }
+                return scaled;
+            }
+
+            std::vector<T> weights;
+        };
+
+        /* @brief Euclidean distance under periodic boundary conditions (minimum image), for phase angles or periodic
+         *        simulation boxes. An axis with period 0 is not periodic.
+        */
+        template <typename T>
+        struct Periodic : Policy
+        {
+            explicit Periodic(std::vector<T> p) : periods(std::move(p))
+            {
+                for (T period : periods)
+                {
+                    if (!(period >= 0)) throw std::runtime_error("The periods passed to Periodic must be non-negative.");
+                }
+            }
+
+            void check(std::size_t dimension) const
+            {
+                if (periods.size() != dimension)
+                {
+                    throw std::runtime_error("Periodic needs one period per coordinate.");
+                }
+            }
+
+            template <std::size_t D = DynamicDimension, typename PointSetA, typename PointSetB>
+            T measure(const PointSetA& a, std::size_t i, const PointSetB& b, std::size_t j) const
+            {
+                using A = AccumulatorType<T>;
+                const std::size_t dimension = (D == DynamicDimension) ? a.dimension() : D;
+                A sum = 0.0;
+                for (std::size_t k = 0; k < dimension; ++k)
+                {
+                    A difference = std::abs(static_cast<A>(a(i, k)) - static_cast<A>(b(j, k)));
+                    const A period = periods[k];
+                    if (period > 0)
+                    {
+                        difference = std::fmod(difference, period);
+                        difference = std::min(difference, period - difference);
+                    }
+                    sum += difference * difference;
+                }
+                return static_cast<T>(sum);
+            }
+            T finish(T value) const { return std::sqrt(value); }
+            T threshold(T distance) const { return detail::squaredThreshold(distance); }
+
+            std::vector<T> periods;
+        };
+
+        /* @brief Great-circle distance on a sphere between points given as (latitude, longitude) in radians.
+         *
+         * The comparable value is the haversine h = sin^2(dlat / 2) + cos(lat1) cos(lat2) sin^2(dlon / 2), which is
+         * monotone in the distance 2 R asin(sqrt(h)); the inverse trigonometry is only evaluated once per result.
+         */
+        template <typename T>
+        struct GreatCircle : Policy
+        {
+            explicit GreatCircle(T r = 1) : radius(r) {}
+
+            void check(std::size_t dimension) const
+            {
+                if (dimension != 2)
+                {
+                    throw std::runtime_error("GreatCircle needs (latitude, longitude) points.");
+                }
+            }
+
+            template <std::size_t D = DynamicDimension, typename PointSetA, typename PointSetB>
+            T measure(const PointSetA& a, std::size_t i, const PointSetB& b, std::size_t j) const
+            {
+                using A = AccumulatorType<T>;
+                const A latitudeA = a(i, 0), latitudeB = b(j, 0);
+                const A sinLatitude = std::sin((latitudeB - latitudeA) / 2);
+                const A sinLongitude = std::sin((static_cast<A>(b(j, 1)) - static_cast<A>(a(i, 1))) / 2);
+                return static_cast<T>(sinLatitude * sinLatitude + std::cos(latitudeA) * std::cos(latitudeB) * sinLongitude * sinLongitude);
+            }
+            T finish(T value) const
+            {
+                if (!(value < std::numeric_limits<T>::infinity())) return value;
+                return 2 * radius * std::asin(std::sqrt(std::min(T(1), value)));
+            }
+            T threshold(T distance) const
+            {
+                if (distance < 0) return T(-1);
+                /* Nothing on the sphere is further apart than half a great circle */
+                const T half = distance / (2 * radius);
+                if (half >= std::acos(T(-1)) / 2) return std::numeric_limits<T>::infinity();
+                const T s = std::sin(half);
+                return detail::exactThreshold(s * s, distance, [this](T value) { return finish(value); });
+            }
+
+            T radius;
+        };
+    };
+};
+#endif
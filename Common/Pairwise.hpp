@@ -0,0 +1,279 @@
+/*  Pairwise distance engine
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __PAIRWISE_H__
+#define __PAIRWISE_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "Trajectory.hpp"
+#include "../Hausdorff distance/Hausdorff.hpp"
+#include "../Frechet_distance/Frechet.hpp"
+
+namespace DistanceMetrics
+{
+    /* @brief Trajectory distances available to the batched engines. Hausdorff is the symmetric Hausdorff distance,
+     *        as a condensed matrix only makes sense for a symmetric metric.
+    */
+    enum class Metric
+    {
+        Hausdorff,
+        Frechet
+    };
+
+    /* @brief Number of entries in the condensed (upper-triangle, row-major) form of an N x N distance matrix. */
+    inline std::size_t condensedSize(std::size_t count)
+    {
+        return count < 2 ? 0 : count * (count - 1) / 2;
+    }
+
+    /* @brief Position of the pair (i, j), i < j, in a condensed distance matrix, matching scipy.spatial.distance.pdist. */
+    inline std::size_t condensedIndex(std::size_t count, std::size_t i, std::size_t j)
+    {
+        return count * i - i * (i + 1) / 2 + (j - i - 1);
+    }
+
+    namespace detail
+    {
+        /* @brief A contiguous run of pairs (row, j) for j in [columnBegin, columnEnd), with its estimated cost. */
+        struct PairTile
+        {
+            std::size_t row;
+            std::size_t columnBegin;
+            std::size_t columnEnd;
+            double cost;
+        };
+
+        /* @brief Splits the upper triangle into tiles of roughly equal cost (n * m per pair), largest first.
+           @param[in] sizes Number of points in each trajectory.
+           @param[in] tilesPerThread Target number of tiles per thread; more tiles give finer load balancing.
+           @param[in] threads Number of worker threads.
+        */
+        inline std::vector<PairTile> makeTiles(const std::vector<std::size_t>& sizes, std::size_t tilesPerThread, unsigned threads)
+        {
+            const std::size_t count = sizes.size();
+            /* prefix[k] is the number of points in trajectories 0, ..., k - 1 */
+            std::vector<double> prefix(count + 1, 0.0);
+            for (std::size_t k = 0; k < count; ++k) prefix[k + 1] = prefix[k] + static_cast<double>(sizes[k]);
+            double totalCost = 0.0;
+            for (std::size_t i = 0; i < count; ++i) totalCost += static_cast<double>(sizes[i]) * (prefix[count] - prefix[i + 1]);
+            const double target = std::max(1.0, totalCost / static_cast<double>(tilesPerThread * threads));
+
+            std::vector<PairTile> tiles;
+            for (std::size_t i = 0; i + 1 < count; ++i)
+            {
+                const double rowSize = std::max(1.0, static_cast<double>(sizes[i]));
+                for (std::size_t columnBegin = i + 1; columnBegin < count; )
+                {
+                    /* Smallest run of columns whose combined cost reaches the target */
+                    const double* end = std::lower_bound(prefix.data() + columnBegin + 1, prefix.data() + count + 1, prefix[columnBegin] + target / rowSize);
+                    const std::size_t columnEnd = std::min(count, static_cast<std::size_t>(end - prefix.data()));
+                    tiles.push_back(PairTile { i, columnBegin, columnEnd, static_cast<double>(sizes[i]) * (prefix[columnEnd] - prefix[columnBegin]) });
+                    columnBegin = columnEnd;
+                }
+            }
+            std::sort(tiles.begin(), tiles.end(), [](const PairTile& a, const PairTile& b) { return a.cost > b.cost; });
+            return tiles;
+        }
+
+        /* @brief Per-thread deque of tiles: the owner pops the most expensive tile from the front, idle threads steal
+         *        the cheapest from the back, so the end of the run is balanced with the smallest units of work.
+        */
+        class TileQueue
+        {
+        public:
+            void push(const PairTile& tile) { tiles_.push_back(tile); }
+
+            bool pop(PairTile& tile)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (tiles_.empty()) return false;
+                tile = tiles_.front();
+                tiles_.pop_front();
+                return true;
+            }
+
+            bool steal(PairTile& tile)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (tiles_.empty()) return false;
+                tile = tiles_.back();
+                tiles_.pop_back();
+                return true;
+            }
+
+        private:
+            std::mutex mutex_;
+            std::deque<PairTile> tiles_;
+        };
+
+        inline unsigned resolveThreads(unsigned threads)
+        {
+            if (threads == 0) threads = std::thread::hardware_concurrency();
+            return std::max(1u, threads);
+        }
+
+        /* @brief Runs f(worker, index) for index in [0, count) across threads, with dynamic scheduling. */
+        template <typename Function>
+        void parallelFor(std::size_t count, unsigned threads, Function&& f)
+        {
+            std::atomic<std::size_t> next(0);
+            std::exception_ptr failure;
+            std::mutex failureMutex;
+            auto work = [&](unsigned worker)
+            {
+                try
+                {
+                    for (std::size_t index = next++; index < count; index = next++) f(worker, index);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(failureMutex);
+                    if (!failure) failure = std::current_exception();
+                    next = count;
+                }
+            };
+            std::vector<std::thread> pool;
+            for (unsigned worker = 1; worker < threads; ++worker) pool.emplace_back(work, worker);
+            work(0);
+            for (std::thread& thread : pool) thread.join();
+            if (failure) std::rethrow_exception(failure);
+        }
+
+        /* @brief Evaluates f(worker, i, j) for every pair i < j, writing into the condensed buffer out.
+           @param[in] sizes Number of points in each trajectory, used to estimate the cost of each pair.
+           @param[in] threads Number of worker threads (at least one).
+           @param[out] out Condensed buffer of condensedSize(sizes.size()) elements.
+           @param[in] f Callable returning the distance of pair (i, j); worker lets it keep per-thread scratch storage.
+        */
+        template <typename PairFunction>
+        void runPairwise(const std::vector<std::size_t>& sizes, unsigned threads, double* out, PairFunction&& f)
+        {
+            const std::size_t count = sizes.size();
+            const std::vector<PairTile> tiles = makeTiles(sizes, 16, threads);
+            std::vector<std::unique_ptr<TileQueue>> queues(threads);
+            for (auto& queue : queues) queue.reset(new TileQueue);
+            for (std::size_t t = 0; t < tiles.size(); ++t) queues[t % threads]->push(tiles[t]);
+
+            std::exception_ptr failure;
+            std::mutex failureMutex;
+            std::atomic<bool> stop(false);
+            auto work = [&](unsigned worker)
+            {
+                try
+                {
+                    PairTile tile;
+                    while (!stop)
+                    {
+                        bool found = queues[worker]->pop(tile);
+                        for (unsigned victim = 1; !found && victim < threads; ++victim)
+                        {
+                            found = queues[(worker + victim) % threads]->steal(tile);
+                        }
+                        if (!found) return; /* Nothing is ever added after start-up, so every queue is drained */
+                        for (std::size_t j = tile.columnBegin; j < tile.columnEnd; ++j)
+                        {
+                            out[condensedIndex(count, tile.row, j)] = f(worker, tile.row, j);
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(failureMutex);
+                    if (!failure) failure = std::current_exception();
+                    stop = true;
+                }
+            };
+            std::vector<std::thread> pool;
+            for (unsigned worker = 1; worker < threads; ++worker) pool.emplace_back(work, worker);
+            work(0);
+            for (std::thread& thread : pool) thread.join();
+            if (failure) std::rethrow_exception(failure);
+        }
+
+        template <typename T>
+        std::vector<std::size_t> trajectorySizes(const std::vector<TrajectoryView<T>>& trajectories)
+        {
+            std::vector<std::size_t> sizes(trajectories.size());
+            for (std::size_t i = 0; i < trajectories.size(); ++i) sizes[i] = trajectories[i].size();
+            return sizes;
+        }
+    };
+
+    /* @brief Computes a user-supplied distance for every pair of trajectories.
+       @returns The condensed distance matrix, as scipy.spatial.distance.pdist; entry condensedIndex(N, i, j) holds pair (i, j).
+       @param[in] trajectories The N trajectories.
+       @param[in] distance Thread-safe callable taking two TrajectoryView<T> and returning the distance between them.
+       @param[in] threads Number of worker threads; 0 uses every hardware thread.
+    */
+    template <typename T, typename DistanceFunction>
+    std::vector<double> pairwiseDistances(const std::vector<TrajectoryView<T>>& trajectories, DistanceFunction&& distance, unsigned threads = 0)
+    {
+        std::vector<double> condensed(condensedSize(trajectories.size()));
+        detail::runPairwise(detail::trajectorySizes(trajectories), detail::resolveThreads(threads), condensed.data(),
+                            [&](unsigned, std::size_t i, std::size_t j) { return static_cast<double>(distance(trajectories[i], trajectories[j])); });
+        return condensed;
+    }
+
+    /* @brief Computes the symmetric Hausdorff or the Frechet distance for every pair of trajectories.
+     *
+     * Only the upper triangle is evaluated. Pairs are grouped into tiles of similar cost (n * m), handed out largest
+     * first and balanced by work stealing, so trajectories whose lengths differ by orders of magnitude still keep every
+     * thread busy. For Hausdorff each trajectory is shuffled and packed once up front rather than once per pair; for
+     * Frechet every thread reuses one workspace.
+       @returns The condensed distance matrix, as scipy.spatial.distance.pdist; entry condensedIndex(N, i, j) holds pair (i, j).
+       @param[in] trajectories The N trajectories.
+       @param[in] metric Which distance to compute.
+       @param[in] threads Number of worker threads; 0 uses every hardware thread.
+    */
+    template <typename T>
+    std::vector<double> pairwiseDistances(const std::vector<TrajectoryView<T>>& trajectories, Metric metric, unsigned threads = 0)
+    {
+        threads = detail::resolveThreads(threads);
+        std::vector<double> condensed(condensedSize(trajectories.size()));
+        const std::vector<std::size_t> sizes = detail::trajectorySizes(trajectories);
+        if (metric == Metric::Hausdorff)
+        {
+            std::vector<std::unique_ptr<Hausdorff::PreparedTrajectory<T>>> prepared(trajectories.size());
+            detail::parallelFor(trajectories.size(), threads, [&](unsigned, std::size_t i)
+            {
+                prepared[i].reset(new Hausdorff::PreparedTrajectory<T>(trajectories[i]));
+            });
+            detail::runPairwise(sizes, threads, condensed.data(), [&](unsigned, std::size_t i, std::size_t j)
+            {
+                return symmetricHausdorffDistance(*prepared[i], *prepared[j]);
+            });
+        }
+        else
+        {
+            std::vector<Frechet::Workspace<T>> workspaces(threads);
+            detail::runPairwise(sizes, threads, condensed.data(), [&](unsigned worker, std::size_t i, std::size_t j)
+            {
+                return static_cast<double>(Frechet::frechetDistance(trajectories[i], trajectories[j], workspaces[worker]));
+            });
+        }
+        return condensed;
+    }
+};
+#endif
@@ -0,0 +1,155 @@
+/*  Point distance kernels
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __POINT_DISTANCE_H__
+#define __POINT_DISTANCE_H__
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Trajectory.hpp"
+
+namespace DistanceMetrics
+{
+    /* Dimension template argument meaning "only known at run time" */
+    constexpr std::size_t DynamicDimension = 0;
+
+    /* @brief Type in which the squared distances between points of type T are accumulated.
+     *
+     * Defaults to T. Define DISTANCE_METRICS_DOUBLE_ACCUMULATION to keep float storage (half the memory traffic)
+     * while forming every difference and sum in double; the result is rounded back to float once per distance.
+     */
+    template <typename T>
+    struct Accumulator
+    {
+        using type = T;
+    };
+#ifdef DISTANCE_METRICS_DOUBLE_ACCUMULATION
+    template <>
+    struct Accumulator<float>
+    {
+        using type = double;
+    };
+#endif
+    template <typename T>
+    using AccumulatorType = typename Accumulator<T>::type;
+
+    namespace detail
+    {
+        /* @brief Nearest T to value that is not below it. Cutoffs are passed as double and converted with this, so
+         *        that no distance within the cutoff is rounded past it when T is float.
+        */
+        template <typename T>
+        inline T roundedUp(double value)
+        {
+            T rounded = static_cast<T>(value);
+            if (static_cast<double>(rounded) < value) rounded = std::nextafter(rounded, std::numeric_limits<T>::infinity());
+            return rounded;
+        }
+
+        template <typename A>
+        inline A squaredDifference(A x, A y)
+        {
+            return (x - y) * (x - y);
+        }
+
+        template <typename T, typename PointSetA, typename PointSetB, std::size_t... K>
+        inline T unrolledSquaredDistance(const PointSetA& a, std::size_t i, const PointSetB& b, std::size_t j, std::index_sequence<K...>)
+        {
+            using A = AccumulatorType<T>;
+            A sum = 0.0;
+            ((sum += squaredDifference<A>(a(i, K), b(j, K))), ...);
+            return static_cast<T>(sum);
+        }
+
+        template <typename T, std::size_t D, std::size_t... K>
+        inline T unrolledSquaredDistance(const std::array<T, D>& a, const std::array<T, D>& b, std::index_sequence<K...>)
+        {
+            using A = AccumulatorType<T>;
+            A sum = 0.0;
+            ((sum += squaredDifference<A>(a[K], b[K])), ...);
+            return static_cast<T>(sum);
+        }
+    };
+
+    /* @brief Squared Euclidean distance between point i of a and point j of b.
+     *
+     * With D != DynamicDimension the coordinate loop is unrolled at compile time, which leaves the compiler
+     * free to vectorise across point pairs rather than inside a two- or three-element loop.
+       @returns The squared Euclidean distance; templated-type.
+       @param[in] a First point set; any type exposing dimension() and operator()(i, k).
+       @param[in] i Index of the point in a.
+       @param[in] b Second point set, of the same dimension as a.
+       @param[in] j Index of the point in b.
+    */
+    template <typename T, std::size_t D = DynamicDimension, typename PointSetA, typename PointSetB>
+    inline T squaredDistance(const PointSetA& a, std::size_t i, const PointSetB& b, std::size_t j)
+    {
+        if constexpr (D == DynamicDimension)
+        {
+            using A = AccumulatorType<T>;
+            A sum = 0.0;
+            for (std::size_t idx = 0; idx < a.dimension(); ++idx) sum += detail::squaredDifference<A>(a(i, idx), b(j, idx));
+            return static_cast<T>(sum);
+        }
+        else
+        {
+            return detail::unrolledSquaredDistance<T>(a, i, b, j, std::make_index_sequence<D>{});
+        }
+    }
+
+    /* @brief Squared Euclidean distance between two fixed-dimension points, fully unrolled.
+       @returns The squared Euclidean distance between a and b; templated-type.
+       @param[in] a First point.
+       @param[in] b Second point.
+    */
+    template <typename T, std::size_t D>
+    inline T squaredDistance(const std::array<T, D>& a, const std::array<T, D>& b)
+    {
+        return detail::unrolledSquaredDistance<T, D>(a, b, std::make_index_sequence<D>{});
+    }
+
+    /* @brief Calls f with std::integral_constant<std::size_t, D> for the dimensions that have specialised kernels
+     *        (2, 3 and 6, i.e. planar, spatial and state-vector trajectories) and with DynamicDimension otherwise.
+       @returns Whatever f returns.
+       @param[in] dimension Run-time dimension of the trajectories.
+       @param[in] f Generic callable, typically a lambda taking `auto D` and using decltype(D)::value.
+    */
+    template <typename Function>
+    inline decltype(auto) dispatchDimension(std::size_t dimension, Function&& f)
+    {
+        switch (dimension)
+        {
+            case 2: return f(std::integral_constant<std::size_t, 2>{});
+            case 3: return f(std::integral_constant<std::size_t, 3>{});
+            case 6: return f(std::integral_constant<std::size_t, 6>{});
+            default: return f(std::integral_constant<std::size_t, DynamicDimension>{});
+        }
+    }
+
+    /* @brief Views a vector of fixed-dimension points as a packed, row-major trajectory without copying. */
+    template <typename T, std::size_t D>
+    TrajectoryView<T> makeView(const std::vector<std::array<T, D>>& points)
+    {
+        static_assert(sizeof(std::array<T, D>) == D * sizeof(T), "std::array<T, D> must be tightly packed to be viewed in place.");
+        return TrajectoryView<T>(points.empty() ? nullptr : points[0].data(), points.size(), D);
+    }
+};
+#endif
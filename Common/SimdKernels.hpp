@@ -0,0 +1,473 @@
+/*  SIMD distance kernels
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __SIMD_KERNELS_H__
+#define __SIMD_KERNELS_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include "PointDistance.hpp"
+
+/* Define DISTANCE_METRICS_NO_SIMD to force the portable scalar kernels. */
+#if !defined(DISTANCE_METRICS_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define DISTANCE_METRICS_SIMD_X86
+    #include <immintrin.h>
+#elif !defined(DISTANCE_METRICS_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+    #define DISTANCE_METRICS_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace DistanceMetrics
+{
+    namespace simd
+    {
+        /* @brief Instruction sets the one-to-many kernels can be dispatched to. */
+        enum class InstructionSet
+        {
+            Scalar,
+            NEON,
+            AVX2,
+            AVX512
+        };
+
+        /* @brief Signature shared by every one-to-many kernel.
+         *
+         * Computes the squared distances from query to the targets [0, count), where coordinate k of target j is stored
+         * at targets[k * stride + j] (structure-of-arrays). Targets are processed in blocks of one vector register; if
+         * any distance in a block is below threshold the kernel sets brokeEarly and returns immediately, otherwise it
+         * returns the minimum squared distance over all targets.
+         */
+        template <typename T>
+        using OneToManyKernel = T (*)(const T* query, std::size_t dimension, const T* targets, std::size_t stride, std::size_t count, T threshold, bool& brokeEarly);
+
+        namespace detail
+        {
+            template <typename T, std::size_t D>
+            T oneToManyScalar(const T* query, std::size_t dimension, const T* targets, std::size_t stride, std::size_t count, T threshold, bool& brokeEarly)
+            {
+                using A = AccumulatorType<T>;
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                A minimum = std::numeric_limits<A>::infinity();
+                brokeEarly = false;
+                for (std::size_t j = 0; j < count; ++j)
+                {
+                    A d = 0.0;
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const A diff = static_cast<A>(targets[k * stride + j]) - static_cast<A>(query[k]);
+                        d += diff * diff;
+                    }
+                    if (d < static_cast<A>(threshold))
+                    {
+                        brokeEarly = true;
+                        return static_cast<T>(d);
+                    }
+                    minimum = std::min(minimum, d);
+                }
+                return static_cast<T>(minimum);
+            }
+
+#ifdef DISTANCE_METRICS_SIMD_X86
+            template <std::size_t D>
+            __attribute__((target("avx2,fma")))
+            double oneToManyAvx2(const double* query, std::size_t dimension, const double* targets, std::size_t stride, std::size_t count, double threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const __m256d limit = _mm256_set1_pd(threshold);
+                __m256d best = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 4 <= count; j += 4)
+                {
+                    __m256d sum = _mm256_setzero_pd();
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const __m256d diff = _mm256_sub_pd(_mm256_loadu_pd(targets + k * stride + j), _mm256_set1_pd(query[k]));
+                        sum = _mm256_fmadd_pd(diff, diff, sum);
+                    }
+                    if (_mm256_movemask_pd(_mm256_cmp_pd(sum, limit, _CMP_LT_OQ)) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0;
+                    }
+                    best = _mm256_min_pd(best, sum);
+                }
+                alignas(32) double lanes[4];
+                _mm256_store_pd(lanes, best);
+                double minimum = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+                const double tail = oneToManyScalar<double, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+
+            template <std::size_t D>
+            __attribute__((target("avx2,fma")))
+            float oneToManyAvx2(const float* query, std::size_t dimension, const float* targets, std::size_t stride, std::size_t count, float threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const __m256 limit = _mm256_set1_ps(threshold);
+                __m256 best = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 8 <= count; j += 8)
+                {
+                    __m256 sum = _mm256_setzero_ps();
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(targets + k * stride + j), _mm256_set1_ps(query[k]));
+                        sum = _mm256_fmadd_ps(diff, diff, sum);
+                    }
+                    if (_mm256_movemask_ps(_mm256_cmp_ps(sum, limit, _CMP_LT_OQ)) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0f;
+                    }
+                    best = _mm256_min_ps(best, sum);
+                }
+                alignas(32) float lanes[8];
+                _mm256_store_ps(lanes, best);
+                float minimum = *std::min_element(lanes, lanes + 8);
+                const float tail = oneToManyScalar<float, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+
+            /* Float storage, double accumulation: each block of eight floats is widened to two registers of doubles. */
+            template <std::size_t D>
+            __attribute__((target("avx2,fma")))
+            float oneToManyAvx2Widening(const float* query, std::size_t dimension, const float* targets, std::size_t stride, std::size_t count, float threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const __m256d limit = _mm256_set1_pd(threshold);
+                __m256d best = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 8 <= count; j += 8)
+                {
+                    __m256d sumLow = _mm256_setzero_pd(), sumHigh = _mm256_setzero_pd();
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const __m256d q = _mm256_set1_pd(query[k]);
+                        const __m256d diffLow = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(targets + k * stride + j)), q);
+                        const __m256d diffHigh = _mm256_sub_pd(_mm256_cvtps_pd(_mm_loadu_ps(targets + k * stride + j + 4)), q);
+                        sumLow = _mm256_fmadd_pd(diffLow, diffLow, sumLow);
+                        sumHigh = _mm256_fmadd_pd(diffHigh, diffHigh, sumHigh);
+                    }
+                    const __m256d below = _mm256_or_pd(_mm256_cmp_pd(sumLow, limit, _CMP_LT_OQ), _mm256_cmp_pd(sumHigh, limit, _CMP_LT_OQ));
+                    if (_mm256_movemask_pd(below) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0f;
+                    }
+                    best = _mm256_min_pd(best, _mm256_min_pd(sumLow, sumHigh));
+                }
+                alignas(32) double lanes[4];
+                _mm256_store_pd(lanes, best);
+                const float minimum = static_cast<float>(std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3])));
+                const float tail = oneToManyScalar<float, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+
+#if defined(__GNUC__) && !defined(__clang__)
+    /* GCC 12 warns about the _mm512_undefined_* placeholders inside its own AVX-512 intrinsics (GCC bug 105593) */
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+            template <std::size_t D>
+            __attribute__((target("avx512f")))
+            double oneToManyAvx512(const double* query, std::size_t dimension, const double* targets, std::size_t stride, std::size_t count, double threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const __m512d limit = _mm512_set1_pd(threshold);
+                __m512d best = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 8 <= count; j += 8)
+                {
+                    __m512d sum = _mm512_setzero_pd();
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const __m512d diff = _mm512_sub_pd(_mm512_loadu_pd(targets + k * stride + j), _mm512_set1_pd(query[k]));
+                        sum = _mm512_fmadd_pd(diff, diff, sum);
+                    }
+                    if (_mm512_cmp_pd_mask(sum, limit, _CMP_LT_OQ) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0;
+                    }
+                    best = _mm512_min_pd(best, sum);
+                }
+                alignas(64) double lanes[8];
+                _mm512_store_pd(lanes, best);
+                double minimum = *std::min_element(lanes, lanes + 8);
+                const double tail = oneToManyScalar<double, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+
+            template <std::size_t D>
+            __attribute__((target("avx512f")))
+            float oneToManyAvx512(const float* query, std::size_t dimension, const float* targets, std::size_t stride, std::size_t count, float threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const __m512 limit = _mm512_set1_ps(threshold);
+                __m512 best = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 16 <= count; j += 16)
+                {
+                    __m512 sum = _mm512_setzero_ps();
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const __m512 diff = _mm512_sub_ps(_mm512_loadu_ps(targets + k * stride + j), _mm512_set1_ps(query[k]));
+                        sum = _mm512_fmadd_ps(diff, diff, sum);
+                    }
+                    if (_mm512_cmp_ps_mask(sum, limit, _CMP_LT_OQ) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0f;
+                    }
+                    best = _mm512_min_ps(best, sum);
+                }
+                alignas(64) float lanes[16];
+                _mm512_store_ps(lanes, best);
+                float minimum = *std::min_element(lanes, lanes + 16);
+                const float tail = oneToManyScalar<float, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+
+            /* Float storage, double accumulation: each block of sixteen floats is widened to two registers of doubles. */
+            template <std::size_t D>
+            __attribute__((target("avx512f")))
+            float oneToManyAvx512Widening(const float* query, std::size_t dimension, const float* targets, std::size_t stride, std::size_t count, float threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const __m512d limit = _mm512_set1_pd(threshold);
+                __m512d best = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 16 <= count; j += 16)
+                {
+                    __m512d sumLow = _mm512_setzero_pd(), sumHigh = _mm512_setzero_pd();
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const __m512d q = _mm512_set1_pd(query[k]);
+                        const __m512d diffLow = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(targets + k * stride + j)), q);
+                        const __m512d diffHigh = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(targets + k * stride + j + 8)), q);
+                        sumLow = _mm512_fmadd_pd(diffLow, diffLow, sumLow);
+                        sumHigh = _mm512_fmadd_pd(diffHigh, diffHigh, sumHigh);
+                    }
+                    if ((_mm512_cmp_pd_mask(sumLow, limit, _CMP_LT_OQ) | _mm512_cmp_pd_mask(sumHigh, limit, _CMP_LT_OQ)) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0f;
+                    }
+                    best = _mm512_min_pd(best, _mm512_min_pd(sumLow, sumHigh));
+                }
+                alignas(64) double lanes[8];
+                _mm512_store_pd(lanes, best);
+                const float minimum = static_cast<float>(*std::min_element(lanes, lanes + 8));
+                const float tail = oneToManyScalar<float, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+#endif
+
+#ifdef DISTANCE_METRICS_SIMD_NEON
+            template <std::size_t D>
+            double oneToManyNeon(const double* query, std::size_t dimension, const double* targets, std::size_t stride, std::size_t count, double threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const float64x2_t limit = vdupq_n_f64(threshold);
+                float64x2_t best = vdupq_n_f64(std::numeric_limits<double>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 4 <= count; j += 4) /* Two registers per block to keep both FMA pipes busy */
+                {
+                    float64x2_t sumLow = vdupq_n_f64(0.0), sumHigh = vdupq_n_f64(0.0);
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const float64x2_t q = vdupq_n_f64(query[k]);
+                        const float64x2_t diffLow = vsubq_f64(vld1q_f64(targets + k * stride + j), q);
+                        const float64x2_t diffHigh = vsubq_f64(vld1q_f64(targets + k * stride + j + 2), q);
+                        sumLow = vfmaq_f64(sumLow, diffLow, diffLow);
+                        sumHigh = vfmaq_f64(sumHigh, diffHigh, diffHigh);
+                    }
+                    const uint64x2_t below = vorrq_u64(vcltq_f64(sumLow, limit), vcltq_f64(sumHigh, limit));
+                    if (vmaxvq_u32(vreinterpretq_u32_u64(below)) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0;
+                    }
+                    best = vminq_f64(best, vminq_f64(sumLow, sumHigh));
+                }
+                double minimum = vminvq_f64(best);
+                const double tail = oneToManyScalar<double, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+
+            template <std::size_t D>
+            float oneToManyNeon(const float* query, std::size_t dimension, const float* targets, std::size_t stride, std::size_t count, float threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const float32x4_t limit = vdupq_n_f32(threshold);
+                float32x4_t best = vdupq_n_f32(std::numeric_limits<float>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 8 <= count; j += 8)
+                {
+                    float32x4_t sumLow = vdupq_n_f32(0.0f), sumHigh = vdupq_n_f32(0.0f);
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const float32x4_t q = vdupq_n_f32(query[k]);
+                        const float32x4_t diffLow = vsubq_f32(vld1q_f32(targets + k * stride + j), q);
+                        const float32x4_t diffHigh = vsubq_f32(vld1q_f32(targets + k * stride + j + 4), q);
+                        sumLow = vfmaq_f32(sumLow, diffLow, diffLow);
+                        sumHigh = vfmaq_f32(sumHigh, diffHigh, diffHigh);
+                    }
+                    const uint32x4_t below = vorrq_u32(vcltq_f32(sumLow, limit), vcltq_f32(sumHigh, limit));
+                    if (vmaxvq_u32(below) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0f;
+                    }
+                    best = vminq_f32(best, vminq_f32(sumLow, sumHigh));
+                }
+                float minimum = vminvq_f32(best);
+                const float tail = oneToManyScalar<float, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+
+            /* Float storage, double accumulation: each block of four floats is widened to two registers of doubles. */
+            template <std::size_t D>
+            float oneToManyNeonWidening(const float* query, std::size_t dimension, const float* targets, std::size_t stride, std::size_t count, float threshold, bool& brokeEarly)
+            {
+                const std::size_t dims = (D == DynamicDimension) ? dimension : D;
+                const float64x2_t limit = vdupq_n_f64(threshold);
+                float64x2_t best = vdupq_n_f64(std::numeric_limits<double>::infinity());
+                std::size_t j = 0;
+                brokeEarly = false;
+                for (; j + 4 <= count; j += 4)
+                {
+                    float64x2_t sumLow = vdupq_n_f64(0.0), sumHigh = vdupq_n_f64(0.0);
+                    for (std::size_t k = 0; k < dims; ++k)
+                    {
+                        const float64x2_t q = vdupq_n_f64(query[k]);
+                        const float32x4_t block = vld1q_f32(targets + k * stride + j);
+                        const float64x2_t diffLow = vsubq_f64(vcvt_f64_f32(vget_low_f32(block)), q);
+                        const float64x2_t diffHigh = vsubq_f64(vcvt_high_f64_f32(block), q);
+                        sumLow = vfmaq_f64(sumLow, diffLow, diffLow);
+                        sumHigh = vfmaq_f64(sumHigh, diffHigh, diffHigh);
+                    }
+                    const uint64x2_t below = vorrq_u64(vcltq_f64(sumLow, limit), vcltq_f64(sumHigh, limit));
+                    if (vmaxvq_u32(vreinterpretq_u32_u64(below)) != 0)
+                    {
+                        brokeEarly = true;
+                        return 0.0f;
+                    }
+                    best = vminq_f64(best, vminq_f64(sumLow, sumHigh));
+                }
+                const float minimum = static_cast<float>(vminvq_f64(best));
+                const float tail = oneToManyScalar<float, D>(query, dimension, targets + j, stride, count - j, threshold, brokeEarly);
+                return std::min(minimum, tail);
+            }
+#endif
+
+            /* Only float and double have vector kernels; every other type uses the scalar loop. */
+            template <typename T>
+            constexpr bool hasVectorKernels = std::is_same<T, float>::value || std::is_same<T, double>::value;
+
+            inline InstructionSet detectInstructionSet()
+            {
+#if defined(DISTANCE_METRICS_SIMD_X86)
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f")) return InstructionSet::AVX512;
+                if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return InstructionSet::AVX2;
+#elif defined(DISTANCE_METRICS_SIMD_NEON)
+                return InstructionSet::NEON;
+#endif
+                return InstructionSet::Scalar;
+            }
+
+            /* Whether float data is accumulated in double (DISTANCE_METRICS_DOUBLE_ACCUMULATION). */
+            template <typename T>
+            constexpr bool widens = std::is_same<T, float>::value && std::is_same<AccumulatorType<T>, double>::value;
+
+            template <typename T, std::size_t D>
+            OneToManyKernel<T> selectKernel(InstructionSet instructionSet)
+            {
+                if constexpr (widens<T>)
+                {
+                    switch (instructionSet)
+                    {
+#if defined(DISTANCE_METRICS_SIMD_X86)
+                        case InstructionSet::AVX512: return &oneToManyAvx512Widening<D>;
+                        case InstructionSet::AVX2: return &oneToManyAvx2Widening<D>;
+#elif defined(DISTANCE_METRICS_SIMD_NEON)
+                        case InstructionSet::NEON: return &oneToManyNeonWidening<D>;
+#endif
+                        default: break;
+                    }
+                }
+                else if constexpr (hasVectorKernels<T>)
+                {
+                    switch (instructionSet)
+                    {
+#if defined(DISTANCE_METRICS_SIMD_X86)
+                        case InstructionSet::AVX512: return &oneToManyAvx512<D>;
+                        case InstructionSet::AVX2: return &oneToManyAvx2<D>;
+#elif defined(DISTANCE_METRICS_SIMD_NEON)
+                        case InstructionSet::NEON: return &oneToManyNeon<D>;
+#endif
+                        default: break;
+                    }
+                }
+                return &oneToManyScalar<T, D>;
+            }
+        };
+
+        /* @brief The instruction set the kernels were dispatched to on this machine; detected once per process. */
+        inline InstructionSet activeInstructionSet()
+        {
+            static const InstructionSet instructionSet = detail::detectInstructionSet();
+            return instructionSet;
+        }
+
+        /* @brief Minimum squared distance from one query point to many targets, with a per-block early exit.
+         *
+         * Dispatches at run time to the widest kernel the CPU supports (AVX-512, AVX2 or NEON for float and double),
+         * falling back to a scalar loop. Float data is accumulated in AccumulatorType<float>, so the float kernels
+         * either run at twice the lanes of double or widen each block to double. D is the compile-time dimension, or
+         * DynamicDimension.
+           @returns The minimum squared distance, or an unspecified value if brokeEarly is set.
+           @param[in] query Pointer to the dimension coordinates of the query point.
+           @param[in] dimension Number of coordinates per point.
+           @param[in] targets Structure-of-arrays buffer: coordinate k of target j is at targets[k * stride + j].
+           @param[in] stride Distance, in elements, between consecutive coordinate arrays (at least count).
+           @param[in] count Number of targets.
+           @param[in] threshold Stop as soon as a block contains a squared distance strictly below this value.
+           @param[out] brokeEarly Set if the scan stopped early because of threshold.
+        */
+        template <typename T, std::size_t D = DynamicDimension>
+        inline T minSquaredDistance(const T* query, std::size_t dimension, const T* targets, std::size_t stride, std::size_t count, T threshold, bool& brokeEarly)
+        {
+            static const OneToManyKernel<T> kernel = detail::selectKernel<T, D>(activeInstructionSet());
+            return kernel(query, dimension, targets, stride, count, threshold, brokeEarly);
+        }
+    };
+};
+#endif
@@ -0,0 +1,104 @@
+/*  Instrumentation counters for the distance engines
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/* The counters are compiled out unless DISTANCE_METRICS_ENABLE_STATS is defined: activeStats() is then a constant
+ * nullptr and every recording site folds away.
+ */
+namespace DistanceMetrics
+{
+    /* @brief How much work the early-termination and pruning logic saved, accumulated over every call made while a
+     *        StatsScope is active on the calling thread.
+     */
+    struct Stats
+    {
+        std::uint64_t distanceEvaluations = 0;  // Point-to-point distances actually computed
+        std::uint64_t possibleEvaluations = 0;  // Sum of n * m (2 * n * m for symmetric Hausdorff) over all calls
+        std::uint64_t outerIterations = 0;      // Hausdorff query points visited
+        std::uint64_t earlyBreaks = 0;          // ... of which the inner scan broke early (haveWeBroken)
+        std::uint64_t offDiagonalCells = 0;     // Frechet cells evaluated away from the Devogele diagonal
+        std::size_t peakMatrixBytes = 0;        // Largest matrix or packed buffer footprint of a single call
+
+        /* @brief Fraction of the n * m distances that were computed; lower is better pruning. */
+        double evaluationRatio() const
+        {
+            return possibleEvaluations ? static_cast<double>(distanceEvaluations) / static_cast<double>(possibleEvaluations) : 0.0;
+        }
+
+        /* @brief Fraction of the Hausdorff outer iterations that hit the early break. */
+        double breakRate() const
+        {
+            return outerIterations ? static_cast<double>(earlyBreaks) / static_cast<double>(outerIterations) : 0.0;
+        }
+
+        void recordBytes(std::size_t bytes)
+        {
+            peakMatrixBytes = std::max(peakMatrixBytes, bytes);
+        }
+
+        void reset()
+        {
+            *this = Stats();
+        }
+    };
+
+    namespace detail
+    {
+        inline Stats*& threadStats()
+        {
+            thread_local Stats* stats = nullptr;
+            return stats;
+        }
+    };
+
+    /* @brief The stats object filled in on this thread, or nullptr if none is (or stats are compiled out). */
+    inline Stats* activeStats()
+    {
+#ifdef DISTANCE_METRICS_ENABLE_STATS
+        return detail::threadStats();
+#else
+        return nullptr;
+#endif
+    }
+
+    /* @brief Routes the counters of every distance call on this thread into stats for the lifetime of the scope.
+     *        Scopes nest; the previous target is restored on destruction.
+     */
+    class StatsScope
+    {
+    public:
+        explicit StatsScope(Stats& stats) : previous_(detail::threadStats())
+        {
+            detail::threadStats() = &stats;
+        }
+        ~StatsScope()
+        {
+            detail::threadStats() = previous_;
+        }
+        StatsScope(const StatsScope&) = delete;
+        StatsScope& operator=(const StatsScope&) = delete;
+
+    private:
+        Stats* previous_;
+    };
+};
+#endif
@@ -0,0 +1,327 @@
+/*  Trajectory containers
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __TRAJECTORY_H__
+#define __TRAJECTORY_H__
+
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+namespace DistanceMetrics
+{
+    /* @brief Memory layout of the coordinates of a trajectory. */
+    enum class Layout
+    {
+        RowMajor,           // Coordinate k of point i is stored at data[i * dimension + k]
+        StructureOfArrays   // Coordinate k of point i is stored at data[k * size + i]
+    };
+
+    /* @brief Non-owning, read-only view of a trajectory stored in a strided buffer.
+     *
+     * Coordinate k of point i lives at data[i * pointStride + k * dimensionStride], which covers
+     * packed row-major and structure-of-arrays buffers as well as NumPy and Eigen matrices without a copy.
+     * The view is cheap to copy; the caller must keep the underlying buffer alive.
+     */
+    template <typename T>
+    class TrajectoryView
+    {
+    public:
+        using value_type = T;
+
+        TrajectoryView() = default;
+
+        /* @brief Creates a view over a packed, row-major buffer of size * dimension elements.
+           @param[in] data Pointer to the first coordinate of the first point.
+           @param[in] size Number of points in the trajectory.
+           @param[in] dimension Number of coordinates per point.
+        */
+        TrajectoryView(const T* data, std::size_t size, std::size_t dimension)
+            : data_(data), size_(size), dimension_(dimension),
+              pointStride_(static_cast<std::ptrdiff_t>(dimension)), dimensionStride_(1) {}
+
+        /* @brief Creates a view over an arbitrarily strided buffer.
+           @param[in] data Pointer to the first coordinate of the first point.
+           @param[in] size Number of points in the trajectory.
+           @param[in] dimension Number of coordinates per point.
+           @param[in] pointStride Distance, in elements, between consecutive points.
+           @param[in] dimensionStride Distance, in elements, between consecutive coordinates of a point.
+        */
+        TrajectoryView(const T* data, std::size_t size, std::size_t dimension, std::ptrdiff_t pointStride, std::ptrdiff_t dimensionStride)
+            : data_(data), size_(size), dimension_(dimension), pointStride_(pointStride), dimensionStride_(dimensionStride) {}
+
+        const T& operator()(std::size_t i, std::size_t k) const
+        {
+            return data_[static_cast<std::ptrdiff_t>(i) * pointStride_ + static_cast<std::ptrdiff_t>(k) * dimensionStride_];
+        }
+
+        std::size_t size() const { return size_; }
+        std::size_t dimension() const { return dimension_; }
+        bool empty() const { return size_ == 0; }
+        const T* data() const { return data_; }
+        std::ptrdiff_t pointStride() const { return pointStride_; }
+        std::ptrdiff_t dimensionStride() const { return dimensionStride_; }
+
+        /* @brief Whether the coordinates of each point are adjacent in memory, i.e. point(i) is valid. */
+        bool isRowMajor() const { return dimensionStride_ == 1; }
+
+        /* @brief Pointer to the first coordinate of point i; only meaningful when isRowMajor(). */
+        const T* point(std::size_t i) const { return data_ + static_cast<std::ptrdiff_t>(i) * pointStride_; }
+
+        /* @brief Returns a view of the points [first, first + count) of this trajectory. */
+        TrajectoryView subView(std::size_t first, std::size_t count) const
+        {
+            if (first + count > size_)
+            {
+                throw std::out_of_range("The range passed to TrajectoryView::subView exceeds the trajectory.");
+            }
+            return TrajectoryView(point(first), count, dimension_, pointStride_, dimensionStride_);
+        }
+
+    private:
+        const T* data_ = nullptr;
+        std::size_t size_ = 0;
+        std::size_t dimension_ = 0;
+        std::ptrdiff_t pointStride_ = 0;
+        std::ptrdiff_t dimensionStride_ = 1;
+    };
+
+    /* @brief Owning trajectory with all points in a single contiguous buffer.
+     *
+     * Converts implicitly to a TrajectoryView; when calling a templated metric pass .view() or name T explicitly.
+     */
+    template <typename T>
+    class Trajectory
+    {
+    public:
+        using value_type = T;
+
+        /* @brief Creates an empty trajectory of the given dimension. */
+        explicit Trajectory(std::size_t dimension = 0, Layout layout = Layout::RowMajor)
+            : size_(0), dimension_(dimension), layout_(layout) {}
+
+        /* @brief Creates a zero-initialised trajectory of size points. */
+        Trajectory(std::size_t size, std::size_t dimension, Layout layout = Layout::RowMajor)
+            : data_(size * dimension), size_(size), dimension_(dimension), layout_(layout) {}
+
+        /* @brief Copies a Vector-of-Vectors trajectory into contiguous storage.
+           @param[in] points Vector-of-Vectors; every point must have the same dimension.
+           @param[in] layout Memory layout of the new trajectory.
+        */
+        explicit Trajectory(const std::vector<std::vector<T>>& points, Layout layout = Layout::RowMajor)
+            : Trajectory(points.size(), points.empty() ? 0 : points[0].size(), layout)
+        {
+            for (std::size_t i = 0; i < size_; ++i)
+            {
+                if (points[i].size() != dimension_)
+                {
+                    throw std::runtime_error("The points passed to Trajectory do not all have the same dimension.");
+                }
+                for (std::size_t k = 0; k < dimension_; ++k) (*this)(i, k) = points[i][k];
+            }
+        }
+
+        /* @brief Copies any view into contiguous storage. */
+        explicit Trajectory(const TrajectoryView<T>& view, Layout layout = Layout::RowMajor)
+            : Trajectory(view.size(), view.dimension(), layout)
+        {
+            for (std::size_t i = 0; i < size_; ++i)
+            {
+                for (std::size_t k = 0; k < dimension_; ++k) (*this)(i, k) = view(i, k);
+            }
+        }
+
+        T& operator()(std::size_t i, std::size_t k)
+        {
+            return layout_ == Layout::RowMajor ? data_[i * dimension_ + k] : data_[k * size_ + i];
+        }
+        const T& operator()(std::size_t i, std::size_t k) const
+        {
+            return layout_ == Layout::RowMajor ? data_[i * dimension_ + k] : data_[k * size_ + i];
+        }
+
+        /* @brief Appends a point to a row-major trajectory.
+           @param[in] point Pointer to dimension() coordinates.
+        */
+        void push_back(const T* point)
+        {
+            if (layout_ != Layout::RowMajor)
+            {
+                throw std::runtime_error("Points can only be appended to a row-major Trajectory.");
+            }
+            data_.insert(data_.end(), point, point + dimension_);
+            ++size_;
+        }
+        void push_back(const std::vector<T>& point)
+        {
+            if (point.size() != dimension_)
+            {
+                throw std::runtime_error("The point passed to Trajectory::push_back has the wrong dimension.");
+            }
+            push_back(point.data());
+        }
+
+        void reserve(std::size_t size) { data_.reserve(size * dimension_); }
+
+        std::size_t size() const { return size_; }
+        std::size_t dimension() const { return dimension_; }
+        bool empty() const { return size_ == 0; }
+        Layout layout() const { return layout_; }
+        T* data() { return data_.data(); }
+        const T* data() const { return data_.data(); }
+
+        TrajectoryView<T> view() const
+        {
+            if (layout_ == Layout::RowMajor) return TrajectoryView<T>(data_.data(), size_, dimension_);
+            return TrajectoryView<T>(data_.data(), size_, dimension_, 1, static_cast<std::ptrdiff_t>(size_));
+        }
+        operator TrajectoryView<T>() const { return view(); }
+
+    private:
+        std::vector<T> data_;
+        std::size_t size_;
+        std::size_t dimension_;
+        Layout layout_;
+    };
+
+    /* @brief Many trajectories of one dimension packed back to back in a single row-major buffer.
+     *
+     * Trajectory t occupies points [offsets()[t], offsets()[t + 1]) of data(), which is the flat layout copied
+     * to accelerators and written to disk in one transfer.
+     */
+    template <typename T>
+    class TrajectoryBatch
+    {
+    public:
+        using value_type = T;
+
+        explicit TrajectoryBatch(std::size_t dimension = 0) : dimension_(dimension), offsets_(1, 0) {}
+
+        /* @brief Copies a set of trajectories, which must all have the same dimension, into one buffer. */
+        explicit TrajectoryBatch(const std::vector<TrajectoryView<T>>& trajectories)
+            : TrajectoryBatch(trajectories.empty() ? 0 : trajectories[0].dimension())
+        {
+            std::size_t points = 0;
+            for (const TrajectoryView<T>& trajectory : trajectories) points += trajectory.size();
+            data_.reserve(points * dimension_);
+            offsets_.reserve(trajectories.size() + 1);
+            for (const TrajectoryView<T>& trajectory : trajectories) push_back(trajectory);
+        }
+
+        /* @brief Appends a copy of a trajectory to the batch. */
+        void push_back(const TrajectoryView<T>& trajectory)
+        {
+            if (trajectory.dimension() != dimension_)
+            {
+                throw std::runtime_error("The trajectory passed to TrajectoryBatch::push_back has the wrong dimension.");
+            }
+            for (std::size_t i = 0; i < trajectory.size(); ++i)
+            {
+                for (std::size_t k = 0; k < dimension_; ++k) data_.push_back(trajectory(i, k));
+            }
+            offsets_.push_back(offsets_.back() + trajectory.size());
+        }
+
+        /* @brief Number of trajectories in the batch. */
+        std::size_t size() const { return offsets_.size() - 1; }
+        std::size_t dimension() const { return dimension_; }
+        bool empty() const { return size() == 0; }
+        /* @brief Total number of points over every trajectory. */
+        std::size_t points() const { return offsets_.back(); }
+        const T* data() const { return data_.data(); }
+        const std::vector<std::size_t>& offsets() const { return offsets_; }
+
+        /* @brief View of trajectory t. */
+        TrajectoryView<T> view(std::size_t t) const
+        {
+            return TrajectoryView<T>(data_.data() + offsets_[t] * dimension_, offsets_[t + 1] - offsets_[t], dimension_);
+        }
+        TrajectoryView<T> operator[](std::size_t t) const { return view(t); }
+
+        /* @brief Views of every trajectory, as taken by the CPU batched engines. */
+        std::vector<TrajectoryView<T>> views() const
+        {
+            std::vector<TrajectoryView<T>> result(size());
+            for (std::size_t t = 0; t < size(); ++t) result[t] = view(t);
+            return result;
+        }
+
+    private:
+        std::size_t dimension_;
+        std::vector<T> data_;
+        std::vector<std::size_t> offsets_;
+    };
+
+    /* @brief Zero-copy adapter presenting a Vector-of-Vectors trajectory through the same interface as TrajectoryView. */
+    template <typename T>
+    class NestedView
+    {
+    public:
+        using value_type = T;
+
+        explicit NestedView(const std::vector<std::vector<T>>& points) : points_(&points) {}
+
+        const T& operator()(std::size_t i, std::size_t k) const { return (*points_)[i][k]; }
+        std::size_t size() const { return points_->size(); }
+        std::size_t dimension() const { return points_->empty() ? 0 : (*points_)[0].size(); }
+        bool empty() const { return points_->empty(); }
+
+    private:
+        const std::vector<std::vector<T>>* points_;
+    };
+
+    /* @brief Views a packed, row-major raw array (e.g. a double* of size * dimension elements). */
+    template <typename T>
+    TrajectoryView<T> makeView(const T* data, std::size_t size, std::size_t dimension)
+    {
+        return TrajectoryView<T>(data, size, dimension);
+    }
+
+    /* @brief Views a structure-of-arrays buffer, i.e. all x-coordinates followed by all y-coordinates and so on. */
+    template <typename T>
+    TrajectoryView<T> makeStructureOfArraysView(const T* data, std::size_t size, std::size_t dimension)
+    {
+        return TrajectoryView<T>(data, size, dimension, 1, static_cast<std::ptrdiff_t>(size));
+    }
+
+    /* @brief Views a buffer described by byte strides, as exposed by NumPy (ndarray.strides) and the Python buffer protocol.
+       @param[in] data Pointer to the first element of a (size x dimension) array.
+       @param[in] pointStrideBytes Byte stride along the first (point) axis.
+       @param[in] dimensionStrideBytes Byte stride along the second (coordinate) axis.
+    */
+    template <typename T>
+    TrajectoryView<T> makeBufferView(const T* data, std::size_t size, std::size_t dimension, std::ptrdiff_t pointStrideBytes, std::ptrdiff_t dimensionStrideBytes)
+    {
+        const std::ptrdiff_t elementSize = static_cast<std::ptrdiff_t>(sizeof(T));
+        if (pointStrideBytes % elementSize != 0 || dimensionStrideBytes % elementSize != 0)
+        {
+            throw std::runtime_error("The strides passed to makeBufferView are not a multiple of the element size.");
+        }
+        return TrajectoryView<T>(data, size, dimension, pointStrideBytes / elementSize, dimensionStrideBytes / elementSize);
+    }
+
+    /* @brief Views a dense Eigen matrix (or Map/Block of one) whose rows are the points of the trajectory.
+     *
+     * Only requires data(), rows(), cols(), rowStride() and colStride(), so Eigen itself is not included here.
+     */
+    template <typename Matrix>
+    TrajectoryView<typename Matrix::Scalar> makeMatrixView(const Matrix& matrix)
+    {
+        return TrajectoryView<typename Matrix::Scalar>(matrix.data(), static_cast<std::size_t>(matrix.rows()), static_cast<std::size_t>(matrix.cols()),
+                                                       static_cast<std::ptrdiff_t>(matrix.rowStride()), static_cast<std::ptrdiff_t>(matrix.colStride()));
+    }
+};
+#endif
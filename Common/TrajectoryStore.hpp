@@ -0,0 +1,345 @@
+/*  Memory-mapped binary trajectory store
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __TRAJECTORY_STORE_H__
+#define __TRAJECTORY_STORE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Trajectory.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DISTANCE_METRICS_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* On-disk layout, in native byte order:
+ *
+ *   StoreHeader                 64 bytes
+ *   points * dimension values   row-major, trajectory after trajectory, starting at dataOffset
+ *   (count + 1) uint64 offsets  starting at offsetsOffset, the next multiple of 8 bytes; trajectory t is points
+ *                               [offsets[t], offsets[t + 1])
+ *
+ * The offset table comes last so that a writer can stream the trajectories out without knowing how many there are.
+ */
+namespace DistanceMetrics
+{
+    namespace detail
+    {
+        struct StoreHeader
+        {
+            char magic[8];                  // "DMTSTORE"
+            std::uint32_t version;
+            std::uint32_t byteOrder;        // 0x01020304 as written; anything else is a foreign-endian file
+            std::uint32_t scalarSize;       // sizeof(T): 4 for float, 8 for double
+            std::uint32_t reserved;
+            std::uint64_t dimension;
+            std::uint64_t count;            // Number of trajectories
+            std::uint64_t points;           // Total number of points
+            std::uint64_t dataOffset;       // Byte offset of the first value
+            std::uint64_t offsetsOffset;    // Byte offset of the offset table
+        };
+        static_assert(sizeof(StoreHeader) <= 64, "The store header must fit in its 64-byte slot.");
+
+        constexpr char storeMagic[8] = { 'D', 'M', 'T', 'S', 'T', 'O', 'R', 'E' };
+        constexpr std::uint32_t storeVersion = 1;
+        constexpr std::uint32_t storeByteOrder = 0x01020304;
+        constexpr std::uint64_t storeDataOffset = 64;
+
+        /* @brief Start of the offset table: the end of the values, rounded up so that the table is 8-byte aligned. */
+        inline std::uint64_t storeOffsetsOffset(std::uint64_t dataBytes)
+        {
+            return (storeDataOffset + dataBytes + 7) / 8 * 8;
+        }
+    };
+
+    /* @brief Writes trajectories to a store file one at a time, so that a dataset never has to be held in memory.
+     *        The header and offset table are completed by close(), which the destructor calls if needed.
+     */
+    template <typename T>
+    class TrajectoryStoreWriter
+    {
+    public:
+        TrajectoryStoreWriter(const std::string& path, std::size_t dimension)
+            : file_(path, std::ios::binary | std::ios::trunc), dimension_(dimension), offsets_(1, 0)
+        {
+            if (!file_)
+            {
+                throw std::runtime_error("Could not open " + path + " for writing.");
+            }
+            const char padding[detail::storeDataOffset] = {};
+            file_.write(padding, sizeof(padding));  // The header is filled in by close()
+        }
+
+        ~TrajectoryStoreWriter()
+        {
+            try
+            {
+                close();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        TrajectoryStoreWriter(const TrajectoryStoreWriter&) = delete;
+        TrajectoryStoreWriter& operator=(const TrajectoryStoreWriter&) = delete;
+
+        /* @brief Appends one trajectory, which must have the store's dimension. */
+        void append(const TrajectoryView<T>& trajectory)
+        {
+            if (!trajectory.empty() && trajectory.dimension() != dimension_)
+            {
+                throw std::runtime_error("The trajectory passed to TrajectoryStoreWriter::append has the wrong dimension.");
+            }
+            buffer_.resize(trajectory.size() * dimension_);
+            for (std::size_t i = 0; i < trajectory.size(); ++i)
+            {
+                for (std::size_t k = 0; k < dimension_; ++k) buffer_[i * dimension_ + k] = trajectory(i, k);
+            }
+            file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size() * sizeof(T)));
+            offsets_.push_back(offsets_.back() + trajectory.size());
+        }
+
+        /* @brief Writes the offset table and the header; further appends are not allowed. */
+        void close()
+        {
+            if (!file_.is_open()) return;
+            detail::StoreHeader header = {};
+            std::memcpy(header.magic, detail::storeMagic, sizeof(header.magic));
+            header.version = detail::storeVersion;
+            header.byteOrder = detail::storeByteOrder;
+            header.scalarSize = sizeof(T);
+            header.dimension = dimension_;
+            header.count = offsets_.size() - 1;
+            header.points = offsets_.back();
+            header.dataOffset = detail::storeDataOffset;
+            header.offsetsOffset = detail::storeOffsetsOffset(header.points * dimension_ * sizeof(T));
+            const char padding[8] = {};
+            file_.write(padding, static_cast<std::streamsize>(header.offsetsOffset - (detail::storeDataOffset + header.points * dimension_ * sizeof(T))));
+            file_.write(reinterpret_cast<const char*>(offsets_.data()), static_cast<std::streamsize>(offsets_.size() * sizeof(std::uint64_t)));
+            file_.seekp(0);
+            file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file_.close();
+            if (!file_)
+            {
+                throw std::runtime_error("Writing the trajectory store failed.");
+            }
+        }
+
+    private:
+        std::ofstream file_;
+        std::size_t dimension_;
+        std::vector<std::uint64_t> offsets_;
+        std::vector<T> buffer_;
+    };
+
+    /* @brief Writes a set of trajectories, which must all have the same dimension, to a store file. */
+    template <typename T>
+    void writeTrajectoryStore(const std::string& path, const std::vector<TrajectoryView<T>>& trajectories)
+    {
+        TrajectoryStoreWriter<T> writer(path, trajectories.empty() ? 0 : trajectories[0].dimension());
+        for (const TrajectoryView<T>& trajectory : trajectories) writer.append(trajectory);
+        writer.close();
+    }
+
+    template <typename T>
+    void writeTrajectoryStore(const std::string& path, const TrajectoryBatch<T>& batch)
+    {
+        TrajectoryStoreWriter<T> writer(path, batch.dimension());
+        for (std::size_t t = 0; t < batch.size(); ++t) writer.append(batch.view(t));
+        writer.close();
+    }
+
+    /* @brief Read-only store opened from disk, handing out zero-copy views of its trajectories.
+     *
+     * On POSIX systems the file is memory-mapped, so opening is O(1) whatever the file size and pages are only read
+     * when a trajectory is touched; datasets larger than RAM are paged in and out by the operating system. Elsewhere
+     * the file is read into memory once. The views stay valid for the lifetime of the store.
+     */
+    template <typename T>
+    class TrajectoryStore
+    {
+    public:
+        explicit TrajectoryStore(const std::string& path)
+        {
+#ifdef DISTANCE_METRICS_HAVE_MMAP
+            const int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0)
+            {
+                throw std::runtime_error("Could not open " + path + ".");
+            }
+            struct stat status;
+            if (::fstat(descriptor, &status) != 0)
+            {
+                ::close(descriptor);
+                throw std::runtime_error("Could not read the size of " + path + ".");
+            }
+            bytes_ = static_cast<std::size_t>(status.st_size);
+            if (bytes_ > 0)
+            {
+                void* mapping = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (mapping == MAP_FAILED)
+                {
+                    ::close(descriptor);
+                    throw std::runtime_error("Could not memory-map " + path + ".");
+                }
+                mapping_ = static_cast<const unsigned char*>(mapping);
+            }
+            ::close(descriptor);    // The mapping keeps the file alive
+            base_ = mapping_;
+#else
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file)
+            {
+                throw std::runtime_error("Could not open " + path + ".");
+            }
+            bytes_ = static_cast<std::size_t>(file.tellg());
+            /* uint64 elements keep the buffer aligned for both the values and the offset table */
+            buffer_.resize((bytes_ + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(bytes_));
+            if (!file)
+            {
+                throw std::runtime_error("Could not read " + path + ".");
+            }
+            base_ = reinterpret_cast<const unsigned char*>(buffer_.data());
+#endif
+            try
+            {
+                validate();
+            }
+            catch (...)
+            {
+                release();
+                throw;
+            }
+        }
+
+        ~TrajectoryStore() { release(); }
+
+        TrajectoryStore(const TrajectoryStore&) = delete;
+        TrajectoryStore& operator=(const TrajectoryStore&) = delete;
+
+        /* @brief Number of trajectories in the store. */
+        std::size_t size() const { return count_; }
+        std::size_t dimension() const { return dimension_; }
+        bool empty() const { return count_ == 0; }
+        /* @brief Total number of points over every trajectory. */
+        std::size_t points() const { return points_; }
+        const T* data() const { return data_; }
+        /* @brief The offset table: trajectory t is points [offsets()[t], offsets()[t + 1]) of data(). */
+        const std::uint64_t* offsets() const { return offsets_; }
+
+        /* @brief Zero-copy view of trajectory t. */
+        TrajectoryView<T> view(std::size_t t) const
+        {
+            return TrajectoryView<T>(data_ + offsets_[t] * dimension_, static_cast<std::size_t>(offsets_[t + 1] - offsets_[t]), dimension_);
+        }
+        TrajectoryView<T> operator[](std::size_t t) const { return view(t); }
+
+        /* @brief Views of every trajectory, as taken by the CPU batched engines. */
+        std::vector<TrajectoryView<T>> views() const
+        {
+            std::vector<TrajectoryView<T>> result(size());
+            for (std::size_t t = 0; t < size(); ++t) result[t] = view(t);
+            return result;
+        }
+
+    private:
+        /* @brief Checks the header and the offset table against the file size before any view is handed out. */
+        void validate()
+        {
+            detail::StoreHeader header;
+            if (bytes_ < detail::storeDataOffset)
+            {
+                throw std::runtime_error("The file is too small to be a trajectory store.");
+            }
+            std::memcpy(&header, base_, sizeof(header));
+            if (std::memcmp(header.magic, detail::storeMagic, sizeof(header.magic)) != 0)
+            {
+                throw std::runtime_error("The file is not a trajectory store.");
+            }
+            if (header.version != detail::storeVersion || header.byteOrder != detail::storeByteOrder)
+            {
+                throw std::runtime_error("The trajectory store has an unsupported version or byte order.");
+            }
+            if (header.scalarSize != sizeof(T))
+            {
+                throw std::runtime_error("The trajectory store holds a different floating-point type.");
+            }
+            /* The sizes are checked by division first, so that no product of header fields can wrap around */
+            const std::uint64_t room = bytes_ - detail::storeDataOffset;
+            if (header.points > 0 && (header.dimension == 0 || header.dimension > room / sizeof(T)
+                                      || header.points > room / (header.dimension * sizeof(T))))
+            {
+                throw std::runtime_error("The trajectory store is truncated or corrupt.");
+            }
+            const std::uint64_t dataBytes = header.points * header.dimension * sizeof(T);
+            if (header.dataOffset != detail::storeDataOffset || header.offsetsOffset != detail::storeOffsetsOffset(dataBytes)
+                || header.offsetsOffset > bytes_ || header.count >= (bytes_ - header.offsetsOffset) / sizeof(std::uint64_t))
+            {
+                throw std::runtime_error("The trajectory store is truncated or corrupt.");
+            }
+            dimension_ = static_cast<std::size_t>(header.dimension);
+            count_ = static_cast<std::size_t>(header.count);
+            points_ = static_cast<std::size_t>(header.points);
+            data_ = reinterpret_cast<const T*>(base_ + header.dataOffset);
+            offsets_ = reinterpret_cast<const std::uint64_t*>(base_ + header.offsetsOffset);
+            if (offsets_[0] != 0 || offsets_[count_] != header.points)
+            {
+                throw std::runtime_error("The trajectory store is truncated or corrupt.");
+            }
+            for (std::size_t t = 0; t < count_; ++t)
+            {
+                if (offsets_[t + 1] < offsets_[t])
+                {
+                    throw std::runtime_error("The trajectory store is truncated or corrupt.");
+                }
+            }
+        }
+
+        void release()
+        {
+#ifdef DISTANCE_METRICS_HAVE_MMAP
+            if (mapping_) ::munmap(const_cast<unsigned char*>(mapping_), bytes_);
+            mapping_ = nullptr;
+#endif
+        }
+
+        std::size_t bytes_ = 0;
+        const unsigned char* base_ = nullptr;
+#ifdef DISTANCE_METRICS_HAVE_MMAP
+        const unsigned char* mapping_ = nullptr;
+#else
+        std::vector<std::uint64_t> buffer_;
+#endif
+        std::size_t dimension_ = 0;
+        std::size_t count_ = 0;
+        std::size_t points_ = 0;
+        const T* data_ = nullptr;
+        const std::uint64_t* offsets_ = nullptr;
+    };
+};
+#endif
@@ -0,0 +1,281 @@
+/*  Continuous Frechet Distance
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __CONTINUOUS_FRECHET_H__
+#define __CONTINUOUS_FRECHET_H__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "Frechet.hpp"
+
+/* The continuous Frechet distance treats both trajectories as polygonal curves, so that a coupling may pair a vertex
+ * of one with any point on a segment of the other; it is never larger than the discrete distance of the same samples.
+ * The decision procedure is the free-space diagram of Alt, H. & Godau, M. (1995). Computing the Frechet distance
+ * between two polygonal curves. International Journal of Computational Geometry & Applications, 5(1-2), 75-91.
+ */
+namespace Frechet
+{
+    namespace detail
+    {
+        /* @brief Squared distance between point i of a and point j of b, accumulated in A. */
+        template <typename A, std::size_t D, typename PointSetA, typename PointSetB>
+        A squaredVertexDistance(const PointSetA& a, std::size_t i, const PointSetB& b, std::size_t j)
+        {
+            const std::size_t dimension = (D == DistanceMetrics::DynamicDimension) ? a.dimension() : D;
+            A sum = 0.0;
+            for (std::size_t k = 0; k < dimension; ++k) sum += DistanceMetrics::detail::squaredDifference<A>(a(i, k), b(j, k));
+            return sum;
+        }
+
+        /* @brief Free interval of a segment: the parameters t in [0, 1] for which the point segments(s) + t *
+         *        (segments(s + 1) - segments(s)) lies within eps of points(p). Empty intervals have lo > hi.
+         *
+         * The interval is the solution of a quadratic in t. Its ends are set to exactly 0 or 1 whenever the segment's
+         * end vertices are themselves free, so that neighbouring cells agree on whether the free space is connected.
+        */
+        template <typename T, std::size_t D, typename PointSetA, typename PointSetB>
+        void freeInterval(const PointSetA& points, std::size_t p, const PointSetB& segments, std::size_t s, DistanceMetrics::AccumulatorType<T> epsSquared, T& lo, T& hi)
+        {
+            using A = DistanceMetrics::AccumulatorType<T>;
+            const std::size_t dimension = (D == DistanceMetrics::DynamicDimension) ? points.dimension() : D;
+            A length = 0.0, projection = 0.0, start = 0.0, end = 0.0;
+            for (std::size_t k = 0; k < dimension; ++k)
+            {
+                const A direction = static_cast<A>(segments(s + 1, k)) - static_cast<A>(segments(s, k));
+                const A offset = static_cast<A>(segments(s, k)) - static_cast<A>(points(p, k));
+                const A offsetEnd = static_cast<A>(segments(s + 1, k)) - static_cast<A>(points(p, k));
+                length += direction * direction;
+                projection += offset * direction;
+                start += offset * offset;
+                end += offsetEnd * offsetEnd;
+            }
+            lo = 2;
+            hi = -1;
+            const bool startFree = start <= epsSquared, endFree = end <= epsSquared;
+            if (length == 0)
+            {
+                if (startFree) lo = 0, hi = 1;
+                return;
+            }
+            const A discriminant = projection * projection - length * (start - epsSquared);
+            if (discriminant < 0 && !startFree && !endFree) return;
+            const A root = std::sqrt(std::max(discriminant, A(0)));
+            T first = startFree ? T(0) : static_cast<T>(std::max(A(0), (-projection - root) / length));
+            T last = endFree ? T(1) : static_cast<T>(std::min(A(1), (-projection + root) / length));
+            /* A free end vertex is in the interval even if rounding has pushed the other root past it */
+            if (endFree) first = std::min(first, T(1));
+            if (startFree) last = std::max(last, T(0));
+            if (first <= last) lo = first, hi = last;
+        }
+
+        /* @brief Alt-Godau decision procedure, sweeping the free-space diagram one row of cells at a time.
+         *
+         * Cell (i, j) pairs segment i of l1 with segment j of l2. Only the reachable part of each cell's left edge is
+         * kept across rows, together with the reachable part of the current bottom edge, so memory is O(m). A cell
+         * whose left and bottom edges are both unreachable is skipped without evaluating its free intervals, and the
+         * sweep stops as soon as a whole row is unreachable.
+           @returns Whether the continuous Frechet distance between l1 and l2 is at most eps.
+           @param[inout] workspace Arena providing the left-edge intervals.
+        */
+        template <typename T, std::size_t D, typename PointSet>
+        bool continuousFrechetWithin(const PointSet& l1, const PointSet& l2, T eps, Workspace<T>& workspace)
+        {
+            using A = DistanceMetrics::AccumulatorType<T>;
+            if (eps < 0) return false;
+            const A epsSquared = static_cast<A>(eps) * static_cast<A>(eps);
+            const std::size_t n = l1.size(), m = l2.size();
+            if (squaredVertexDistance<A, D>(l1, 0, l2, 0) > epsSquared || squaredVertexDistance<A, D>(l1, n - 1, l2, m - 1) > epsSquared) return false;
+            /* A single point is coupled with every vertex of the other curve, and its distance to a segment peaks at an end */
+            if (n == 1 || m == 1)
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (std::size_t j = 0; j < m; ++j)
+                    {
+                        if (squaredVertexDistance<A, D>(l1, i, l2, j) > epsSquared) return false;
+                    }
+                }
+                return true;
+            }
+
+            workspace.reset();
+            T* leftLo = workspace.allocate(m - 1);
+            T* leftHi = workspace.allocate(m - 1);
+            T lo, hi;
+            /* The left edge of the diagram is reachable only as far as its free space is connected to the origin */
+            bool open = true;
+            for (std::size_t j = 0; j + 1 < m; ++j)
+            {
+                freeInterval<T, D>(l1, 0, l2, j, epsSquared, lo, hi);
+                open = open && lo == 0;
+                leftLo[j] = open ? T(0) : T(2);
+                leftHi[j] = open ? hi : T(-1);
+                open = open && hi == 1;
+            }
+
+            bool bottomOpen = true;
+            for (std::size_t i = 0; i + 1 < n; ++i)
+            {
+                /* The bottom edge of the diagram, likewise */
+                freeInterval<T, D>(l2, 0, l1, i, epsSquared, lo, hi);
+                bottomOpen = bottomOpen && lo == 0;
+                T bottomLo = bottomOpen ? T(0) : T(2);
+                T bottomHi = bottomOpen ? hi : T(-1);
+                bottomOpen = bottomOpen && hi == 1;
+
+                bool anyReachable = false;
+                for (std::size_t j = 0; j + 1 < m; ++j)
+                {
+                    const bool fromLeft = leftLo[j] <= leftHi[j], fromBelow = bottomLo <= bottomHi;
+                    T rightLo = 2, rightHi = -1, topLo = 2, topHi = -1;
+                    if (fromLeft || fromBelow)
+                    {
+                        /* Right edge: point i + 1 of l1 against segment j of l2; entering from below frees all of it */
+                        freeInterval<T, D>(l1, i + 1, l2, j, epsSquared, lo, hi);
+                        if (lo <= hi)
+                        {
+                            rightLo = fromBelow ? lo : std::max(lo, leftLo[j]);
+                            rightHi = hi;
+                        }
+                        /* Top edge: point j + 1 of l2 against segment i of l1; entering from the left frees all of it */
+                        freeInterval<T, D>(l2, j + 1, l1, i, epsSquared, lo, hi);
+                        if (lo <= hi)
+                        {
+                            topLo = fromLeft ? lo : std::max(lo, bottomLo);
+                            topHi = hi;
+                        }
+                    }
+                    leftLo[j] = rightLo;
+                    leftHi[j] = rightHi;
+                    bottomLo = topLo;
+                    bottomHi = topHi;
+                    anyReachable = anyReachable || rightLo <= rightHi;
+                }
+                if (i + 2 == n) return (leftLo[m - 2] <= leftHi[m - 2] && leftHi[m - 2] == 1) || (bottomLo <= bottomHi && bottomHi == 1);
+                if (!anyReachable && !bottomOpen) return false;
+            }
+            return false;
+        }
+
+        /* @brief Bisects between lower and upper bounds of the continuous Frechet distance with the decision procedure.
+         *
+         * The larger endpoint distance is a lower bound, as every coupling pairs both starts and both ends, and the
+         * discrete Frechet distance of the same samples, computed with the Devogele diagonal bound, is an upper bound.
+         * The result is always a distance that the decision procedure accepts.
+        */
+        template <typename T, std::size_t D, typename PointSet>
+        T continuousFrechetDistance(const PointSet& l1, const PointSet& l2, T tolerance, Workspace<T>& workspace)
+        {
+            using A = DistanceMetrics::AccumulatorType<T>;
+            const std::size_t n = l1.size(), m = l2.size();
+            T lower = static_cast<T>(std::sqrt(std::max(squaredVertexDistance<A, D>(l1, 0, l2, 0), squaredVertexDistance<A, D>(l1, n - 1, l2, m - 1))));
+            if (continuousFrechetWithin<T, D>(l1, l2, lower, workspace)) return lower;
+            T upper = linearFrechetDistance<T, D>(l1, l2, workspace);
+            /* The discrete distance is a square root, which may round just below the vertex distance it came from */
+            while (!continuousFrechetWithin<T, D>(l1, l2, upper, workspace)) upper = std::nextafter(upper, std::numeric_limits<T>::infinity());
+            if (tolerance <= 0) tolerance = upper * std::sqrt(std::numeric_limits<T>::epsilon());
+            while (upper - lower > tolerance)
+            {
+                const T middle = lower + (upper - lower) / 2;
+                if (middle <= lower || middle >= upper) break;
+                if (continuousFrechetWithin<T, D>(l1, l2, middle, workspace)) upper = middle;
+                else lower = middle;
+            }
+            return upper;
+        }
+    };
+
+    /* @brief Decides whether the continuous Frechet distance between two polygonal trajectories is at most eps, with
+     *        the free-space diagram of Alt & Godau in O(n * m) time and O(min(n, m)) memory.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] eps Threshold on the continuous Frechet distance; a double whatever T is, rounded up to T.
+       @param[inout] workspace Scratch arena, reusable across calls.
+       @returns Whether the continuous Frechet distance between l1 and l2 is at most eps.
+    */
+    template <typename T>
+    bool continuousFrechetWithin(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double eps, Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        if (l1.size() < l2.size()) std::swap(l1, l2);
+        const T bound = DistanceMetrics::detail::roundedUp<T>(eps);
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::continuousFrechetWithin<T, decltype(D)::value>(l1, l2, bound, workspace);
+        });
+    }
+
+    template <typename T>
+    bool continuousFrechetWithin(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double eps)
+    {
+        return continuousFrechetWithin(l1, l2, eps, detail::threadWorkspace<T>());
+    }
+
+    /* @brief Computes the continuous Frechet distance between two polygonal trajectories.
+     *
+     * Coarsely sampled trajectories need no upsampling: segments are compared exactly. The distance is bracketed by
+     * the endpoint distances and the discrete Frechet distance and then bisected with continuousFrechetWithin, each
+     * step costing O(n * m) time and O(min(n, m)) memory.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] tolerance Largest acceptable overestimate, a double rounded up to T; 0 uses the square root of machine
+                            epsilon relative to the discrete distance.
+       @param[inout] workspace Scratch arena, reusable across calls.
+       @returns An upper bound on the continuous Frechet distance within tolerance of it; exact when it equals the
+                endpoint distance.
+    */
+    template <typename T>
+    T continuousFrechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double tolerance, Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        if (l1.size() < l2.size()) std::swap(l1, l2);
+        const T bound = DistanceMetrics::detail::roundedUp<T>(tolerance);
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::continuousFrechetDistance<T, decltype(D)::value>(l1, l2, bound, workspace);
+        });
+    }
+
+    template <typename T>
+    T continuousFrechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double tolerance = 0)
+    {
+        return continuousFrechetDistance(l1, l2, tolerance, detail::threadWorkspace<T>());
+    }
+
+    /* @brief Computes the continuous Frechet distance between two Vector-of-Vectors trajectories.
+       @param[in] l1 The first trajectory.
+       @param[in] l2 The second trajectory.
+       @param[in] tolerance Largest acceptable overestimate, a double rounded up to T; 0 for the default.
+       @returns An upper bound on the continuous Frechet distance within tolerance of it.
+    */
+    template <typename T>
+    T continuousFrechetDistance(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, double tolerance = 0)
+    {
+        detail::checkInputs(l1, l2);
+        DistanceMetrics::NestedView<T> view1(l1), view2(l2);
+        if (view1.size() < view2.size()) std::swap(view1, view2);
+        Workspace<T>& workspace = detail::threadWorkspace<T>();
+        const T bound = DistanceMetrics::detail::roundedUp<T>(tolerance);
+        return DistanceMetrics::dispatchDimension(view1.dimension(), [&](auto D)
+        {
+            return detail::continuousFrechetDistance<T, decltype(D)::value>(view1, view2, bound, workspace);
+        });
+    }
+};
+#endif
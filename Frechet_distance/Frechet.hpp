@@ -17,13 +17,17 @@
 #ifndef __FRECHET_H__
 #define __FRECHET_H__
 
-#include <iostream>
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <limits>
 #include <stdexcept>
-#include <chrono>
-#include "Point.hpp"
+#include <array>
+#include <type_traits>
+#include "../Common/Trajectory.hpp"
+#include "../Common/PointDistance.hpp"
+#include "../Common/Stats.hpp"
+#include "../Common/Metric.hpp"
 
 namespace Frechet
 {
@@ -40,138 +44,933 @@ namespace Frechet
         return std::sqrt(sum);
     }
 
-    /* @brief Computes the optimized distance matrix as in Devogele, T., Esnault, M., Etienne, L., & Lardy, F. (2017).
-       @returns The maximum value on the 'core diagonal' of the distance matrix.
-       @param[in] l1 Vector-of-Vectors containing the first trajectory.
-       @param[in] l2 Vector-of-Vectors containing the second trajectory.
-       @param[inout] distanceMatrix Vector-of-Vectors containing the distance between points in a and the points in b.
+    /* @brief Computes the Euclidean distance between two fixed-dimension points; the loop is unrolled at compile time.
+       @returns The Euclidean distance between a and b; templated-type.
+       @param[in] a First point.
+       @param[in] b Second point.
+    */
+    template <typename T, std::size_t D>
+    T distanceMetric(const std::array<T, D>& a, const std::array<T, D>& b)
+    {
+        return std::sqrt(DistanceMetrics::squaredDistance(a, b));
+    }
+
+    /* @brief Computes the Euclidean distance between point i of trajectory a and point j of trajectory b.
+       @returns The Euclidean distance between a(i) and b(j); templated-type.
+       @param[in] a First trajectory; any type exposing dimension() and operator()(i, k).
+       @param[in] i Index of the point in a.
+       @param[in] b Second trajectory, of the same dimension as a.
+       @param[in] j Index of the point in b.
     */
+    template <typename T, std::size_t D = DistanceMetrics::DynamicDimension, typename PointSet>
+    T distanceMetric(const PointSet& a, size_t i, const PointSet& b, size_t j)
+    {
+        return std::sqrt(DistanceMetrics::squaredDistance<T, D>(a, i, b, j));
+    }
+
+    /* @brief How frechetDistance stores the dynamic programme. */
+    enum class Mode
+    {
+        LinearMemory,   // Two rolling rows, O(min(n, m)) memory; the default
+        FullMatrix      // Materialise the Frechet matrix over the region reachable within the diagonal bound
+    };
+
+    /* @brief Arena of scratch memory for the Frechet engines, reusable across thousands of calls.
+     *
+     * Every call resets the arena and carves its rows out of one contiguous buffer. A call that needs more than the
+     * buffer holds is served from overflow blocks, and the next reset grows the buffer to that high-water mark, so
+     * after warm-up a Workspace never touches the allocator (and never serialises threads on the heap lock).
+     */
     template <typename T>
-    T computeDistanceMatrix( std::vector<std::vector<T>>& l1, std::vector<std::vector<T>>& l2, std::vector<std::vector<T>>& distanceMatrix)
+    class Workspace
     {
-        /* Counters and sentinels */
-        int i = 0, j = 0;
-        T diagMax = 0.0;
-        /* Compute trajectory lengths, remainders and quotients */
-        int n = l1.size();
-        int m = l2.size();
-        if (n < m) /* Need to swap the trajectories */
+    public:
+        Workspace() = default;
+
+        /* @brief Creates a workspace that already holds elements values. */
+        explicit Workspace(std::size_t elements) : buffer_(elements) {}
+
+        /* @brief Returns uninitialised room for count values, valid until the next reset(). */
+        T* allocate(std::size_t count)
+        {
+            highWater_ = std::max(highWater_, used_ + count);
+            if (used_ + count <= buffer_.size())
+            {
+                T* block = buffer_.data() + used_;
+                used_ += count;
+                return block;
+            }
+            used_ += count;
+            overflow_.emplace_back(count);
+            return overflow_.back().data();
+        }
+
+        /* @brief Releases every block handed out so far, growing the buffer to the high-water mark if it overflowed. */
+        void reset()
+        {
+            if (!overflow_.empty())
+            {
+                overflow_.clear();
+                buffer_.resize(highWater_);
+            }
+            used_ = 0;
+        }
+
+        /* @brief Number of values the workspace can hand out without allocating. */
+        std::size_t capacity() const { return buffer_.size(); }
+
+    private:
+        std::vector<T> buffer_;
+        std::vector<std::vector<T>> overflow_;
+        std::size_t used_ = 0;
+        std::size_t highWater_ = 0;
+    };
+
+    namespace detail
+    {
+        /* @brief The workspace of the overloads that take none, one per thread and type, so that their arena is
+         *        reused from call to call rather than allocated afresh.
+        */
+        template <typename T>
+        Workspace<T>& threadWorkspace()
+        {
+            thread_local Workspace<T> workspace;
+            return workspace;
+        }
+    };
+
+    /* @brief Matrix that stores one contiguous span of columns [rowBegin(i), rowEnd(i)) per row, all spans packed
+     *        back to back in a single buffer.
+     *
+     * Holds the region of the Devogele matrices reachable within the diagonal bound, so memory is proportional to the
+     * visited region rather than n x m. Cells outside a span, or inside it but never computed, read as infinity; no
+     * finite value, zero included, is ever used as a marker.
+     */
+    template <typename T>
+    class SparseMatrix
+    {
+    public:
+        SparseMatrix() = default;
+
+        std::size_t rows() const { return begin_.size(); }
+        std::size_t columns() const { return columns_; }
+        std::size_t rowBegin(std::size_t i) const { return begin_[i]; }
+        std::size_t rowEnd(std::size_t i) const { return begin_[i] + (offset_[i + 1] - offset_[i]); }
+
+        /* @brief Stored values of row i, for the columns [rowBegin(i), rowEnd(i)). */
+        const T* row(std::size_t i) const { return values_.data() + offset_[i]; }
+
+        /* @brief Value of cell (i, j), or infinity if it was not computed. */
+        T operator()(std::size_t i, std::size_t j) const
+        {
+            return (j >= rowBegin(i) && j < rowEnd(i)) ? values_[offset_[i] + (j - begin_[i])] : std::numeric_limits<T>::infinity();
+        }
+
+        /* @brief Whether cell (i, j) was computed. */
+        bool contains(std::size_t i, std::size_t j) const { return (*this)(i, j) != std::numeric_limits<T>::infinity(); }
+
+        /* @brief Number of values stored over all spans. */
+        std::size_t storedCells() const { return values_.size(); }
+
+        /* @brief Expands the matrix to a dense Vector-of-Vectors, with infinity outside the spans. */
+        std::vector<std::vector<T>> toDense() const
+        {
+            std::vector<std::vector<T>> dense(rows(), std::vector<T>(columns_, std::numeric_limits<T>::infinity()));
+            for (std::size_t i = 0; i < rows(); ++i) std::copy(row(i), row(i) + (rowEnd(i) - rowBegin(i)), dense[i].begin() + rowBegin(i));
+            return dense;
+        }
+
+        /* @brief Empties the matrix, keeping its storage, ready for rows of the given number of columns. */
+        void clear(std::size_t columns)
+        {
+            columns_ = columns;
+            begin_.clear();
+            offset_.assign(1, 0);
+            values_.clear();
+        }
+
+        /* @brief Appends the next row, holding count values starting at column begin. */
+        void appendRow(std::size_t begin, const T* values, std::size_t count)
+        {
+            begin_.push_back(begin);
+            values_.insert(values_.end(), values, values + count);
+            offset_.push_back(values_.size());
+        }
+
+        /* @brief Pads the matrix with empty rows up to rows. */
+        void resizeRows(std::size_t rows)
+        {
+            while (begin_.size() < rows) appendRow(0, nullptr, 0);
+        }
+
+    private:
+        std::size_t columns_ = 0;
+        std::vector<std::size_t> begin_;
+        std::vector<std::size_t> offset_ = std::vector<std::size_t>(1, 0);
+        std::vector<T> values_;
+    };
+
+    namespace detail
+    {
+        /* @brief Checks that two trajectories can be compared; the kernels are chosen from the dimension of the first. */
+        template <typename PointSetA, typename PointSetB>
+        void checkInputs(const PointSetA& l1, const PointSetB& l2)
+        {
+            if (l1.empty() || l2.empty())
+            {
+                throw std::runtime_error("One of the trajectories passed to frechetDistance is empty.");
+            }
+            if (l1.dimension() != l2.dimension())
+            {
+                throw std::runtime_error("The trajectories passed to frechetDistance have different dimensions.");
+            }
+        }
+
+        template <typename T>
+        void checkInputs(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2)
         {
-            std::swap(n, m);
-            std::swap(l1, l2);
+            checkInputs(DistanceMetrics::NestedView<T>(l1), DistanceMetrics::NestedView<T>(l2));
         }
-        int q = static_cast<int>(n / m);
-        int r = n % m;
-        /* Resize the distance matrix to be of the right size. */
-        distanceMatrix.reserve(n);
-        for (int idx = 0; idx < n; ++idx) distanceMatrix.push_back(std::vector<T>(m));
-        /* Now construct the 'almost diagonal' */
-        for (i = 0; i <= r * (q + 1); ++i)
+
+        /* @brief Column of row i on the 'almost diagonal' of Devogele et al. (2017), with q = n / m and r = n % m. */
+        inline int diagonalColumn(int i, int q, int r)
         {
-            j = i / (q + 1);
-            distanceMatrix[i][j] = distanceMetric(l1[i], l2[j]);
-            diagMax = std::max(distanceMatrix[i][j], diagMax);
+            return (i <= r * (q + 1)) ? i / (q + 1) : (i - r) / q;
         }
-        /* Construct the end of the diagonal */
-        for (i = r * (q + 1); i <= (n-1); ++i)
+
+        /* @brief Walks the 'almost diagonal' of Devogele et al. (2017), a valid coupling of the two trajectories.
+           @returns The maximum distance along the diagonal, an upper bound on the Frechet distance.
+           @param[in] n Number of points in the first (longer) trajectory.
+           @param[in] m Number of points in the second (shorter) trajectory.
+           @param[in] distance Callable returning the distance between point i of the first and point j of the second trajectory.
+        */
+        template <typename T, typename CellDistance>
+        T diagonalBound(int n, int m, CellDistance&& distance)
         {
-            j = (i-r) / q;
-            distanceMatrix[i][j] = distanceMetric(l1[i], l2[j]);
-            diagMax = std::max(distanceMatrix[i][j], diagMax);
+            int q = static_cast<int>(n / m);
+            int r = n % m;
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->distanceEvaluations += n;
+            T diagMax = 0.0;
+            for (int i = 0; i <= (n-1); ++i) diagMax = std::max(distance(i, diagonalColumn(i, q, r)), diagMax);
+            return diagMax;
         }
-        /* Construct the upper-right matrix */
-        int jMin = 0;
-        for (i = 0; i <= (n-1); ++i)
+
+        /* @brief Wraps a cell distance so that, when stats are enabled, every evaluation is counted together with
+         *        whether it lies off the almost diagonal. Also adds the n x m cells of the pair to the stats.
+           @param[in] n Number of points in the first trajectory.
+           @param[in] m Number of points in the second trajectory; either may be the longer.
+        */
+        template <typename CellDistance>
+        auto countedDistance(int n, int m, CellDistance& distance)
         {
-            j = i;
-            T d;
-            while ( (j < m || d <= diagMax) && j < jMin)
+            DistanceMetrics::Stats* stats = DistanceMetrics::activeStats();
+            if (stats) stats->possibleEvaluations += static_cast<std::uint64_t>(n) * m;
+            const bool rowsAreLonger = n >= m;
+            const int q = rowsAreLonger ? n / m : m / n;
+            const int r = rowsAreLonger ? n % m : m % n;
+            return [stats, rowsAreLonger, q, r, &distance](int i, int j)
             {
-                d = distanceMetric(l1[i], l2[j]);
-                if (d < diagMax)
+                if (stats)
                 {
-                    distanceMatrix[i][j] = d;
-                    j++;
+                    ++stats->distanceEvaluations;
+                    stats->offDiagonalCells += rowsAreLonger ? (j != diagonalColumn(i, q, r)) : (i != diagonalColumn(j, q, r));
                 }
+                return distance(i, j);
             };
-            jMin = j;
         }
-        /* Lower left matrix */
-        int iMin = 0;
-        for (j = 0; j <= (m-1); ++j)
+
+        /* @brief Evaluates the discrete Frechet recurrence one row at a time, keeping only two rows.
+         *
+         * Cells whose distance exceeds bound are treated as blocked, since no coupling through them can beat bound.
+         * Each row is only scanned from the first reachable column of the previous row until nothing further right
+         * can be reached, so the distances of unreachable cells are never evaluated.
+           @returns The Frechet distance, or infinity if no coupling stays within bound.
+           @param[in] n Number of rows (points in the first trajectory).
+           @param[in] m Number of columns (points in the second trajectory).
+           @param[in] cellDistance Callable returning the distance between point i of the first and point j of the second trajectory.
+           @param[in] bound Upper bound on the Frechet distance; pass infinity for an unbounded search.
+           @param[inout] previous Scratch buffer of at least m elements.
+           @param[inout] current Scratch buffer of at least m elements.
+        */
+        template <typename T, typename CellDistance>
+        T propagateRows(int n, int m, CellDistance&& cellDistance, T bound, T* previous, T* current)
         {
-            i = j;
-            T d = 0.0;
-            do 
+            const T infinity = std::numeric_limits<T>::infinity();
+            auto distance = countedDistance(n, m, cellDistance);
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->recordBytes(2 * m * sizeof(T));
+            /* The first row can only be reached from the left */
+            T d = distance(0, 0);
+            if (d > bound) return infinity;
+            previous[0] = d;
+            int previousLo = 0, previousHi = 0;
+            for (int j = 1; j < m; ++j)
+            {
+                d = distance(0, j);
+                if (d > bound) break;
+                previous[j] = std::max(previous[j-1], d);
+                previousHi = j;
+            }
+            for (int i = 1; i <= (n-1); ++i)
             {
-                d = distanceMetric(l1[i], l2[j]);
-                if (d < diagMax)
+                int lo = -1, hi = -1;
+                T left = infinity;
+                for (int j = previousLo; j < m; ++j)
                 {
-                    distanceMatrix[i][j] = d;
-                    i++;
+                    T minimum = left;
+                    if (j <= previousHi) minimum = std::min(minimum, previous[j]);
+                    if (j > previousLo && j - 1 <= previousHi) minimum = std::min(minimum, previous[j-1]);
+                    if (minimum == infinity) /* Unreachable; nothing beyond the previous row's span can be reached either */
+                    {
+                        if (j > previousHi) break;
+                        current[j] = left = infinity;
+                        continue;
+                    }
+                    d = distance(i, j);
+                    if (d > bound)
+                    {
+                        current[j] = left = infinity;
+                        if (j > previousHi) break;
+                        continue;
+                    }
+                    current[j] = left = std::max(minimum, d);
+                    if (lo < 0) lo = j;
+                    hi = j;
                 }
-            } while ( (i < n || d <= diagMax) && (i < iMin) ) ;
-            iMin = i;
+                if (lo < 0) return infinity; /* The whole row is unreachable */
+                std::swap(previous, current);
+                previousLo = lo;
+                previousHi = hi;
+            }
+            return (previousHi == m - 1) ? previous[m-1] : infinity;
         }
-        return diagMax;
-    }
 
+        /* @brief Computes the Frechet distance in O(m) memory for two trajectories already ordered so that l1 is the longer.
+         *        D is the compile-time dimension, or DistanceMetrics::DynamicDimension.
+         *
+         * The recurrence only takes maxima and minima, so the cells hold the metric's comparable values (squared
+         * distances for the Euclidean default) and the distance is taken once, from the final cell.
+           @returns The Frechet distance between l1 and l2.
+           @param[in] l1 First (longer) trajectory; any type exposing size(), dimension() and operator()(i, k).
+           @param[in] l2 Second (shorter) trajectory.
+           @param[inout] workspace Arena providing the two rows.
+           @param[in] metric Point metric policy, see Common/Metric.hpp.
+        */
+        template <typename T, std::size_t D, typename PointSet, typename Policy = DistanceMetrics::metrics::Euclidean<T>>
+        T linearFrechetDistance(const PointSet& l1, const PointSet& l2, Workspace<T>& workspace, const Policy& metric = Policy())
+        {
+            int n = l1.size(), m = l2.size();
+            auto distance = [&](int i, int j) { return metric.template measure<D>(l1, i, l2, j); };
+            T diagMax = diagonalBound<T>(n, m, distance);
+            workspace.reset();
+            T* previous = workspace.allocate(m);
+            T* current = workspace.allocate(m);
+            return metric.finish(propagateRows<T>(n, m, distance, diagMax, previous, current));
+        }
 
-    /* @brief Compute the Frechet matrix as in Devogele, T., Esnault, M., Etienne, L., & Lardy, F. (2017). Optimized Discrete Fréchet Distance between trajectories. 
-       @param[in] l1 The first trajectory to compute.
-       @param[in] l2 The second trajectory to compute.
-       @param[inout] freechetMatrix Matrix used to determine the Frechet distance between l1 and l2.
-    */
-    template <typename T>
-    void computeFrechetMatrix(std::vector<std::vector<T>>& l1, std::vector<std::vector<T>>& l2, std::vector<std::vector<T>>& frechetMatrix)
-    {
-        int i = 0, j = 0, jMin = 0;
-        /* Compute the distance matrix - it will swap l1 and l2 if required,
-        * so get n and m after this in case there's been a swap. */
-        std::vector<std::vector<T>> distanceMatrix;
-        T diagMax = computeDistanceMatrix(l1, l2, distanceMatrix);
-        int n = l1.size(), m = l2.size();
-        /* Resize the Frechet Matrix */
-        frechetMatrix.reserve(n);
-        for (unsigned idx = 0; idx < n; ++idx) frechetMatrix.push_back(std::vector<T>(m));
-        frechetMatrix[0][0] = distanceMatrix[0][0];
-        for (i = 1; i <= (n-1); ++i)
-        {
-            j = jMin;
-            while ( distanceMatrix[i][j] == 0 ) j++;
-            jMin = j;
-            while ( distanceMatrix[i][j] != 0 && j < m)
+        /* @brief Computes the Frechet distance restricted to a Sakoe-Chiba band around the almost diagonal, for two
+         *        trajectories ordered so that l1 is the longer.
+         *
+         * Row i only holds the columns within band of diagonalColumn(i), so each rolling row is a band-major slice of at
+         * most 2 * band + 1 cells and memory is O(band) regardless of the trajectory lengths. The diagonal lies inside
+         * the band, so its maximum still bounds the search.
+           @returns The smallest maximum distance over the couplings that stay inside the band.
+           @param[in] l1 First (longer) trajectory.
+           @param[in] l2 Second (shorter) trajectory.
+           @param[in] band Largest number of columns a coupling may stray from the diagonal.
+           @param[inout] workspace Arena providing the two band rows.
+        */
+        template <typename T, std::size_t D, typename PointSet>
+        T bandedFrechetDistance(const PointSet& l1, const PointSet& l2, std::size_t band, Workspace<T>& workspace)
+        {
+            /* Cells hold squared distances; the root is taken once, at the end */
+            const T infinity = std::numeric_limits<T>::infinity();
+            int n = l1.size(), m = l2.size();
+            int q = static_cast<int>(n / m);
+            int r = n % m;
+            const int width = static_cast<int>(std::min<std::size_t>(band, m));
+            auto cellDistance = [&](int i, int j) { return DistanceMetrics::squaredDistance<T, D>(l1, i, l2, j); };
+            auto window = [&](int i, int& lo, int& hi)
             {
-                T minimum = numeric_limits<T>::max() - 1; // Set to 'infinity'
-                if (i > 0 && j > 0 && distanceMatrix[i-1][j-1] != 0)
+                const int centre = diagonalColumn(i, q, r);
+                lo = std::max(0, centre - width);
+                hi = std::min(m - 1, centre + width);
+            };
+            const T diagMax = diagonalBound<T>(n, m, cellDistance);
+            auto distance = countedDistance(n, m, cellDistance);
+            workspace.reset();
+            /* Cell (i, j) of the band is stored at row[j - lo] */
+            T* previous = workspace.allocate(2 * width + 1);
+            T* current = workspace.allocate(2 * width + 1);
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->recordBytes(2 * (2 * width + 1) * sizeof(T));
+            int previousLo = 0, previousHi = 0;
+            window(0, previousLo, previousHi);
+            T left = 0.0;
+            for (int j = 0; j <= previousHi; ++j)
+            {
+                T d = distance(0, j);
+                if (d > diagMax) /* Blocked; the first row can only be reached from the left, so the rest of it is unreachable */
                 {
-                    minimum = frechetMatrix[i-1][j-1];
+                    std::fill(previous + j, previous + previousHi + 1, infinity);
+                    break;
                 }
-                if (i > 0 && distanceMatrix[i-1][j] != 0)
+                previous[j] = left = std::max(left, d);
+            }
+            for (int i = 1; i <= (n-1); ++i)
+            {
+                int lo = 0, hi = 0;
+                window(i, lo, hi);
+                bool reachable = false;
+                left = infinity;
+                for (int j = lo; j <= hi; ++j)
                 {
-                    minimum = std::min(minimum, frechetMatrix[i-1][j]);
+                    T minimum = left;
+                    if (j >= previousLo && j <= previousHi) minimum = std::min(minimum, previous[j - previousLo]);
+                    if (j - 1 >= previousLo && j - 1 <= previousHi) minimum = std::min(minimum, previous[j - 1 - previousLo]);
+                    T d = (minimum == infinity) ? infinity : distance(i, j);
+                    current[j - lo] = left = (d > diagMax) ? infinity : std::max(minimum, d);
+                    reachable = reachable || left != infinity;
                 }
-                if (j > 0 && distanceMatrix[i][j-1] != 0)
+                if (!reachable) return infinity;
+                std::swap(previous, current);
+                previousLo = lo;
+                previousHi = hi;
+            }
+            return std::sqrt(previous[(m - 1) - previousLo]);
+        }
+
+        /* @brief Computes the optimized distance matrix as in Devogele et al. (2017), together with the Frechet matrix,
+         *        in the caller's orientation and without reordering the trajectories. D is the compile-time dimension, or
+         *        DistanceMetrics::DynamicDimension.
+         *
+         * Rows are propagated exactly as in propagateRows with the diagonal maximum as the bound, on squared distances,
+         * and each row's reachable span is rooted and appended to the sparse matrices as soon as the row is complete.
+           @returns The maximum value on the 'core diagonal' of the distance matrix.
+           @param[in] l1 First trajectory; any type exposing size(), dimension() and operator()(i, k).
+           @param[in] l2 Second trajectory.
+           @param[out] distanceMatrix Receives the computed distances, or nullptr if they are not needed.
+           @param[out] frechetMatrix Receives the Frechet matrix, or nullptr if it is not needed.
+        */
+        template <typename T, std::size_t D, typename PointSet>
+        T computeSparseMatrices(const PointSet& l1, const PointSet& l2, SparseMatrix<T>* distanceMatrix, SparseMatrix<T>* frechetMatrix)
+        {
+            const T infinity = std::numeric_limits<T>::infinity();
+            checkInputs(l1, l2);
+            int n = l1.size(), m = l2.size();
+            auto cellDistance = [&](int i, int j) { return DistanceMetrics::squaredDistance<T, D>(l1, i, l2, j); };
+            /* The diagonal is walked with the longer trajectory along the rows */
+            const T diagMax = (n >= m) ? diagonalBound<T>(n, m, cellDistance) : diagonalBound<T>(m, n, [&](int i, int j) { return cellDistance(j, i); });
+            auto distance = countedDistance(n, m, cellDistance);
+            if (distanceMatrix) distanceMatrix->clear(m);
+            if (frechetMatrix) frechetMatrix->clear(m);
+
+            std::vector<T> buffer(4 * m);
+            T* previous = buffer.data();
+            T* current = previous + m;
+            T* distances = current + m;
+            T* roots = distances + m;
+            auto appendRoots = [&](SparseMatrix<T>* matrix, const T* row, int lo, int hi)
+            {
+                for (int j = lo; j <= hi; ++j) roots[j] = std::sqrt(row[j]);
+                matrix->appendRow(lo, roots + lo, hi - lo + 1);
+            };
+            int previousLo = 0, previousHi = -1;
+            for (int i = 0; i <= (n-1); ++i)
+            {
+                int lo = -1, hi = -1;
+                T left = infinity;
+                for (int j = (i == 0) ? 0 : previousLo; j < m; ++j)
                 {
-                    minimum = std::min(minimum, frechetMatrix[i][j-1]);
+                    T minimum = (i == 0 && j == 0) ? T(0) : left;
+                    if (i > 0 && j <= previousHi) minimum = std::min(minimum, previous[j]);
+                    if (i > 0 && j > previousLo && j - 1 <= previousHi) minimum = std::min(minimum, previous[j-1]);
+                    T d = (minimum == infinity) ? infinity : distance(i, j);
+                    if (d > diagMax) /* Blocked or unreachable; nothing beyond the previous row's span can be reached either */
+                    {
+                        current[j] = distances[j] = left = infinity;
+                        if (j > previousHi) break;
+                        continue;
+                    }
+                    distances[j] = d;
+                    current[j] = left = std::max(minimum, d);
+                    if (lo < 0) lo = j;
+                    hi = j;
                 }
-                frechetMatrix[i][j] = std::max(minimum, distanceMatrix[i][j]);
-                j++;
+                if (lo < 0) break; /* Only possible if the diagonal itself was rounded out; the remaining rows stay empty */
+                if (distanceMatrix) appendRoots(distanceMatrix, distances, lo, hi);
+                if (frechetMatrix) appendRoots(frechetMatrix, current, lo, hi);
+                std::swap(previous, current);
+                previousLo = lo;
+                previousHi = hi;
             }
+            if (distanceMatrix) distanceMatrix->resizeRows(n);
+            if (frechetMatrix) frechetMatrix->resizeRows(n);
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats())
+            {
+                std::size_t bytes = buffer.size() * sizeof(T);
+                if (distanceMatrix) bytes += distanceMatrix->storedCells() * sizeof(T) + 2 * n * sizeof(std::size_t);
+                if (frechetMatrix) bytes += frechetMatrix->storedCells() * sizeof(T) + 2 * n * sizeof(std::size_t);
+                stats->recordBytes(bytes);
+            }
+            return std::sqrt(diagMax);
         }
+    };
+
+    /* @brief Computes the optimized distance matrix as in Devogele, T., Esnault, M., Etienne, L., & Lardy, F. (2017).
+     *
+     * Only the cells that a coupling within the diagonal bound can reach are computed and stored, as one span per row;
+     * memory is proportional to the visited region. The trajectories are never modified or reordered, so shared
+     * read-only trajectories can be passed from many threads at once; row i always corresponds to point i of l1.
+       @returns The maximum value on the 'core diagonal' of the distance matrix.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[out] distanceMatrix Sparse l1.size() x l2.size() matrix of the computed distances.
+    */
+    template <typename T>
+    T computeDistanceMatrix(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, SparseMatrix<T>& distanceMatrix)
+    {
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::computeSparseMatrices<T, decltype(D)::value>(l1, l2, &distanceMatrix, static_cast<SparseMatrix<T>*>(nullptr));
+        });
+    }
+
+    /* @brief Computes the optimized distance matrix as in Devogele, T., Esnault, M., Etienne, L., & Lardy, F. (2017).
+       @returns The maximum value on the 'core diagonal' of the distance matrix.
+       @param[in] l1 Vector-of-Vectors containing the first trajectory.
+       @param[in] l2 Vector-of-Vectors containing the second trajectory.
+       @param[out] distanceMatrix Sparse l1.size() x l2.size() matrix of the computed distances.
+    */
+    template <typename T>
+    T computeDistanceMatrix(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, SparseMatrix<T>& distanceMatrix)
+    {
+        const DistanceMetrics::NestedView<T> view1(l1), view2(l2);
+        return DistanceMetrics::dispatchDimension(view1.dimension(), [&](auto D)
+        {
+            return detail::computeSparseMatrices<T, decltype(D)::value>(view1, view2, &distanceMatrix, static_cast<SparseMatrix<T>*>(nullptr));
+        });
+    }
+
+    /* @brief Computes the optimized distance matrix as a dense Vector-of-Vectors. Cells that were not computed hold
+     *        infinity, so a zero always means two coincident points.
+       @returns The maximum value on the 'core diagonal' of the distance matrix.
+       @param[in] l1 Vector-of-Vectors containing the first trajectory.
+       @param[in] l2 Vector-of-Vectors containing the second trajectory.
+       @param[out] distanceMatrix l1.size() x l2.size() Vector-of-Vectors containing the distance between points in a and the points in b.
+    */
+    template <typename T>
+    T computeDistanceMatrix(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, std::vector<std::vector<T>>& distanceMatrix)
+    {
+        SparseMatrix<T> sparse;
+        const T diagMax = computeDistanceMatrix(l1, l2, sparse);
+        distanceMatrix = sparse.toDense();
+        return diagMax;
+    }
+
+    /* @brief Computes the optimized distance matrix for two trajectories held in flat, strided buffers, as a dense
+     *        Vector-of-Vectors. Cells that were not computed hold infinity.
+       @returns The maximum value on the 'core diagonal' of the distance matrix.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[out] distanceMatrix l1.size() x l2.size() Vector-of-Vectors containing the distance between points in a and the points in b.
+    */
+    template <typename T>
+    T computeDistanceMatrix(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, std::vector<std::vector<T>>& distanceMatrix)
+    {
+        SparseMatrix<T> sparse;
+        const T diagMax = computeDistanceMatrix(l1, l2, sparse);
+        distanceMatrix = sparse.toDense();
+        return diagMax;
+    }
+
+    /* @brief Compute the Frechet matrix as in Devogele, T., Esnault, M., Etienne, L., & Lardy, F. (2017). Optimized Discrete Fréchet Distance between trajectories.
+     *
+     * Only the region reachable within the diagonal bound is stored, as one span per row.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[out] frechetMatrix Sparse l1.size() x l2.size() matrix; the last cell holds the Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    void computeFrechetMatrix(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, SparseMatrix<T>& frechetMatrix)
+    {
+        DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            detail::computeSparseMatrices<T, decltype(D)::value>(l1, l2, static_cast<SparseMatrix<T>*>(nullptr), &frechetMatrix);
+        });
+    }
+
+    /* @brief Compute the Frechet matrix as in Devogele, T., Esnault, M., Etienne, L., & Lardy, F. (2017), stored sparsely.
+       @param[in] l1 The first trajectory to compute.
+       @param[in] l2 The second trajectory to compute.
+       @param[out] frechetMatrix Sparse l1.size() x l2.size() matrix; the last cell holds the Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    void computeFrechetMatrix(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, SparseMatrix<T>& frechetMatrix)
+    {
+        const DistanceMetrics::NestedView<T> view1(l1), view2(l2);
+        DistanceMetrics::dispatchDimension(view1.dimension(), [&](auto D)
+        {
+            detail::computeSparseMatrices<T, decltype(D)::value>(view1, view2, static_cast<SparseMatrix<T>*>(nullptr), &frechetMatrix);
+        });
+    }
+
+    /* @brief Compute the Frechet matrix as in Devogele, T., Esnault, M., Etienne, L., & Lardy, F. (2017). Optimized Discrete Fréchet Distance between trajectories.
+       @param[in] l1 The first trajectory to compute.
+       @param[in] l2 The second trajectory to compute.
+       @param[out] frechetMatrix l1.size() x l2.size() matrix used to determine the Frechet distance between l1 and l2; cells that were not computed hold infinity.
+    */
+    template <typename T>
+    void computeFrechetMatrix(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, std::vector<std::vector<T>>& frechetMatrix)
+    {
+        SparseMatrix<T> sparse;
+        computeFrechetMatrix(l1, l2, sparse);
+        frechetMatrix = sparse.toDense();
+    }
+
+    /* @brief Compute the Frechet matrix for two trajectories held in flat, strided buffers.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[out] frechetMatrix l1.size() x l2.size() matrix used to determine the Frechet distance between l1 and l2; cells that were not computed hold infinity.
+    */
+    template <typename T>
+    void computeFrechetMatrix(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, std::vector<std::vector<T>>& frechetMatrix)
+    {
+        SparseMatrix<T> sparse;
+        computeFrechetMatrix(l1, l2, sparse);
+        frechetMatrix = sparse.toDense();
     }
 
     /* @brief Computes the Frechet distance between two trajectories.
+     *
+     * By default only two rolling rows are kept (Mode::LinearMemory); Mode::FullMatrix stores the Frechet matrix.
+     * In either mode the trajectories are left untouched.
        @param[in] l1 The first trajectory to compute.
        @param[in] l2 The second trajectory to compute.
+       @param[in] mode Whether to use linear memory or materialise the full matrices.
        @returns The Frechet distance between l1 and l2.
     */
     template <typename T>
-    T frechetDistance(std::vector<std::vector<T>>& l1, std::vector<std::vector<T>>& l2)
+    T frechetDistance(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, Mode mode = Mode::LinearMemory)
+    {
+        if (mode == Mode::FullMatrix)
+        {
+            SparseMatrix<T> frechetMatrix;
+            computeFrechetMatrix(l1, l2, frechetMatrix);
+            return frechetMatrix( l1.size() - 1, l2.size() - 1 );
+        }
+        return frechetDistance(l1, l2, detail::threadWorkspace<T>());
+    }
+
+    /* @brief Computes the Frechet distance between two trajectories in linear memory, drawing the rows from a
+     *        caller-owned workspace. The trajectories are left untouched.
+       @param[in] l1 The first trajectory to compute.
+       @param[in] l2 The second trajectory to compute.
+       @param[inout] workspace Scratch arena, reusable across calls.
+       @returns The Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    T frechetDistance(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        DistanceMetrics::NestedView<T> view1(l1), view2(l2);
+        if (view1.size() < view2.size()) std::swap(view1, view2); /* Keep the shorter trajectory along the columns */
+        return DistanceMetrics::dispatchDimension(view1.dimension(), [&](auto D)
+        {
+            return detail::linearFrechetDistance<T, decltype(D)::value>(view1, view2, workspace);
+        });
+    }
+
+    /* @brief Computes the Frechet distance between two trajectories held in flat, strided buffers.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] mode Whether to use linear memory or materialise the full matrices.
+       @returns The Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    T frechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, Mode mode = Mode::LinearMemory)
+    {
+        detail::checkInputs(l1, l2);
+        if (mode == Mode::FullMatrix)
+        {
+            SparseMatrix<T> frechetMatrix;
+            computeFrechetMatrix(l1, l2, frechetMatrix);
+            return frechetMatrix( l1.size() - 1, l2.size() - 1 );
+        }
+        return frechetDistance(l1, l2, detail::threadWorkspace<T>());
+    }
+
+    /* @brief Computes the Frechet distance between two trajectories held in flat, strided buffers, in linear memory,
+     *        drawing the rows from a caller-owned workspace.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[inout] workspace Scratch arena, reusable across calls.
+       @returns The Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    T frechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        if (l1.size() < l2.size()) std::swap(l1, l2);
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::linearFrechetDistance<T, decltype(D)::value>(l1, l2, workspace);
+        });
+    }
+
+    /* @brief Computes the Frechet distance between two trajectories under a point metric policy (see Common/Metric.hpp),
+     *        e.g. WeightedEuclidean for mixed position and velocity states or GreatCircle for latitude and longitude.
+     *
+     * The cells hold the policy's comparable values and the distance is finished once, from the final cell.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] metric The point metric.
+       @param[inout] workspace Scratch arena, reusable across calls.
+       @returns The Frechet distance between l1 and l2 under metric.
+    */
+    template <typename T, typename Policy, typename = std::enable_if_t<DistanceMetrics::metrics::IsPolicy<Policy>::value>>
+    T frechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, const Policy& metric, Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        metric.check(l1.dimension());
+        if (l1.size() < l2.size()) std::swap(l1, l2);
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::linearFrechetDistance<T, decltype(D)::value>(l1, l2, workspace, metric);
+        });
+    }
+
+    /* @brief Computes the Frechet distance between two trajectories under a point metric policy.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] metric The point metric.
+       @returns The Frechet distance between l1 and l2 under metric.
+    */
+    template <typename T, typename Policy, typename = std::enable_if_t<DistanceMetrics::metrics::IsPolicy<Policy>::value>>
+    T frechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, const Policy& metric)
+    {
+        return frechetDistance(l1, l2, metric, detail::threadWorkspace<T>());
+    }
+
+    namespace detail
+    {
+        /* @brief Decides whether the Frechet distance of two trajectories, ordered so that l1 is the longer, is at most eps.
+         *        Everything is compared in the metric's comparable values, so no distance is ever finished.
+        */
+        template <typename T, std::size_t D, typename PointSet, typename Policy = DistanceMetrics::metrics::Euclidean<T>>
+        bool frechetWithin(const PointSet& l1, const PointSet& l2, T eps, Workspace<T>& workspace, const Policy& metric = Policy())
+        {
+            int n = l1.size(), m = l2.size();
+            auto distance = [&](int i, int j) { return metric.template measure<D>(l1, i, l2, j); };
+            const T threshold = metric.threshold(eps);
+            /* Every coupling pairs the first points and the last points */
+            if (distance(0, 0) > threshold || distance(n - 1, m - 1) > threshold) return false;
+            /* The diagonal is itself a coupling, so if it stays within eps there is nothing left to decide */
+            if (diagonalBound<T>(n, m, distance) <= threshold) return true;
+            workspace.reset();
+            T* previous = workspace.allocate(m);
+            T* current = workspace.allocate(m);
+            /* Cells further apart than eps are blocked, so the sweep stops at the first row that cannot be reached */
+            return propagateRows<T>(n, m, distance, threshold, previous, current) <= threshold;
+        }
+
+        /* @brief Computes the Frechet distance of two trajectories, ordered so that l1 is the longer, unless it exceeds cutoff.
+           @returns The Frechet distance if it is at most cutoff, otherwise a value greater than cutoff.
+        */
+        template <typename T, std::size_t D, typename PointSet, typename Policy = DistanceMetrics::metrics::Euclidean<T>>
+        T boundedFrechetDistance(const PointSet& l1, const PointSet& l2, T cutoff, Workspace<T>& workspace, const Policy& metric = Policy())
+        {
+            int n = l1.size(), m = l2.size();
+            auto distance = [&](int i, int j) { return metric.template measure<D>(l1, i, l2, j); };
+            const T threshold = metric.threshold(cutoff);
+            const T endpoints = std::max(distance(0, 0), distance(n - 1, m - 1));
+            if (endpoints > threshold) return metric.finish(endpoints);
+            /* Whichever of the diagonal and the cutoff is tighter bounds every coupling worth finding */
+            const T bound = std::min(diagonalBound<T>(n, m, distance), threshold);
+            workspace.reset();
+            T* previous = workspace.allocate(m);
+            T* current = workspace.allocate(m);
+            return metric.finish(propagateRows<T>(n, m, distance, bound, previous, current));
+        }
+    };
+
+    /* @brief Decides whether the Frechet distance between two trajectories is at most eps.
+     *
+     * Uses the same free-space propagation as frechetDistance with eps as the bound: cells further apart than eps
+     * are never stored, and the sweep returns as soon as an entire row becomes unreachable. This is typically far
+     * cheaper than computing the distance itself. Like the cutoff of frechetDistance, eps is a double whatever T is;
+     * for float it is rounded up, so no distance within it is rejected.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] eps Threshold on the Frechet distance.
+       @param[inout] workspace Scratch arena, reusable across calls.
+       @returns Whether the Frechet distance between l1 and l2 is at most eps.
+    */
+    template <typename T>
+    bool frechetWithin(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double eps, Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        if (l1.size() < l2.size()) std::swap(l1, l2);
+        const T bound = DistanceMetrics::detail::roundedUp<T>(eps);
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::frechetWithin<T, decltype(D)::value>(l1, l2, bound, workspace);
+        });
+    }
+
+    /* @brief Decides whether the Frechet distance between two trajectories is at most eps.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] eps Threshold on the Frechet distance.
+       @returns Whether the Frechet distance between l1 and l2 is at most eps.
+    */
+    template <typename T>
+    bool frechetWithin(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double eps)
+    {
+        return frechetWithin(l1, l2, eps, detail::threadWorkspace<T>());
+    }
+
+    /* @brief Decides whether the Frechet distance between two trajectories under a point metric policy is at most eps.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] eps Threshold on the Frechet distance.
+       @param[in] metric The point metric.
+       @returns Whether the Frechet distance between l1 and l2 under metric is at most eps.
+    */
+    template <typename T, typename Policy, typename = std::enable_if_t<DistanceMetrics::metrics::IsPolicy<Policy>::value>>
+    bool frechetWithin(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double eps, const Policy& metric)
+    {
+        detail::checkInputs(l1, l2);
+        metric.check(l1.dimension());
+        if (l1.size() < l2.size()) std::swap(l1, l2);
+        Workspace<T>& workspace = detail::threadWorkspace<T>();
+        const T bound = DistanceMetrics::detail::roundedUp<T>(eps);
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::frechetWithin<T, decltype(D)::value>(l1, l2, bound, workspace, metric);
+        });
+    }
+
+    /* @brief Decides whether the Frechet distance between two trajectories is at most eps.
+       @param[in] l1 The first trajectory.
+       @param[in] l2 The second trajectory.
+       @param[in] eps Threshold on the Frechet distance.
+       @returns Whether the Frechet distance between l1 and l2 is at most eps.
+    */
+    template <typename T>
+    bool frechetWithin(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, double eps)
+    {
+        detail::checkInputs(l1, l2);
+        DistanceMetrics::NestedView<T> view1(l1), view2(l2);
+        if (view1.size() < view2.size()) std::swap(view1, view2);
+        Workspace<T>& workspace = detail::threadWorkspace<T>();
+        const T bound = DistanceMetrics::detail::roundedUp<T>(eps);
+        return DistanceMetrics::dispatchDimension(view1.dimension(), [&](auto D)
+        {
+            return detail::frechetWithin<T, decltype(D)::value>(view1, view2, bound, workspace);
+        });
+    }
+
+    /* @brief Computes the Frechet distance over the couplings that stay within a Sakoe-Chiba band of the diagonal.
+     *
+     * The diagonal maps the longer trajectory uniformly onto the shorter, so for time-aligned trajectories a narrow
+     * band already contains the optimal coupling; only the cells inside the band are ever evaluated, and memory is
+     * O(band). When the optimal coupling leaves the band the result is an upper bound on the Frechet distance.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] band Largest number of points of the shorter trajectory a coupling may stray from the diagonal.
+       @param[inout] workspace Scratch arena, reusable across calls.
+       @returns The band-constrained Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    T bandedFrechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, std::size_t band, Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        if (l1.size() < l2.size()) std::swap(l1, l2);
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::bandedFrechetDistance<T, decltype(D)::value>(l1, l2, band, workspace);
+        });
+    }
+
+    /* @brief Computes the Frechet distance over the couplings that stay within a Sakoe-Chiba band of the diagonal.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] band Largest number of points of the shorter trajectory a coupling may stray from the diagonal.
+       @returns The band-constrained Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    T bandedFrechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, std::size_t band)
+    {
+        return bandedFrechetDistance(l1, l2, band, detail::threadWorkspace<T>());
+    }
+
+    /* @brief Computes the Frechet distance over the couplings that stay within a Sakoe-Chiba band of the diagonal.
+       @param[in] l1 The first trajectory.
+       @param[in] l2 The second trajectory.
+       @param[in] band Largest number of points of the shorter trajectory a coupling may stray from the diagonal.
+       @returns The band-constrained Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    T bandedFrechetDistance(const std::vector<std::vector<T>>& l1, const std::vector<std::vector<T>>& l2, std::size_t band)
+    {
+        detail::checkInputs(l1, l2);
+        DistanceMetrics::NestedView<T> view1(l1), view2(l2);
+        if (view1.size() < view2.size()) std::swap(view1, view2);
+        Workspace<T>& workspace = detail::threadWorkspace<T>();
+        return DistanceMetrics::dispatchDimension(view1.dimension(), [&](auto D)
+        {
+            return detail::bandedFrechetDistance<T, decltype(D)::value>(view1, view2, band, workspace);
+        });
+    }
+
+    /* @brief Computes the Frechet distance between two trajectories, giving up as soon as it is known to exceed cutoff.
+     *
+     * Intended for nearest-trajectory searches, where cutoff is the current k-th best distance: the propagation is
+     * bounded by the smaller of the cutoff and the diagonal bound, and stops at the first row that cannot be reached.
+     * Like the Hausdorff cutoff overloads, the cutoff and the result are doubles whatever T is; for float the cutoff
+     * is rounded up, so no distance within it is abandoned.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] cutoff Largest distance of interest.
+       @param[inout] workspace Scratch arena, reusable across calls.
+       @returns The Frechet distance if it is at most cutoff, otherwise a value greater than cutoff (possibly infinity).
+    */
+    template <typename T>
+    double frechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double cutoff, Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        if (l1.size() < l2.size()) std::swap(l1, l2);
+        const T bound = DistanceMetrics::detail::roundedUp<T>(cutoff);
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return static_cast<double>(detail::boundedFrechetDistance<T, decltype(D)::value>(l1, l2, bound, workspace));
+        });
+    }
+
+    /* @brief Computes the Frechet distance between two trajectories, giving up as soon as it is known to exceed cutoff.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] cutoff Largest distance of interest.
+       @returns The Frechet distance if it is at most cutoff, otherwise a value greater than cutoff (possibly infinity).
+    */
+    template <typename T>
+    double frechetDistance(DistanceMetrics::TrajectoryView<T> l1, DistanceMetrics::TrajectoryView<T> l2, double cutoff)
+    {
+        return frechetDistance(l1, l2, cutoff, detail::threadWorkspace<T>());
+    }
+
+    /* @brief Computes the Frechet distance between two trajectories of fixed-dimension points (e.g. std::array<double, 3>).
+       @param[in] l1 The first trajectory to compute.
+       @param[in] l2 The second trajectory to compute.
+       @returns The Frechet distance between l1 and l2.
+    */
+    template <typename T, std::size_t D>
+    T frechetDistance(const std::vector<std::array<T, D>>& l1, const std::vector<std::array<T, D>>& l2)
     {
-        std::vector<std::vector<T>> frechetMatrix;
-        computeFrechetMatrix(l1, l2, frechetMatrix);
-        return frechetMatrix[ l1.size() - 1 ][ l2.size() - 1 ];
+        DistanceMetrics::TrajectoryView<T> view1 = DistanceMetrics::makeView(l1), view2 = DistanceMetrics::makeView(l2);
+        detail::checkInputs(view1, view2);
+        if (view1.size() < view2.size()) std::swap(view1, view2);
+        Workspace<T>& workspace = detail::threadWorkspace<T>();
+        return detail::linearFrechetDistance<T, D>(view1, view2, workspace);
     }
 };
 #endif
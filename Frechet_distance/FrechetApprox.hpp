@@ -0,0 +1,155 @@
+/*  Coarse-to-fine Frechet Distance
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __FRECHET_APPROX_H__
+#define __FRECHET_APPROX_H__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "Frechet.hpp"
+
+namespace Frechet
+{
+    /* @brief Result of an approximate Frechet distance: the exact distance lies in [value - errorBound, value + errorBound]. */
+    template <typename T>
+    struct Approximation
+    {
+        T value;
+        T errorBound;
+    };
+
+    /* @brief Simplifies a trajectory by greedy decimation: a point is kept only if it lies further than tolerance from
+     *        the last point kept, and the final point is always kept.
+     *
+     * Mapping every dropped point to the last kept point before it is a valid coupling, so the discrete Frechet
+     * distance between the trajectory and its simplification is at most the returned error (itself at most tolerance).
+     * Douglas-Peucker offers no such guarantee for the discrete distance, as it measures error against segments
+     * rather than against vertices. The tolerance is a double whatever T is; for float it is rounded up to T.
+       @returns The discrete Frechet distance bound between l and its simplification.
+       @param[in] l Trajectory to simplify.
+       @param[in] tolerance Largest distance a dropped point may lie from the point it is merged into.
+       @param[out] simplified The simplified trajectory, row-major.
+    */
+    template <typename T>
+    T simplify(const DistanceMetrics::TrajectoryView<T>& l, double tolerance, DistanceMetrics::Trajectory<T>& simplified)
+    {
+        if (l.empty())
+        {
+            throw std::runtime_error("The trajectory passed to simplify is empty.");
+        }
+        const std::size_t dimension = l.dimension();
+        const T rounded = DistanceMetrics::detail::roundedUp<T>(tolerance);
+        const T toleranceSquared = rounded * rounded;
+        std::vector<T> point(dimension);
+        auto keep = [&](std::size_t i)
+        {
+            for (std::size_t k = 0; k < dimension; ++k) point[k] = l(i, k);
+            simplified.push_back(point.data());
+        };
+        simplified = DistanceMetrics::Trajectory<T>(dimension);
+        keep(0);
+        std::size_t anchor = 0;
+        T error = 0.0;
+        for (std::size_t i = 1; i < l.size(); ++i)
+        {
+            const T d = DistanceMetrics::squaredDistance<T>(l, anchor, l, i);
+            if (d > toleranceSquared)
+            {
+                keep(i);
+                anchor = i;
+            }
+            else if (i == l.size() - 1)
+            {
+                keep(i);
+            }
+            else
+            {
+                error = std::max(error, d);
+            }
+        }
+        return std::sqrt(error);
+    }
+
+    /* @brief Approximates the Frechet distance from simplified copies of both trajectories.
+     *
+     * By the triangle inequality the distance between the simplifications differs from the true distance by at most
+     * the sum of the two simplification errors, which is returned as the error bound. Oversampled trajectories shrink
+     * by orders of magnitude for a tolerance of about 1% of the expected distance.
+       @returns The approximate distance and its error bound.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] tolerance Simplification tolerance; the error bound is at most twice this.
+       @param[inout] workspace Scratch arena, reusable across calls.
+    */
+    template <typename T>
+    Approximation<T> approximateFrechetDistance(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, double tolerance,
+                                                Workspace<T>& workspace)
+    {
+        detail::checkInputs(l1, l2);
+        DistanceMetrics::Trajectory<T> coarse1, coarse2;
+        const T error1 = simplify(l1, tolerance, coarse1);
+        const T error2 = simplify(l2, tolerance, coarse2);
+        return Approximation<T> { frechetDistance(coarse1.view(), coarse2.view(), workspace), error1 + error2 };
+    }
+
+    /* @brief Approximates the Frechet distance from simplified copies of both trajectories.
+       @returns The approximate distance and its error bound.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] tolerance Simplification tolerance; the error bound is at most twice this.
+    */
+    template <typename T>
+    Approximation<T> approximateFrechetDistance(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, double tolerance)
+    {
+        return approximateFrechetDistance(l1, l2, tolerance, detail::threadWorkspace<T>());
+    }
+
+    /* @brief Computes the exact Frechet distance coarse-to-fine: the approximation on the simplified trajectories gives
+     *        an upper bound (value + errorBound), usually far tighter than the Devogele diagonal, which confines the
+     *        full-resolution propagation to a narrow band around the optimal coupling.
+       @returns The Frechet distance between l1 and l2.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] tolerance Simplification tolerance used for the coarse pass.
+       @param[inout] workspace Scratch arena, reusable across calls.
+    */
+    template <typename T>
+    T coarseToFineFrechetDistance(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, double tolerance,
+                                  Workspace<T>& workspace)
+    {
+        const Approximation<T> coarse = approximateFrechetDistance(l1, l2, tolerance, workspace);
+        /* Widen the bound slightly so that rounding in the coarse pass can never exclude the optimal coupling */
+        const T bound = (coarse.value + coarse.errorBound) * (1 + 16 * std::numeric_limits<T>::epsilon());
+        const T distance = frechetDistance(l1, l2, bound, workspace);
+        return (distance <= bound) ? distance : frechetDistance(l1, l2, workspace);
+    }
+
+    /* @brief Computes the exact Frechet distance coarse-to-fine.
+       @returns The Frechet distance between l1 and l2.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] tolerance Simplification tolerance used for the coarse pass.
+    */
+    template <typename T>
+    T coarseToFineFrechetDistance(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, double tolerance)
+    {
+        return coarseToFineFrechetDistance(l1, l2, tolerance, detail::threadWorkspace<T>());
+    }
+};
+#endif
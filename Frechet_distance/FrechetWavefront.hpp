@@ -0,0 +1,180 @@
+/*  Parallel wavefront Frechet Distance
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __FRECHET_WAVEFRONT_H__
+#define __FRECHET_WAVEFRONT_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "Frechet.hpp"
+
+namespace Frechet
+{
+    namespace detail
+    {
+        /* @brief Copies a trajectory into structure-of-arrays order, coordinate k of point i at packed[k * size + i]. */
+        template <typename T>
+        std::vector<T> packColumns(const DistanceMetrics::TrajectoryView<T>& l)
+        {
+            std::vector<T> packed(l.size() * l.dimension());
+            for (std::size_t k = 0; k < l.dimension(); ++k)
+            {
+                for (std::size_t i = 0; i < l.size(); ++i) packed[k * l.size() + i] = l(i, k);
+            }
+            return packed;
+        }
+
+        /* @brief Evaluates the Frechet recurrence in tiles of tileSize x tileSize cells, as a wavefront across threads.
+         *
+         * Tile row I is owned by thread I % threads and swept left to right; tile (I, J) starts once tile (I - 1, J) is
+         * done, so up to min(threads, tile rows) tiles on an anti-diagonal run at once. The only shared state is the
+         * bottom row of the tile row above, one value per column: each tile reads its top halo from it and then overwrites
+         * it with its own bottom row, after saving the value that the next tile needs as its top-left corner.
+           @returns The Frechet distance between l1 and l2.
+        */
+        template <typename T, std::size_t D>
+        T wavefrontFrechetDistance(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, unsigned threads, std::size_t tileSize)
+        {
+            const T infinity = std::numeric_limits<T>::infinity();
+            const std::size_t n = l1.size(), m = l2.size();
+            const std::size_t dimension = (D == DistanceMetrics::DynamicDimension) ? l1.dimension() : D;
+            const std::size_t B = std::max<std::size_t>(1, tileSize);
+            const std::size_t tileRows = (n + B - 1) / B, tileColumns = (m + B - 1) / B;
+            const std::vector<T> rows = packColumns(l1), columns = packColumns(l2);
+
+            /* The diagonal bounds the search as in the serial engine; the slack absorbs any difference in rounding
+             * between this distance and the vectorised one below, as pruning only has to be conservative. As there,
+             * the cells hold squared distances and the root is taken once, from the final cell.
+             */
+            auto distance = [&](int i, int j) { return DistanceMetrics::squaredDistance<T, D>(l1, i, l2, j); };
+            T diagMax = (n >= m) ? diagonalBound<T>(n, m, distance) : diagonalBound<T>(m, n, [&](int i, int j) { return distance(j, i); });
+            diagMax *= 1 + 16 * std::numeric_limits<T>::epsilon();
+
+            threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(tileRows)));
+            std::vector<T> bottom(m, infinity);
+            std::unique_ptr<std::atomic<std::size_t>[]> progress(new std::atomic<std::size_t>[tileRows]);
+            for (std::size_t I = 0; I < tileRows; ++I) progress[I].store(0);
+
+            using A = DistanceMetrics::AccumulatorType<T>;
+            auto work = [&](unsigned worker)
+            {
+                /* (B + 1) x (B + 1) tile with a halo of the row above and the column to the left */
+                std::vector<T> tile((B + 1) * (B + 1)), leftColumn(B);
+                std::vector<A> distances(B * B);
+                for (std::size_t I = worker; I < tileRows; I += threads)
+                {
+                    const std::size_t i0 = I * B, h = std::min(B, n - i0);
+                    std::fill(leftColumn.begin(), leftColumn.end(), infinity);
+                    /* A zero corner seeds cell (0, 0); every other tile row has nothing above-left of its first tile */
+                    T corner = (I == 0) ? T(0) : infinity;
+                    for (std::size_t J = 0; J < tileColumns; ++J)
+                    {
+                        const std::size_t j0 = J * B, w = std::min(B, m - j0), stride = w + 1;
+                        if (I > 0)
+                        {
+                            while (progress[I - 1].load(std::memory_order_acquire) <= J) std::this_thread::yield();
+                        }
+                        T* halo = tile.data();
+                        halo[0] = corner;
+                        bool open = corner != infinity;
+                        for (std::size_t jj = 0; jj < w; ++jj)
+                        {
+                            halo[1 + jj] = bottom[j0 + jj];
+                            open = open || halo[1 + jj] != infinity;
+                        }
+                        for (std::size_t ii = 0; ii < h; ++ii)
+                        {
+                            halo[(ii + 1) * stride] = leftColumn[ii];
+                            open = open || leftColumn[ii] != infinity;
+                        }
+
+                        if (open)
+                        {
+                            /* Distances first, one row of the tile at a time, so that the loop over columns vectorises;
+                             * summed in the accumulator type and rounded once per distance, as squaredDistance does */
+                            for (std::size_t ii = 0; ii < h; ++ii)
+                            {
+                                A* row = distances.data() + ii * w;
+                                std::fill(row, row + w, A(0));
+                                for (std::size_t k = 0; k < dimension; ++k)
+                                {
+                                    const A a = rows[k * n + i0 + ii];
+                                    const T* b = columns.data() + k * m + j0;
+                                    for (std::size_t jj = 0; jj < w; ++jj) row[jj] += DistanceMetrics::detail::squaredDifference<A>(a, b[jj]);
+                                }
+                            }
+                            for (std::size_t ii = 0; ii < h; ++ii)
+                            {
+                                const T* above = halo + ii * stride;
+                                T* current = halo + (ii + 1) * stride;
+                                for (std::size_t jj = 0; jj < w; ++jj)
+                                {
+                                    const T minimum = std::min({ above[jj], above[jj + 1], current[jj] });
+                                    const T d = static_cast<T>(distances[ii * w + jj]);
+                                    current[jj + 1] = (minimum == infinity || d > diagMax) ? infinity : std::max(minimum, d);
+                                }
+                            }
+                        }
+                        else /* Nothing enters this tile, so nothing in it is reachable */
+                        {
+                            for (std::size_t ii = 0; ii < h; ++ii) std::fill(halo + (ii + 1) * stride + 1, halo + (ii + 2) * stride, infinity);
+                        }
+
+                        corner = bottom[j0 + w - 1];
+                        for (std::size_t jj = 0; jj < w; ++jj) bottom[j0 + jj] = halo[h * stride + jj + 1];
+                        for (std::size_t ii = 0; ii < h; ++ii) leftColumn[ii] = halo[(ii + 1) * stride + w];
+                        progress[I].store(J + 1, std::memory_order_release);
+                    }
+                }
+            };
+            std::vector<std::thread> pool;
+            for (unsigned worker = 1; worker < threads; ++worker) pool.emplace_back(work, worker);
+            work(0);
+            for (std::thread& thread : pool) thread.join();
+            return std::sqrt(bottom[m - 1]);
+        }
+    };
+
+    /* @brief Computes the Frechet distance of a single, very long pair of trajectories on several threads.
+     *
+     * The dynamic programme is cut into square tiles that are evaluated as a wavefront: thread t owns every tile row
+     * congruent to t and follows one tile behind the row above it. Within a tile the distances are vectorised and the
+     * Devogele diagonal bound prunes cells, and tiles that nothing can enter are skipped. Memory is O(n + m) plus
+     * one tile per thread.
+       @param[in] l1 View of the first trajectory.
+       @param[in] l2 View of the second trajectory.
+       @param[in] threads Number of worker threads; 0 uses every hardware thread.
+       @param[in] tileSize Side of a tile, in points; large enough to amortise synchronisation, small enough to fit in cache.
+       @returns The Frechet distance between l1 and l2.
+    */
+    template <typename T>
+    T wavefrontFrechetDistance(const DistanceMetrics::TrajectoryView<T>& l1, const DistanceMetrics::TrajectoryView<T>& l2, unsigned threads = 0, std::size_t tileSize = 256)
+    {
+        detail::checkInputs(l1, l2);
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        return DistanceMetrics::dispatchDimension(l1.dimension(), [&](auto D)
+        {
+            return detail::wavefrontFrechetDistance<T, decltype(D)::value>(l1, l2, threads, tileSize);
+        });
+    }
+};
+#endif
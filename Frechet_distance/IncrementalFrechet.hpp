@@ -0,0 +1,182 @@
+/*  Incremental Frechet Distance for growing trajectories
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __INCREMENTAL_FRECHET_H__
+#define __INCREMENTAL_FRECHET_H__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "Frechet.hpp"
+
+namespace Frechet
+{
+    /* @brief Frechet distance between a fixed reference trajectory and a trajectory that grows one point at a time.
+     *
+     * Only the frontier of the recurrence is kept: the last row of the Frechet matrix, one value per reference point,
+     * where frontier[j] is the Frechet distance between the points appended so far and the first j + 1 reference
+     * points. Appending k points therefore costs O(k * m) time and the object needs O(m) memory, however long the
+     * growing trajectory becomes. The reference is copied into structure-of-arrays order so that the distances of each
+     * new row vectorise. The frontier holds squared distances, as the recurrence only takes maxima and minima; roots are
+     * taken only when a distance is read.
+     *
+     * Every coupling of any extension of the growing trajectory passes through the current frontier row, and values of
+     * the recurrence never decrease along a coupling, so once the smallest frontier value exceeds eps the final
+     * distance will too; alreadyExceeds(eps) reports exactly that.
+     */
+    template <typename T>
+    class IncrementalFrechet
+    {
+    public:
+        /* @brief Copies the reference; any type exposing size(), dimension() and operator()(i, k), such as a TrajectoryView. */
+        template <typename PointSet>
+        explicit IncrementalFrechet(const PointSet& reference)
+            : m_(reference.size()), dimension_(reference.dimension())
+        {
+            if (reference.empty())
+            {
+                throw std::runtime_error("The reference trajectory passed to IncrementalFrechet is empty.");
+            }
+            columns_.resize(m_ * dimension_);
+            for (std::size_t k = 0; k < dimension_; ++k)
+            {
+                for (std::size_t j = 0; j < m_; ++j) columns_[k * m_ + j] = reference(j, k);
+            }
+            frontier_.resize(m_);
+            distances_.resize(m_);
+        }
+
+        explicit IncrementalFrechet(const std::vector<std::vector<T>>& reference)
+            : IncrementalFrechet(DistanceMetrics::NestedView<T>(reference))
+        {
+        }
+
+        /* @brief Extends the growing trajectory by one point of dimension() coordinates, in O(m). */
+        void append(const T* point)
+        {
+            const T infinity = std::numeric_limits<T>::infinity();
+            rowDistances(point);
+            if (size_ == 0) /* The first row can only be reached from the left */
+            {
+                T left = 0.0;
+                for (std::size_t j = 0; j < m_; ++j) frontier_[j] = left = std::max(left, distances_[j]);
+            }
+            else
+            {
+                /* frontier_ holds the previous row; diagonal keeps the previous row's value at j - 1 before it is overwritten */
+                T diagonal = infinity, left = infinity;
+                for (std::size_t j = 0; j < m_; ++j)
+                {
+                    const T above = frontier_[j];
+                    frontier_[j] = left = std::max(std::min({ above, diagonal, left }), distances_[j]);
+                    diagonal = above;
+                }
+            }
+            frontierMinimum_ = *std::min_element(frontier_.begin(), frontier_.end());
+            ++size_;
+        }
+
+        void append(const std::vector<T>& point)
+        {
+            if (point.size() != dimension_)
+            {
+                throw std::runtime_error("The point passed to IncrementalFrechet::append has the wrong dimension.");
+            }
+            append(point.data());
+        }
+
+        /* @brief Extends the growing trajectory by the k points of a view, in O(k * m). */
+        void append(const DistanceMetrics::TrajectoryView<T>& points)
+        {
+            if (!points.empty() && points.dimension() != dimension_)
+            {
+                throw std::runtime_error("The points passed to IncrementalFrechet::append have the wrong dimension.");
+            }
+            std::vector<T> point(dimension_);
+            for (std::size_t i = 0; i < points.size(); ++i)
+            {
+                for (std::size_t k = 0; k < dimension_; ++k) point[k] = points(i, k);
+                append(point.data());
+            }
+        }
+
+        /* @brief The Frechet distance between the points appended so far and the whole reference. */
+        T distance() const
+        {
+            if (size_ == 0)
+            {
+                throw std::runtime_error("No points have been appended to the IncrementalFrechet trajectory.");
+            }
+            return std::sqrt(frontier_[m_ - 1]);
+        }
+
+        /* @brief Whether the distance is already known to exceed eps, however the trajectory continues. */
+        bool alreadyExceeds(T eps) const
+        {
+            return size_ > 0 && frontierMinimum_ > DistanceMetrics::metrics::detail::squaredThreshold(eps);
+        }
+
+        /* @brief Smallest value on the frontier; a lower bound on the distance after any number of further appends. */
+        T frontierMinimum() const { return std::sqrt(frontierMinimum_); }
+
+        /* @brief A copy of the last row of the Frechet matrix, one distance per reference point. */
+        std::vector<T> frontier() const
+        {
+            std::vector<T> distances(m_);
+            for (std::size_t j = 0; j < m_; ++j) distances[j] = std::sqrt(frontier_[j]);
+            return distances;
+        }
+
+        /* @brief Number of points appended so far. */
+        std::size_t size() const { return size_; }
+        std::size_t referenceSize() const { return m_; }
+        std::size_t dimension() const { return dimension_; }
+
+        /* @brief Forgets the appended points, keeping the reference. */
+        void reset()
+        {
+            size_ = 0;
+            frontierMinimum_ = 0.0;
+        }
+
+    private:
+        /* @brief Squared distances from point to every reference point, into distances_. */
+        void rowDistances(const T* point)
+        {
+            using A = DistanceMetrics::AccumulatorType<T>;
+            sums_.assign(m_, A(0));
+            for (std::size_t k = 0; k < dimension_; ++k)
+            {
+                const A a = point[k];
+                const T* b = columns_.data() + k * m_;
+                for (std::size_t j = 0; j < m_; ++j) sums_[j] += (a - static_cast<A>(b[j])) * (a - static_cast<A>(b[j]));
+            }
+            for (std::size_t j = 0; j < m_; ++j) distances_[j] = static_cast<T>(sums_[j]);
+        }
+
+        std::size_t m_;
+        std::size_t dimension_;
+        std::size_t size_ = 0;
+        T frontierMinimum_ = 0.0;
+        std::vector<T> columns_;
+        std::vector<T> frontier_;
+        std::vector<T> distances_;
+        std::vector<DistanceMetrics::AccumulatorType<T>> sums_;
+    };
+};
+#endif
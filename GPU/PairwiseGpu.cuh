@@ -0,0 +1,353 @@
+/*  GPU pairwise distance engine
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __PAIRWISE_GPU_H__
+#define __PAIRWISE_GPU_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cuda_runtime.h>
+#include "../Common/PointDistance.hpp"
+#include "../Common/Trajectory.hpp"
+#include "../Common/Pairwise.hpp"
+
+/* Optional CUDA backend for the batched engines; include from a translation unit compiled with nvcc. */
+namespace DistanceMetrics
+{
+    namespace gpu
+    {
+        constexpr unsigned BlockSize = 256;     // Threads per block; one block evaluates one pair
+        constexpr unsigned TileSize = 256;      // Target points staged in shared memory at a time, at most
+
+        namespace detail
+        {
+            inline void check(cudaError_t status, const char* what)
+            {
+                if (status != cudaSuccess)
+                {
+                    throw std::runtime_error(std::string(what) + ": " + cudaGetErrorString(status));
+                }
+            }
+
+            /* @brief Owning device allocation of count elements. */
+            template <typename T>
+            class DeviceBuffer
+            {
+            public:
+                explicit DeviceBuffer(std::size_t count) : count_(count)
+                {
+                    check(cudaMalloc(reinterpret_cast<void**>(&data_), std::max<std::size_t>(1, count) * sizeof(T)), "cudaMalloc");
+                }
+                ~DeviceBuffer() { cudaFree(data_); }
+                DeviceBuffer(const DeviceBuffer&) = delete;
+                DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+
+                void upload(const T* host, std::size_t count)
+                {
+                    check(cudaMemcpy(data_, host, count * sizeof(T), cudaMemcpyHostToDevice), "cudaMemcpy to device");
+                }
+                void download(T* host, std::size_t count) const
+                {
+                    check(cudaMemcpy(host, data_, count * sizeof(T), cudaMemcpyDeviceToHost), "cudaMemcpy to host");
+                }
+                T* data() { return data_; }
+                const T* data() const { return data_; }
+
+            private:
+                T* data_ = nullptr;
+                std::size_t count_;
+            };
+
+            /* @brief Squared Euclidean distance between two points, summed in AccumulatorType<T> and rounded once. */
+            template <typename T>
+            __device__ T squaredDistance(const T* p, const T* q, std::size_t dimension)
+            {
+                using A = AccumulatorType<T>;
+                A sum = 0;
+                for (std::size_t k = 0; k < dimension; ++k)
+                {
+                    const A difference = static_cast<A>(p[k]) - static_cast<A>(q[k]);
+                    sum += difference * difference;
+                }
+                return static_cast<T>(sum);
+            }
+
+            /* @brief Maximum of value over the threads of a block, through BlockSize entries of shared memory. Every
+             *        thread of the block must call it, and every thread receives the result.
+            */
+            template <typename T>
+            __device__ T blockMax(T value, T* reduction)
+            {
+                __syncthreads();
+                reduction[threadIdx.x] = value;
+                __syncthreads();
+                for (unsigned half = blockDim.x / 2; half > 0; half /= 2)
+                {
+                    if (threadIdx.x < half) reduction[threadIdx.x] = max(reduction[threadIdx.x], reduction[threadIdx.x + half]);
+                    __syncthreads();
+                }
+                return reduction[0];
+            }
+
+            /* @brief Symmetric Hausdorff distance of pair blockIdx.x. Each thread takes query points in turn; the targets
+             *        are staged through shared memory tileSize points at a time, and the nearest-point distances are
+             *        combined by a shared-memory max reduction.
+            */
+            template <typename T>
+            __global__ void hausdorffKernel(const T* points, const std::size_t* offsets, std::size_t dimension, std::size_t tileSize,
+                                            const std::size_t* pairI, const std::size_t* pairJ, double* out)
+            {
+                extern __shared__ unsigned char sharedBytes[];
+                T* tile = reinterpret_cast<T*>(sharedBytes);    // tileSize * dimension target coordinates
+                __shared__ T reduction[BlockSize];
+                const T infinity = static_cast<T>(INFINITY);
+                T cMax = 0;
+                for (int direction = 0; direction < 2; ++direction)
+                {
+                    const std::size_t a = direction == 0 ? pairI[blockIdx.x] : pairJ[blockIdx.x];
+                    const std::size_t b = direction == 0 ? pairJ[blockIdx.x] : pairI[blockIdx.x];
+                    const T* queries = points + offsets[a] * dimension;
+                    const T* targets = points + offsets[b] * dimension;
+                    const std::size_t n = offsets[a + 1] - offsets[a], m = offsets[b + 1] - offsets[b];
+                    for (std::size_t base = 0; base < n; base += blockDim.x)
+                    {
+                        const std::size_t i = base + threadIdx.x;
+                        T best = infinity;
+                        for (std::size_t first = 0; first < m; first += tileSize)
+                        {
+                            const std::size_t count = (m - first < tileSize) ? m - first : tileSize;
+                            __syncthreads();
+                            for (std::size_t e = threadIdx.x; e < count * dimension; e += blockDim.x) tile[e] = targets[first * dimension + e];
+                            __syncthreads();
+                            if (i < n)
+                            {
+                                for (std::size_t t = 0; t < count; ++t) best = min(best, squaredDistance(queries + i * dimension, tile + t * dimension, dimension));
+                            }
+                        }
+                        if (i < n) cMax = max(cMax, best);
+                    }
+                }
+                cMax = blockMax(cMax, reduction);
+                if (threadIdx.x == 0) out[blockIdx.x] = sqrt(static_cast<double>(cMax));
+            }
+
+            /* @brief Discrete Frechet distance of pair blockIdx.x, sweeping the anti-diagonals of the dynamic programme
+             *        as a wavefront: the cells of one anti-diagonal are independent and are shared among the threads.
+             *        Three anti-diagonals, indexed by row, are kept in scratch. The cells hold squared distances and the
+             *        root is taken once, from the final cell.
+             *
+             * As on the CPU, the block first walks the 'almost diagonal' of Devogele et al. (2017) and reduces its
+             * maximum to a bound. A cell beyond the bound, or with no reachable predecessor, is unreachable and skips
+             * its distance; each anti-diagonal only spans the rows its predecessors reached.
+            */
+            template <typename T>
+            __global__ void frechetKernel(const T* points, const std::size_t* offsets, std::size_t dimension,
+                                          const std::size_t* pairI, const std::size_t* pairJ, T* scratch, std::size_t scratchStride, double* out)
+            {
+                __shared__ T reduction[BlockSize];
+                __shared__ int reachedLo, reachedHi;
+                const T infinity = static_cast<T>(INFINITY);
+                const std::size_t a = pairI[blockIdx.x], b = pairJ[blockIdx.x];
+                const T* rows = points + offsets[a] * dimension;
+                const T* columns = points + offsets[b] * dimension;
+                const int n = static_cast<int>(offsets[a + 1] - offsets[a]), m = static_cast<int>(offsets[b + 1] - offsets[b]);
+
+                const bool rowsAreLonger = n >= m;
+                const int longer = rowsAreLonger ? n : m, shorter = rowsAreLonger ? m : n;
+                const int q = longer / shorter, r = longer % shorter;
+                T bound = 0;
+                for (int t = threadIdx.x; t < longer; t += blockDim.x)
+                {
+                    const int c = (t <= r * (q + 1)) ? t / (q + 1) : (t - r) / q;
+                    const int i = rowsAreLonger ? t : c, j = rowsAreLonger ? c : t;
+                    bound = max(bound, squaredDistance(rows + i * dimension, columns + j * dimension, dimension));
+                }
+                bound = blockMax(bound, reduction);
+
+                T* twoBack = scratch + blockIdx.x * 3 * scratchStride;
+                T* oneBack = twoBack + scratchStride;
+                T* current = oneBack + scratchStride;
+                /* Rows of the reachable cells on the previous two anti-diagonals; only those entries are ever read */
+                int oneLo = 0, oneHi = -1, twoLo = 0, twoHi = -1;
+                for (int k = 0; k <= n + m - 2; ++k)
+                {
+                    int lo = max(0, k - (m - 1)), hi = min(n - 1, k);
+                    if (k > 0)
+                    {
+                        lo = max(lo, min(oneLo, twoLo + 1));
+                        hi = min(hi, max(oneHi, twoHi) + 1);
+                    }
+                    if (threadIdx.x == 0)
+                    {
+                        reachedLo = n;
+                        reachedHi = -1;
+                    }
+                    __syncthreads();
+                    for (int i = lo + threadIdx.x; i <= hi; i += blockDim.x)
+                    {
+                        const int j = k - i;
+                        T minimum = (k == 0) ? T(0) : infinity;
+                        if (i - 1 >= oneLo && i - 1 <= oneHi) minimum = min(minimum, oneBack[i - 1]);  // (i - 1, j)
+                        if (i >= oneLo && i <= oneHi) minimum = min(minimum, oneBack[i]);              // (i, j - 1)
+                        if (i - 1 >= twoLo && i - 1 <= twoHi) minimum = min(minimum, twoBack[i - 1]);  // (i - 1, j - 1)
+                        if (minimum == infinity)
+                        {
+                            current[i] = infinity;
+                            continue;
+                        }
+                        const T d = squaredDistance(rows + i * dimension, columns + j * dimension, dimension);
+                        if (d > bound)
+                        {
+                            current[i] = infinity;
+                            continue;
+                        }
+                        current[i] = max(minimum, d);
+                        atomicMin(&reachedLo, i);
+                        atomicMax(&reachedHi, i);
+                    }
+                    __syncthreads();
+                    twoLo = oneLo;
+                    twoHi = oneHi;
+                    oneLo = reachedLo;
+                    oneHi = reachedHi;
+                    T* recycled = twoBack;
+                    twoBack = oneBack;
+                    oneBack = current;
+                    current = recycled;
+                    __syncthreads();    // Every thread has read the reached rows before thread 0 resets them
+                }
+                if (threadIdx.x == 0) out[blockIdx.x] = (oneHi == n - 1) ? sqrt(static_cast<double>(oneBack[n - 1])) : static_cast<double>(INFINITY);
+            }
+
+            /* @brief Number of target points the Hausdorff kernel can stage at once: TileSize, unless the dimension is so
+             *        large that TileSize points would not fit in the shared memory of a block beside the reduction.
+            */
+            template <typename T>
+            std::size_t hausdorffTileSize(int device, std::size_t dimension)
+            {
+                int limit = 0;
+                check(cudaDeviceGetAttribute(&limit, cudaDevAttrMaxSharedMemoryPerBlock, device), "cudaDeviceGetAttribute");
+                const std::size_t available = static_cast<std::size_t>(limit) - BlockSize * sizeof(T);
+                const std::size_t tile = std::min<std::size_t>(TileSize, available / (std::max<std::size_t>(1, dimension) * sizeof(T)));
+                if (tile == 0)
+                {
+                    throw std::runtime_error("The trajectories passed to gpu::pairwiseDistances have too many dimensions for a block's shared memory.");
+                }
+                return tile;
+            }
+
+            /* @brief Largest number of pairs whose Frechet scratch, three anti-diagonals of longest cells each, and
+             *        per-pair buffers fit in half of the free device memory; the other half is left as headroom.
+            */
+            template <typename T>
+            std::size_t frechetPairsPerLaunch(std::size_t longest)
+            {
+                std::size_t freeBytes = 0, totalBytes = 0;
+                check(cudaMemGetInfo(&freeBytes, &totalBytes), "cudaMemGetInfo");
+                const std::size_t perPair = 3 * longest * sizeof(T) + 2 * sizeof(std::size_t) + sizeof(double);
+                const std::size_t pairs = (freeBytes / 2) / perPair;
+                if (pairs == 0)
+                {
+                    throw std::runtime_error("The trajectories passed to gpu::pairwiseDistances are too long for the Frechet scratch to fit in device memory.");
+                }
+                return pairs;
+            }
+        };
+
+        /* @brief Computes the symmetric Hausdorff or the Frechet distance for every pair of a batch on a CUDA device.
+         *
+         * The batch is uploaded once. Pairs are then launched in chunks, one block per pair: Hausdorff uses tiled
+         * shared-memory min/max reductions, with fewer points per tile for high dimensions, and Frechet a per-pair
+         * anti-diagonal wavefront pruned by the diagonal bound. Each Frechet pair needs scratch for three anti-diagonals of the longest trajectory,
+         * so its chunks are also capped by the free device memory.
+           @returns The condensed distance matrix, in the same layout as pairwiseDistances.
+           @param[in] batch The N trajectories in the flat layout.
+           @param[in] metric Which distance to compute.
+           @param[in] device CUDA device to run on.
+           @param[in] pairsPerLaunch Largest number of pairs evaluated per kernel launch.
+        */
+        template <typename T>
+        std::vector<double> pairwiseDistances(const TrajectoryBatch<T>& batch, Metric metric, int device = 0, std::size_t pairsPerLaunch = 1 << 16)
+        {
+            const std::size_t count = batch.size();
+            std::vector<double> condensed(condensedSize(count));
+            if (condensed.empty()) return condensed;
+            for (std::size_t t = 0; t < count; ++t)
+            {
+                if (batch.offsets()[t + 1] == batch.offsets()[t])
+                {
+                    throw std::runtime_error("One of the trajectories passed to gpu::pairwiseDistances is empty.");
+                }
+            }
+            detail::check(cudaSetDevice(device), "cudaSetDevice");
+
+            detail::DeviceBuffer<T> points(batch.points() * batch.dimension());
+            points.upload(batch.data(), batch.points() * batch.dimension());
+            detail::DeviceBuffer<std::size_t> offsets(count + 1);
+            offsets.upload(batch.offsets().data(), count + 1);
+
+            std::size_t longest = 0;
+            for (std::size_t t = 0; t < count; ++t) longest = std::max(longest, batch.offsets()[t + 1] - batch.offsets()[t]);
+            if (metric == Metric::Frechet) pairsPerLaunch = std::min(pairsPerLaunch, detail::frechetPairsPerLaunch<T>(longest));
+            pairsPerLaunch = std::max<std::size_t>(1, std::min(pairsPerLaunch, condensed.size()));
+            const std::size_t tileSize = (metric == Metric::Hausdorff) ? detail::hausdorffTileSize<T>(device, batch.dimension()) : 0;
+            detail::DeviceBuffer<std::size_t> pairI(pairsPerLaunch), pairJ(pairsPerLaunch);
+            detail::DeviceBuffer<double> results(pairsPerLaunch);
+            std::unique_ptr<detail::DeviceBuffer<T>> scratch;
+            if (metric == Metric::Frechet) scratch.reset(new detail::DeviceBuffer<T>(pairsPerLaunch * 3 * longest));
+
+            std::vector<std::size_t> hostI(pairsPerLaunch), hostJ(pairsPerLaunch);
+            std::size_t i = 0, j = 1;
+            for (std::size_t first = 0; first < condensed.size(); first += pairsPerLaunch)
+            {
+                /* Pairs are enumerated in condensed order, so each chunk lands in one contiguous run of the output */
+                const std::size_t chunk = std::min(pairsPerLaunch, condensed.size() - first);
+                for (std::size_t p = 0; p < chunk; ++p)
+                {
+                    hostI[p] = i;
+                    hostJ[p] = j;
+                    if (++j == count)
+                    {
+                        ++i;
+                        j = i + 1;
+                    }
+                }
+                pairI.upload(hostI.data(), chunk);
+                pairJ.upload(hostJ.data(), chunk);
+                if (metric == Metric::Hausdorff)
+                {
+                    const std::size_t shared = tileSize * batch.dimension() * sizeof(T);
+                    detail::hausdorffKernel<T><<<static_cast<unsigned>(chunk), BlockSize, shared>>>(points.data(), offsets.data(), batch.dimension(), tileSize,
+                                                                                                  pairI.data(), pairJ.data(), results.data());
+                }
+                else
+                {
+                    detail::frechetKernel<T><<<static_cast<unsigned>(chunk), BlockSize>>>(points.data(), offsets.data(), batch.dimension(),
+                                                                                         pairI.data(), pairJ.data(), scratch->data(), longest, results.data());
+                }
+                detail::check(cudaGetLastError(), "kernel launch");
+                results.download(condensed.data() + first, chunk);
+            }
+            return condensed;
+        }
+    };
+};
+#endif
@@ -2,83 +2,1100 @@
 #define __HAUSDORFF_H__
 
 #include <algorithm>
+#include <cmath>
 #include <random>
 #include <vector>
 #include <stdexcept>
 #include <limits>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "../Common/Trajectory.hpp"
+#include "../Common/PointDistance.hpp"
+#include "../Common/SimdKernels.hpp"
+#include "../Common/Stats.hpp"
+#include "../Common/Metric.hpp"
 
-/* @brief Computes the Hausdorff distance between two vectors a and b which represent trajectories of strainlines.
-   @param[inout] a Vector of vector of points
-   @param[inout] b Vector of vector of points
-   @returns The Hausdorff distance between a and b
-*/
-template <typename T>
-double hausdorffDistance(const std::vector<std::vector<T>>& a1, const std::vector<std::vector<T>>& b1)
+namespace Hausdorff
 {
-    std::vector<std::vector<T>> a = a1, b = b1;
-    /* Error checks */
-    if (a.empty() || b.empty()) /* Check neither a nor be is empty */
+    namespace detail
     {
-        throw std::runtime_error("One of the vectors passed to hausdorffDistance is empty.");
-    }
+        /* @brief Draws a seed for a new permutation generator. The random_device is read once per thread rather than
+         *        once per call, as it is a system call on Linux and dominates the runtime for short trajectories.
+        */
+        inline std::default_random_engine::result_type nextSeed()
+        {
+            thread_local std::default_random_engine seeder { std::random_device {}() };
+            return seeder();
+        }
 
-    /* Create a random iterator */
-    auto seedGenerator = std::random_device {};
-    auto rngGenerator = std::default_random_engine { seedGenerator() };
-    
-    /* Create an array of indices to be shuffled later. Accesing the indices randomly can lead to an earlier
-     * break in the distance computation than computing all of the points linearly.
+        /* @brief Checks that permutation is a permutation of 0, ..., size - 1. */
+        inline void checkPermutation(const std::vector<int>& permutation, std::size_t size)
+        {
+            std::vector<bool> seen(size, false);
+            if (permutation.size() != size)
+            {
+                throw std::runtime_error("The permutation passed to hausdorffDistance does not match the trajectory length.");
+            }
+            for (int index : permutation)
+            {
+                if (index < 0 || static_cast<std::size_t>(index) >= size || seen[index])
+                {
+                    throw std::runtime_error("The indices passed to hausdorffDistance are not a permutation.");
+                }
+                seen[index] = true;
+            }
+        }
+    };
+
+    /* @brief Caller-owned scratch storage for hausdorffDistance: the index permutations and the packed target sets.
+     *
+     * A directed distance reads its query points straight from the caller's set, in the order of indicesA, and only
+     * copies the target set into packedB: the kernels stream the targets once per query, so they need them
+     * contiguous in structure-of-arrays order. A symmetric distance uses each set as the targets of one direction and
+     * so packs both. Buffers only ever grow, so reusing one Workspace per thread across many calls leaves the
+     * allocator untouched once the largest pair has been seen. To avoid the copy itself when a trajectory takes part
+     * in many pairs, pack it once into a PreparedTrajectory.
+     *
+     * The workspace also owns the generator used to shuffle the indices; constructing it with a fixed seed makes a
+     * sequence of calls reproducible.
      */
-    std::vector<int> indicesA( a.size() );
-    std::vector<int> indicesB( b.size() );
+    template <typename T>
+    struct Workspace
+    {
+        Workspace() : rngGenerator(detail::nextSeed()) {}
+        explicit Workspace(std::uint64_t seed) : rngGenerator(static_cast<std::default_random_engine::result_type>(seed)) {}
 
-    /* Assign values of indices to the vectors created above */
-    for (int i = 0; i < indicesA.size(); ++i)
+        std::default_random_engine rngGenerator;
+        std::vector<int> indicesA, indicesB;
+        std::vector<T> packedA, packedB, query;
+        std::vector<T> scale;  // sqrt of the weights of a WeightedEuclidean query
+        std::vector<T> lowerA, upperA, lowerB, upperB;
+    };
+
+    namespace detail
     {
-        indicesA[i] = i;
-    }
-    for (int i = 0; i < indicesB.size(); ++i)
+        /* @brief The workspace of the overloads that take none, one per thread and type, so that their buffers are
+         *        reused from call to call rather than allocated afresh.
+        */
+        template <typename T>
+        Workspace<T>& threadWorkspace()
+        {
+            thread_local Workspace<T> workspace;
+            return workspace;
+        }
+    };
+
+    /* @brief A directed Hausdorff distance together with the pair of points that attains it, as returned by
+     *        scipy.spatial.distance.directed_hausdorff.
+     */
+    struct Witness
     {
-        indicesB[i] = i;
-    } /* A and B may not necessarily be of the same length (different number of points in the trajectory), but _will_ have the same dimensionality */
+        double distance;
+        std::size_t indexA;     // Point of a furthest from b
+        std::size_t indexB;     // Point of b nearest to it
+    };
 
-    /* Shuffle the indices arrays */
-    std::shuffle(std::begin(indicesA), std::end(indicesA), rngGenerator);
-    std::shuffle(std::begin(indicesB), std::end(indicesB), rngGenerator);
+    namespace detail
+    {
+        /* @brief Checks that two point sets can be compared. */
+        template <typename PointSetA, typename PointSetB>
+        void checkInputs(const PointSetA& a, const PointSetB& b)
+        {
+            /* Error checks */
+            if (a.empty() || b.empty()) /* Check neither a nor be is empty */
+            {
+                throw std::runtime_error("One of the vectors passed to hausdorffDistance is empty.");
+            }
+            if (a.dimension() != b.dimension())
+            {
+                throw std::runtime_error("The trajectories passed to hausdorffDistance have different dimensions.");
+            }
+        }
 
-    /* Initialise loop variables */
-    T cMin, cMax, d;               // Minimum distance, maximum distance, current distance
-    bool haveWeBroken = false;          // Have we had a break in the inner loop
+        /* @brief Fills indices with 0, ..., size - 1 in a random order. Accesing the indices randomly can lead to an earlier
+         *        break in the distance computation than computing all of the points linearly.
+        */
+        template <typename Generator>
+        void shuffledIndices(std::size_t size, std::vector<int>& indices, Generator& rngGenerator)
+        {
+            indices.resize(size);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                indices[i] = static_cast<int>(i);
+            }
+            std::shuffle(std::begin(indices), std::end(indices), rngGenerator);
+        }
 
-    cMin = 0.0;
-    cMax = 0.0;
+        /* @brief Copies a point set into structure-of-arrays order following indices, so that the inner loop streams
+         *        contiguous memory and can be evaluated one vector register of points at a time.
+           @param[in] set Point set to pack
+           @param[in] indices Order in which to store the points
+           @param[out] packed Coordinate k of the t-th point visited is stored at packed[k * set.size() + t]
+        */
+        template <typename T, typename PointSet>
+        void pack(const PointSet& set, const std::vector<int>& indices, std::vector<T>& packed)
+        {
+            const std::size_t size = set.size(), dimension = set.dimension();
+            packed.resize(size * dimension);
+            for (std::size_t t = 0; t < size; ++t)
+            {
+                for (std::size_t k = 0; k < dimension; ++k) packed[k * size + t] = set(indices[t], k);
+            }
+        }
 
-    for (int indexA : indicesA)
-    {
-        haveWeBroken = false;
-        cMin = std::numeric_limits<T>::infinity();  // Set to "infinity" to force update on first loop
+        /* @brief As pack, with coordinate k multiplied by sqrt(weights[k]); the weighted Euclidean distance between the
+         *        originals is then the plain Euclidean distance between the packed points.
+        */
+        template <typename T, typename PointSet>
+        void packWeighted(const PointSet& set, const std::vector<int>& indices, const std::vector<T>& weights, std::vector<T>& packed)
+        {
+            const std::size_t size = set.size(), dimension = set.dimension();
+            packed.resize(size * dimension);
+            for (std::size_t k = 0; k < dimension; ++k)
+            {
+                const T factor = std::sqrt(weights[k]);
+                for (std::size_t t = 0; t < size; ++t) packed[k * size + t] = set(indices[t], k) * factor;
+            }
+        }
 
-        for (int indexB : indicesB)
+        /* @brief Computes the axis-aligned bounding box of a point set.
+           @param[in] set Point set exposing size(), dimension() and operator()(i, k)
+           @param[out] lower Smallest value of each coordinate
+           @param[out] upper Largest value of each coordinate
+        */
+        template <typename T, typename PointSet>
+        void boundingBox(const PointSet& set, std::vector<T>& lower, std::vector<T>& upper)
         {
-            d = 0.0; // Reset distance
-            /* Get Euclidean distance - keep as squared for now & square at the end to save computation time */
-            for (size_t idx = 0; idx < a[indexA].size(); ++idx) d += (a[indexA][idx] - b[indexB][idx]) * (a[indexA][idx] - b[indexB][idx]); // Prevent use of std::pow()
-            if (d < cMax) // We have an early termination
+            lower.assign(set.dimension(), std::numeric_limits<T>::infinity());
+            upper.assign(set.dimension(), -std::numeric_limits<T>::infinity());
+            for (std::size_t i = 0; i < set.size(); ++i)
             {
-                haveWeBroken = true;
-                break; // Out of inner loop
+                for (std::size_t k = 0; k < set.dimension(); ++k)
+                {
+                    lower[k] = std::min(lower[k], static_cast<T>(set(i, k)));
+                    upper[k] = std::max(upper[k], static_cast<T>(set(i, k)));
+                }
             }
-            /* If we didn't break, set the minimum distance if we've achieved it */
-            if (d < cMin) 
+        }
+
+        /* @brief Lower bound on the squared directed Hausdorff distance from a to b, from their bounding boxes alone.
+         *
+         * Every point of a lies in its box, so h(a, b) is at least the gap between the boxes. Along each axis k, a also
+         * has a point on each face of its box, so h(a, b) is at least the distance by which a's box sticks out of b's.
+           @returns The squared lower bound
+        */
+        template <typename T>
+        T boxLowerBound(const T* lowerA, const T* upperA, const T* lowerB, const T* upperB, std::size_t dimension)
+        {
+            T gap = 0.0, excess = 0.0;
+            for (std::size_t k = 0; k < dimension; ++k)
+            {
+                const T separation = std::max({ lowerB[k] - upperA[k], lowerA[k] - upperB[k], T(0) });
+                const T overhang = std::max({ lowerB[k] - lowerA[k], upperA[k] - upperB[k], T(0) });
+                gap += separation * separation;
+                excess = std::max(excess, overhang * overhang);
+            }
+            return std::max(gap, excess);
+        }
+
+        /* @brief The largest squared distance in T whose root, taken in double as the results are, is at most cutoff.
+         *        A scan abandoned beyond it therefore returns a value greater than cutoff. A negative cutoff is
+         *        exceeded by everything.
+        */
+        template <typename T>
+        T squaredCutoff(double cutoff)
+        {
+            if (cutoff < 0) return T(-1);
+            return DistanceMetrics::metrics::detail::exactThreshold(static_cast<T>(cutoff * cutoff), cutoff,
+                                                                    [](T value) { return std::sqrt(static_cast<double>(value)); });
+        }
+
+        /* @brief Number of targets a scan that broke early had to evaluate, up to and including the first one closer
+         *        than threshold. Only used to fill in the stats, which are compiled out by default.
+        */
+        template <typename T, std::size_t D>
+        std::size_t scannedBeforeBreak(const T* query, std::size_t dimension, const T* targets, std::size_t count, T threshold)
+        {
+            using A = DistanceMetrics::AccumulatorType<T>;
+            const std::size_t dims = (D == DistanceMetrics::DynamicDimension) ? dimension : D;
+            for (std::size_t j = 0; j < count; ++j)
+            {
+                A d = 0.0;
+                for (std::size_t k = 0; k < dims; ++k) d += DistanceMetrics::detail::squaredDifference<A>(targets[k * count + j], query[k]);
+                if (d < static_cast<A>(threshold)) return j + 1;
+            }
+            return count;
+        }
+
+        /* @brief Copies the t-th point of a packed set into query. */
+        template <typename T>
+        inline void loadPacked(const T* packed, std::size_t count, std::size_t t, std::size_t dimension, T* query)
+        {
+            for (std::size_t k = 0; k < dimension; ++k) query[k] = packed[k * count + t];
+        }
+
+        /* @brief Copies point i of a point set into query, with coordinate k multiplied by scale[k] unless scale is null. */
+        template <typename T, typename PointSet>
+        inline void loadPoint(const PointSet& set, std::size_t i, const T* scale, T* query)
+        {
+            for (std::size_t k = 0; k < set.dimension(); ++k) query[k] = scale ? static_cast<T>(set(i, k)) * scale[k] : static_cast<T>(set(i, k));
+        }
+
+        /* @brief Raises cMax to the squared distance from one query point to its nearest target, unless a target closer
+         *        than cMax is found first, in which case this point cannot raise the maximum and the scan stops early.
+           @param[in] query Coordinates of the query point
+           @param[in] targets Packed target set
+           @param[in] targetCount Number of points in the packed target set
+           @param[in] dimension Number of coordinates per point
+           @param[inout] cMax Running maximum of the squared nearest-point distances
+        */
+        template <typename T, std::size_t D>
+        inline void visitQuery(const T* query, const T* targets, std::size_t targetCount, std::size_t dimension, T& cMax)
+        {
+            bool haveWeBroken = false;          // Have we had a break in the inner loop
+            T cMin = DistanceMetrics::simd::minSquaredDistance<T, D>(query, dimension, targets, targetCount, targetCount, cMax, haveWeBroken);
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats())
             {
-                cMin = d;
+                ++stats->outerIterations;
+                stats->earlyBreaks += haveWeBroken;
+                stats->distanceEvaluations += haveWeBroken ? scannedBeforeBreak<T, D>(query, dimension, targets, targetCount, cMax) : targetCount;
             }
+            if ( std::isfinite(cMin) && cMin >= cMax && !haveWeBroken ) // We _didn't_ break out of the loop early
+            {
+                cMax = cMin;
+            }
+        }
+
+        /* @brief Directed pass over two packed sets.
+           @returns The squared directed Hausdorff distance, or cMax if that is larger
+           @param[in] packedA Packed query set of n points
+           @param[in] packedB Packed target set of m points
+           @param[inout] query Scratch buffer of dimension elements
+           @param[in] cMax Initial early-termination threshold (squared); 0 for a plain directed distance
+           @param[in] cutoff Squared cutoff; the scan stops as soon as cMax exceeds it
+        */
+        template <typename T, std::size_t D>
+        T directedPacked(const T* packedA, std::size_t n, const T* packedB, std::size_t m, std::size_t dimension, T* query, T cMax = 0.0,
+                         T cutoff = std::numeric_limits<T>::infinity())
+        {
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->possibleEvaluations += static_cast<std::uint64_t>(n) * m;
+            for (std::size_t t = 0; t < n && cMax <= cutoff; ++t)
+            {
+                loadPacked(packedA, n, t, dimension, query);
+                visitQuery<T, D>(query, packedB, m, dimension, cMax);
+            }
+            return cMax;
+        }
+
+        /* @brief Directed pass from a point set, visited in the order of indices, to a packed target set. The queries
+         *        are read from a as they are visited, each once, so only the targets are copied.
+           @returns The squared directed Hausdorff distance, or cMax if that is larger
+           @param[in] a Query set
+           @param[in] indices Order in which the points of a are visited
+           @param[in] scale Factor applied to each coordinate of a, or nullptr
+           @param[in] packedB Packed target set of m points
+           @param[inout] query Scratch buffer of a.dimension() elements
+           @param[in] cMax Initial early-termination threshold (squared); 0 for a plain directed distance
+           @param[in] cutoff Squared cutoff; the scan stops as soon as cMax exceeds it
+        */
+        template <typename T, std::size_t D, typename PointSet>
+        T directedFromSet(const PointSet& a, const std::vector<int>& indices, const T* scale, const T* packedB, std::size_t m, T* query, T cMax = 0.0,
+                          T cutoff = std::numeric_limits<T>::infinity())
+        {
+            const std::size_t n = a.size();
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->possibleEvaluations += static_cast<std::uint64_t>(n) * m;
+            for (std::size_t t = 0; t < n && cMax <= cutoff; ++t)
+            {
+                loadPoint(a, indices[t], scale, query);
+                visitQuery<T, D>(query, packedB, m, a.dimension(), cMax);
+            }
+            return cMax;
         }
-        if ( isfinite(cMin) && cMin >= cMax && !haveWeBroken ) // We _didn't_ break out of the loop early
+
+        /* @brief Symmetric pass over two packed sets, max(h(a, b), h(b, a)), interleaving both directions.
+         *
+         * Both directions share one running maximum, so a large nearest-point distance found in either direction
+         * immediately tightens the early-termination threshold of the other.
+           @returns The squared symmetric Hausdorff distance, or a value above cutoff once it is known to exceed it
+        */
+        template <typename T, std::size_t D>
+        T symmetricPacked(const T* packedA, std::size_t n, const T* packedB, std::size_t m, std::size_t dimension, T* query,
+                          T cutoff = std::numeric_limits<T>::infinity())
         {
-            cMax = cMin;
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->possibleEvaluations += 2 * static_cast<std::uint64_t>(n) * m;
+            T cMax = 0.0;
+            for (std::size_t t = 0; t < std::max(n, m) && cMax <= cutoff; ++t)
+            {
+                if (t < n)
+                {
+                    loadPacked(packedA, n, t, dimension, query);
+                    visitQuery<T, D>(query, packedB, m, dimension, cMax);
+                }
+                if (t < m)
+                {
+                    loadPacked(packedB, m, t, dimension, query);
+                    visitQuery<T, D>(query, packedA, n, dimension, cMax);
+                }
+            }
+            return cMax;
         }
-    }
-    return std::sqrt(cMax);
+
+        /* @brief Shuffles (if required) the visiting order of both point sets and packs the target set b into the
+         *        workspace, scaling coordinate k by sqrt((*weights)[k]) when weights are given. The query set a is
+         *        left in place; workspace.scale receives the factors to apply to it as it is read.
+        */
+        template <typename T, typename PointSetA, typename PointSetB>
+        void prepareTargets(const PointSetA& a, const PointSetB& b, Workspace<T>& workspace, bool shuffle, const std::vector<T>* weights = nullptr)
+        {
+            checkInputs(a, b);
+            /* A and B may not necessarily be of the same length (different number of points in the trajectory), but _will_ have the same dimensionality */
+            if (shuffle)
+            {
+                shuffledIndices(a.size(), workspace.indicesA, workspace.rngGenerator);
+                shuffledIndices(b.size(), workspace.indicesB, workspace.rngGenerator);
+            }
+            if (weights)
+            {
+                packWeighted(b, workspace.indicesB, *weights, workspace.packedB);
+                workspace.scale.resize(a.dimension());
+                for (std::size_t k = 0; k < a.dimension(); ++k) workspace.scale[k] = std::sqrt((*weights)[k]);
+            }
+            else
+            {
+                pack(b, workspace.indicesB, workspace.packedB);
+            }
+            workspace.query.resize(a.dimension());
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->recordBytes(workspace.packedB.size() * sizeof(T));
+        }
+
+        /* @brief As prepareTargets, and packs a as well, for the symmetric passes that use each set as the targets of
+         *        one direction.
+        */
+        template <typename T, typename PointSetA, typename PointSetB>
+        void prepare(const PointSetA& a, const PointSetB& b, Workspace<T>& workspace, bool shuffle, const std::vector<T>* weights = nullptr)
+        {
+            prepareTargets(a, b, workspace, shuffle, weights);
+            if (weights) packWeighted(a, workspace.indicesA, *weights, workspace.packedA);
+            else pack(a, workspace.indicesA, workspace.packedA);
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats())
+            {
+                stats->recordBytes((workspace.packedA.size() + workspace.packedB.size()) * sizeof(T));
+            }
+        }
+
+        /* @brief Directed Hausdorff distance between two point sets exposing size(), dimension() and operator()(i, k).
+         *        D is the compile-time dimension, or DistanceMetrics::DynamicDimension.
+           @param[in] a First point set
+           @param[in] b Second point set
+           @param[inout] workspace Scratch storage, grown as required
+           @param[in] shuffle Whether to draw new permutations, or use those already in the workspace
+           @returns The directed Hausdorff distance from a to b
+        */
+        template <typename T, std::size_t D, typename PointSetA, typename PointSetB>
+        double directedDistance(const PointSetA& a, const PointSetB& b, Workspace<T>& workspace, bool shuffle = true)
+        {
+            prepareTargets(a, b, workspace, shuffle);
+            return std::sqrt(static_cast<double>(directedFromSet<T, D>(a, workspace.indicesA, static_cast<const T*>(nullptr), workspace.packedB.data(), b.size(), workspace.query.data())));
+        }
+
+        /* @brief Directed Hausdorff distance from a to b together with the pair of points attaining it.
+         *
+         * The scan is the same as directedDistance's; the query that last raised the maximum is remembered, and its
+         * nearest target is found afterwards with one more pass over b. With shuffled queries the maximum is raised
+         * O(log n) times in expectation, so the indices cost a single extra O(m) scan.
+        */
+        template <typename T, std::size_t D, typename PointSetA, typename PointSetB>
+        Witness directedWitness(const PointSetA& a, const PointSetB& b, Workspace<T>& workspace)
+        {
+            prepareTargets(a, b, workspace, true);
+            const std::size_t n = a.size(), m = b.size(), dimension = a.dimension();
+            const T* packedB = workspace.packedB.data();
+            T* query = workspace.query.data();
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->possibleEvaluations += static_cast<std::uint64_t>(n) * m;
+            T cMax = 0.0;
+            std::size_t furthest = 0;
+            for (std::size_t t = 0; t < n; ++t)
+            {
+                const T previous = cMax;
+                loadPoint(a, workspace.indicesA[t], static_cast<const T*>(nullptr), query);
+                visitQuery<T, D>(query, packedB, m, dimension, cMax);
+                if (cMax > previous) furthest = t;
+            }
+            loadPoint(a, workspace.indicesA[furthest], static_cast<const T*>(nullptr), query);
+            using A = DistanceMetrics::AccumulatorType<T>;
+            std::size_t nearest = 0;
+            A nearestDistance = std::numeric_limits<A>::infinity();
+            for (std::size_t j = 0; j < m; ++j)
+            {
+                A d = 0.0;
+                for (std::size_t k = 0; k < dimension; ++k) d += DistanceMetrics::detail::squaredDifference<A>(packedB[k * m + j], query[k]);
+                if (d < nearestDistance)
+                {
+                    nearestDistance = d;
+                    nearest = j;
+                }
+            }
+            return Witness { std::sqrt(static_cast<double>(cMax)), static_cast<std::size_t>(workspace.indicesA[furthest]),
+                             static_cast<std::size_t>(workspace.indicesB[nearest]) };
+        }
+
+        /* @brief Symmetric Hausdorff distance, max(h(a, b), h(b, a)), evaluated in a single interleaved pass.
+           @param[in] a First point set
+           @param[in] b Second point set
+           @param[inout] workspace Scratch storage, grown as required
+           @param[in] shuffle Whether to draw new permutations, or use those already in the workspace
+           @returns The symmetric Hausdorff distance between a and b
+        */
+        template <typename T, std::size_t D, typename PointSetA, typename PointSetB>
+        double symmetricDistance(const PointSetA& a, const PointSetB& b, Workspace<T>& workspace, bool shuffle = true)
+        {
+            /* Each packed set serves as the queries of one direction and the targets of the other */
+            prepare(a, b, workspace, shuffle);
+            return std::sqrt(static_cast<double>(symmetricPacked<T, D>(workspace.packedA.data(), a.size(), workspace.packedB.data(), b.size(), a.dimension(), workspace.query.data())));
+        }
+
+        /* @brief Directed Hausdorff distance from a to b, abandoned as soon as it is known to exceed cutoff. The bounding
+         *        boxes are compared before either set is shuffled or packed.
+           @returns The directed Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that exceeds cutoff
+        */
+        template <typename T, std::size_t D, typename PointSetA, typename PointSetB>
+        double directedDistance(const PointSetA& a, const PointSetB& b, double cutoff, Workspace<T>& workspace)
+        {
+            checkInputs(a, b);
+            boundingBox(a, workspace.lowerA, workspace.upperA);
+            boundingBox(b, workspace.lowerB, workspace.upperB);
+            const T bound = boxLowerBound(workspace.lowerA.data(), workspace.upperA.data(), workspace.lowerB.data(), workspace.upperB.data(), a.dimension());
+            const T cutoffSquared = squaredCutoff<T>(cutoff);
+            if (bound > cutoffSquared) return std::sqrt(static_cast<double>(bound));
+            prepareTargets(a, b, workspace, true);
+            return std::sqrt(static_cast<double>(directedFromSet<T, D>(a, workspace.indicesA, static_cast<const T*>(nullptr), workspace.packedB.data(), b.size(),
+                                                                       workspace.query.data(), T(0), cutoffSquared)));
+        }
+
+        /* @brief Symmetric Hausdorff distance between a and b, abandoned as soon as it is known to exceed cutoff.
+           @returns The symmetric Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that exceeds cutoff
+        */
+        template <typename T, std::size_t D, typename PointSetA, typename PointSetB>
+        double symmetricDistance(const PointSetA& a, const PointSetB& b, double cutoff, Workspace<T>& workspace)
+        {
+            checkInputs(a, b);
+            boundingBox(a, workspace.lowerA, workspace.upperA);
+            boundingBox(b, workspace.lowerB, workspace.upperB);
+            const T bound = std::max(boxLowerBound(workspace.lowerA.data(), workspace.upperA.data(), workspace.lowerB.data(), workspace.upperB.data(), a.dimension()),
+                                     boxLowerBound(workspace.lowerB.data(), workspace.upperB.data(), workspace.lowerA.data(), workspace.upperA.data(), a.dimension()));
+            const T cutoffSquared = squaredCutoff<T>(cutoff);
+            if (bound > cutoffSquared) return std::sqrt(static_cast<double>(bound));
+            prepare(a, b, workspace, true);
+            return std::sqrt(static_cast<double>(symmetricPacked<T, D>(workspace.packedA.data(), a.size(), workspace.packedB.data(), b.size(), a.dimension(),
+                                                                       workspace.query.data(), cutoffSquared)));
+        }
+
+        /* @brief A packed set seen as a point set, for the metric policies that go through measure(). */
+        template <typename T>
+        struct PackedPoints
+        {
+            const T* data;
+            std::size_t count;
+            std::size_t dims;
+
+            std::size_t size() const { return count; }
+            std::size_t dimension() const { return dims; }
+            const T& operator()(std::size_t i, std::size_t k) const { return data[k * count + i]; }
+        };
+
+        /* @brief As visitQuery, for any metric policy and point i of any query set: the comparable values to the
+         *        targets are evaluated a block at a time, so that the loop over a block can vectorise, and the scan stops
+         *        after the first block that holds a target closer than cMax.
+        */
+        template <typename T, std::size_t D, typename PointSet, typename Policy>
+        void visitQueryWith(const PointSet& queries, std::size_t t, const PackedPoints<T>& targets, const Policy& metric, T& cMax)
+        {
+            constexpr std::size_t Block = 16;
+            T values[Block];
+            T cMin = std::numeric_limits<T>::infinity();
+            std::size_t scanned = 0;
+            bool haveWeBroken = false;
+            while (scanned < targets.size() && !haveWeBroken)
+            {
+                const std::size_t count = std::min(Block, targets.size() - scanned);
+                for (std::size_t j = 0; j < count; ++j) values[j] = metric.template measure<D>(queries, t, targets, scanned + j);
+                for (std::size_t j = 0; j < count; ++j) cMin = std::min(cMin, values[j]);
+                scanned += count;
+                haveWeBroken = cMin < cMax;
+            }
+            if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats())
+            {
+                ++stats->outerIterations;
+                stats->earlyBreaks += haveWeBroken;
+                stats->distanceEvaluations += scanned;
+            }
+            if ( std::isfinite(cMin) && cMin >= cMax && !haveWeBroken ) cMax = cMin;
+        }
+
+        /* @brief Directed Hausdorff distance from a to b under a metric policy, as directedDistance.
+           @returns The directed Hausdorff distance from a to b under metric
+        */
+        template <typename T, std::size_t D, typename PointSetA, typename PointSetB, typename Policy>
+        double directedMetricDistance(const PointSetA& a, const PointSetB& b, const Policy& metric, Workspace<T>& workspace)
+        {
+            if constexpr (std::is_same<Policy, DistanceMetrics::metrics::Euclidean<T>>::value)
+            {
+                return directedDistance<T, D>(a, b, workspace);
+            }
+            else if constexpr (std::is_same<Policy, DistanceMetrics::metrics::SquaredEuclidean<T>>::value)
+            {
+                prepareTargets(a, b, workspace, true);
+                return static_cast<double>(directedFromSet<T, D>(a, workspace.indicesA, static_cast<const T*>(nullptr), workspace.packedB.data(), b.size(), workspace.query.data()));
+            }
+            else if constexpr (std::is_same<Policy, DistanceMetrics::metrics::WeightedEuclidean<T>>::value)
+            {
+                /* With sqrt(w) applied to both sets, the weighted distance is the Euclidean one and the SIMD kernels apply */
+                prepareTargets(a, b, workspace, true, &metric.weights);
+                return std::sqrt(static_cast<double>(directedFromSet<T, D>(a, workspace.indicesA, workspace.scale.data(), workspace.packedB.data(), b.size(), workspace.query.data())));
+            }
+            else
+            {
+                prepareTargets(a, b, workspace, true);
+                const PackedPoints<T> packedB { workspace.packedB.data(), b.size(), b.dimension() };
+                if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->possibleEvaluations += static_cast<std::uint64_t>(a.size()) * b.size();
+                T cMax = 0.0;
+                for (std::size_t t = 0; t < a.size(); ++t) visitQueryWith<T, D>(a, workspace.indicesA[t], packedB, metric, cMax);
+                return static_cast<double>(metric.finish(cMax));
+            }
+        }
+
+        /* @brief Symmetric Hausdorff distance between a and b under a metric policy, as symmetricDistance.
+           @returns The symmetric Hausdorff distance between a and b under metric
+        */
+        template <typename T, std::size_t D, typename PointSetA, typename PointSetB, typename Policy>
+        double symmetricMetricDistance(const PointSetA& a, const PointSetB& b, const Policy& metric, Workspace<T>& workspace)
+        {
+            if constexpr (std::is_same<Policy, DistanceMetrics::metrics::Euclidean<T>>::value)
+            {
+                return symmetricDistance<T, D>(a, b, workspace);
+            }
+            else if constexpr (std::is_same<Policy, DistanceMetrics::metrics::SquaredEuclidean<T>>::value)
+            {
+                prepare(a, b, workspace, true);
+                return static_cast<double>(symmetricPacked<T, D>(workspace.packedA.data(), a.size(), workspace.packedB.data(), b.size(), a.dimension(), workspace.query.data()));
+            }
+            else if constexpr (std::is_same<Policy, DistanceMetrics::metrics::WeightedEuclidean<T>>::value)
+            {
+                prepare(a, b, workspace, true, &metric.weights);
+                return std::sqrt(static_cast<double>(symmetricPacked<T, D>(workspace.packedA.data(), a.size(), workspace.packedB.data(), b.size(), a.dimension(), workspace.query.data())));
+            }
+            else
+            {
+                prepare(a, b, workspace, true);
+                const PackedPoints<T> packedA { workspace.packedA.data(), a.size(), a.dimension() }, packedB { workspace.packedB.data(), b.size(), b.dimension() };
+                if (DistanceMetrics::Stats* stats = DistanceMetrics::activeStats()) stats->possibleEvaluations += 2 * static_cast<std::uint64_t>(a.size()) * b.size();
+                T cMax = 0.0;
+                for (std::size_t t = 0; t < std::max(a.size(), b.size()); ++t)
+                {
+                    if (t < a.size()) visitQueryWith<T, D>(packedA, t, packedB, metric, cMax);
+                    if (t < b.size()) visitQueryWith<T, D>(packedB, t, packedA, metric, cMax);
+                }
+                return static_cast<double>(metric.finish(cMax));
+            }
+        }
+
+        /* @brief Calls f with a query scratch buffer: on the stack for compile-time dimensions, on the heap otherwise. */
+        template <typename T, std::size_t D, typename Function>
+        decltype(auto) withQueryBuffer(std::size_t dimension, Function&& f)
+        {
+            if constexpr (D != DistanceMetrics::DynamicDimension)
+            {
+                std::array<T, D> query;
+                return f(query.data());
+            }
+            else
+            {
+                std::vector<T> query(dimension);
+                return f(query.data());
+            }
+        }
+    };
+
+    /* @brief A trajectory packed and shuffled once, so that the random set-up of hausdorffDistance is paid once per
+     *        trajectory instead of once per pair. The permutation is drawn from a seed, which makes results reproducible.
+     */
+    template <typename T>
+    class PreparedTrajectory
+    {
+    public:
+        /* @brief Prepares any point set exposing size(), dimension() and operator()(i, k) with a fresh random permutation. */
+        template <typename PointSet>
+        explicit PreparedTrajectory(const PointSet& set) : PreparedTrajectory(set, detail::nextSeed()) {}
+
+        /* @brief Prepares a point set with the permutation drawn from a fixed seed. */
+        template <typename PointSet>
+        PreparedTrajectory(const PointSet& set, std::uint64_t seed) : size_(set.size()), dimension_(set.dimension())
+        {
+            std::default_random_engine rngGenerator { static_cast<std::default_random_engine::result_type>(seed) };
+            detail::shuffledIndices(size_, permutation_, rngGenerator);
+            detail::pack(set, permutation_, packed_);
+            detail::boundingBox(set, lower_, upper_);
+        }
+
+        /* @brief Prepares a point set with a caller-supplied permutation of 0, ..., size - 1. */
+        template <typename PointSet>
+        PreparedTrajectory(const PointSet& set, const std::vector<int>& permutation)
+            : size_(set.size()), dimension_(set.dimension()), permutation_(permutation)
+        {
+            detail::checkPermutation(permutation_, size_);
+            detail::pack(set, permutation_, packed_);
+            detail::boundingBox(set, lower_, upper_);
+        }
+
+        explicit PreparedTrajectory(const std::vector<std::vector<T>>& points) : PreparedTrajectory(DistanceMetrics::NestedView<T>(points)) {}
+        PreparedTrajectory(const std::vector<std::vector<T>>& points, std::uint64_t seed) : PreparedTrajectory(DistanceMetrics::NestedView<T>(points), seed) {}
+
+        std::size_t size() const { return size_; }
+        std::size_t dimension() const { return dimension_; }
+        bool empty() const { return size_ == 0; }
+        const std::vector<int>& permutation() const { return permutation_; }
+        /* @brief Coordinate k of the t-th point of the permutation is stored at packed()[k * size() + t]. */
+        const T* packed() const { return packed_.data(); }
+        /* @brief Corners of the bounding box, dimension() values each. */
+        const T* lower() const { return lower_.data(); }
+        const T* upper() const { return upper_.data(); }
+
+    private:
+        std::size_t size_;
+        std::size_t dimension_;
+        std::vector<int> permutation_;
+        std::vector<T> packed_;
+        std::vector<T> lower_, upper_;
+    };
+};
+
+/* @brief Computes the Hausdorff distance between two vectors a and b which represent trajectories of strainlines.
+   @param[in] a Vector of vector of points
+   @param[in] b Vector of vector of points
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The Hausdorff distance between a and b
+*/
+template <typename T>
+double hausdorffDistance(const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b, Hausdorff::Workspace<T>& workspace)
+{
+    const DistanceMetrics::NestedView<T> viewA(a), viewB(b);
+    return DistanceMetrics::dispatchDimension(viewA.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::directedDistance<T, decltype(D)::value>(viewA, viewB, workspace);
+    });
+}
+
+/* @brief Computes the Hausdorff distance between two vectors a and b which represent trajectories of strainlines.
+   @param[in] a Vector of vector of points
+   @param[in] b Vector of vector of points
+   @returns The Hausdorff distance between a and b
+*/
+template <typename T>
+double hausdorffDistance(const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b)
+{
+    return hausdorffDistance(a, b, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories held in flat, strided buffers.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The Hausdorff distance between a and b
+*/
+template <typename T>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, Hausdorff::Workspace<T>& workspace)
+{
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::directedDistance<T, decltype(D)::value>(a, b, workspace);
+    });
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories held in flat, strided buffers.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @returns The Hausdorff distance between a and b
+*/
+template <typename T>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b)
+{
+    return hausdorffDistance(a, b, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the directed Hausdorff distance between two trajectories and the pair of points that attains it;
+ *        the same triple as scipy.spatial.distance.directed_hausdorff(a, b).
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls; seed it for reproducible indices
+   @returns The Hausdorff distance from a to b, the index of the point of a attaining it, and that of its nearest point in b
+*/
+template <typename T>
+Hausdorff::Witness hausdorffWitness(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, Hausdorff::Workspace<T>& workspace)
+{
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::directedWitness<T, decltype(D)::value>(a, b, workspace);
+    });
+}
+
+/* @brief Computes the directed Hausdorff distance between two trajectories and the pair of points that attains it.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @returns The Hausdorff distance from a to b, the index of the point of a attaining it, and that of its nearest point in b
+*/
+template <typename T>
+Hausdorff::Witness hausdorffWitness(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b)
+{
+    return hausdorffWitness(a, b, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories under a point metric policy (see Common/Metric.hpp).
+ *
+ * Euclidean, SquaredEuclidean and WeightedEuclidean run on the SIMD kernels; the other policies scan the targets a
+ * block at a time with the same early break, and the distance is finished once from the largest comparable value.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] metric The point metric
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The Hausdorff distance between a and b under metric
+*/
+template <typename T, typename Policy, typename = std::enable_if_t<DistanceMetrics::metrics::IsPolicy<Policy>::value>>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, const Policy& metric, Hausdorff::Workspace<T>& workspace)
+{
+    Hausdorff::detail::checkInputs(a, b);
+    metric.check(a.dimension());
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::directedMetricDistance<T, decltype(D)::value>(a, b, metric, workspace);
+    });
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories under a point metric policy.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] metric The point metric
+   @returns The Hausdorff distance between a and b under metric
+*/
+template <typename T, typename Policy, typename = std::enable_if_t<DistanceMetrics::metrics::IsPolicy<Policy>::value>>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, const Policy& metric)
+{
+    return hausdorffDistance(a, b, metric, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories of fixed-dimension points (e.g. std::array<double, 3>).
+   @param[in] a Vector of points of dimension D
+   @param[in] b Vector of points of dimension D
+   @returns The Hausdorff distance between a and b
+*/
+template <typename T, std::size_t D>
+double hausdorffDistance(const std::vector<std::array<T, D>>& a, const std::vector<std::array<T, D>>& b)
+{
+    return Hausdorff::detail::directedDistance<T, D>(DistanceMetrics::makeView(a), DistanceMetrics::makeView(b), Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the symmetric Hausdorff distance, max(h(a, b), h(b, a)), between two vectors a and b in one pass.
+   @param[in] a Vector of vector of points
+   @param[in] b Vector of vector of points
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The symmetric Hausdorff distance between a and b
+*/
+template <typename T>
+double symmetricHausdorffDistance(const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b, Hausdorff::Workspace<T>& workspace)
+{
+    const DistanceMetrics::NestedView<T> viewA(a), viewB(b);
+    return DistanceMetrics::dispatchDimension(viewA.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::symmetricDistance<T, decltype(D)::value>(viewA, viewB, workspace);
+    });
+}
+
+/* @brief Computes the symmetric Hausdorff distance, max(h(a, b), h(b, a)), between two vectors a and b in one pass.
+   @param[in] a Vector of vector of points
+   @param[in] b Vector of vector of points
+   @returns The symmetric Hausdorff distance between a and b
+*/
+template <typename T>
+double symmetricHausdorffDistance(const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b)
+{
+    return symmetricHausdorffDistance(a, b, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two trajectories held in flat, strided buffers.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The symmetric Hausdorff distance between a and b
+*/
+template <typename T>
+double symmetricHausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, Hausdorff::Workspace<T>& workspace)
+{
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::symmetricDistance<T, decltype(D)::value>(a, b, workspace);
+    });
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two trajectories held in flat, strided buffers.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @returns The symmetric Hausdorff distance between a and b
+*/
+template <typename T>
+double symmetricHausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b)
+{
+    return symmetricHausdorffDistance(a, b, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two trajectories under a point metric policy.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] metric The point metric
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The symmetric Hausdorff distance between a and b under metric
+*/
+template <typename T, typename Policy, typename = std::enable_if_t<DistanceMetrics::metrics::IsPolicy<Policy>::value>>
+double symmetricHausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, const Policy& metric, Hausdorff::Workspace<T>& workspace)
+{
+    Hausdorff::detail::checkInputs(a, b);
+    metric.check(a.dimension());
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::symmetricMetricDistance<T, decltype(D)::value>(a, b, metric, workspace);
+    });
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two trajectories under a point metric policy.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] metric The point metric
+   @returns The symmetric Hausdorff distance between a and b under metric
+*/
+template <typename T, typename Policy, typename = std::enable_if_t<DistanceMetrics::metrics::IsPolicy<Policy>::value>>
+double symmetricHausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, const Policy& metric)
+{
+    return symmetricHausdorffDistance(a, b, metric, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two trajectories of fixed-dimension points.
+   @param[in] a Vector of points of dimension D
+   @param[in] b Vector of points of dimension D
+   @returns The symmetric Hausdorff distance between a and b
+*/
+template <typename T, std::size_t D>
+double symmetricHausdorffDistance(const std::vector<std::array<T, D>>& a, const std::vector<std::array<T, D>>& b)
+{
+    return Hausdorff::detail::symmetricDistance<T, D>(DistanceMetrics::makeView(a), DistanceMetrics::makeView(b), Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories using given index permutations, which makes the
+ *        result reproducible and lets the caller shuffle each trajectory once and reuse the permutation.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] permutationA Order in which the points of a are visited; a permutation of 0, ..., a.size() - 1
+   @param[in] permutationB Order in which the points of b are visited; a permutation of 0, ..., b.size() - 1
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The Hausdorff distance between a and b
+*/
+template <typename T>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b,
+                         const std::vector<int>& permutationA, const std::vector<int>& permutationB, Hausdorff::Workspace<T>& workspace)
+{
+    Hausdorff::detail::checkPermutation(permutationA, a.size());
+    Hausdorff::detail::checkPermutation(permutationB, b.size());
+    workspace.indicesA.assign(permutationA.begin(), permutationA.end());
+    workspace.indicesB.assign(permutationB.begin(), permutationB.end());
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::directedDistance<T, decltype(D)::value>(a, b, workspace, false);
+    });
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories using given index permutations.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] permutationA Order in which the points of a are visited
+   @param[in] permutationB Order in which the points of b are visited
+   @returns The Hausdorff distance between a and b
+*/
+template <typename T>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b,
+                         const std::vector<int>& permutationA, const std::vector<int>& permutationB)
+{
+    return hausdorffDistance(a, b, permutationA, permutationB, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the Hausdorff distance between two prepared trajectories; no shuffling, packing or allocation of
+ *        trajectory-sized buffers takes place.
+   @param[in] a First prepared trajectory
+   @param[in] b Second prepared trajectory
+   @returns The Hausdorff distance between a and b
+*/
+template <typename T>
+double hausdorffDistance(const Hausdorff::PreparedTrajectory<T>& a, const Hausdorff::PreparedTrajectory<T>& b)
+{
+    Hausdorff::detail::checkInputs(a, b);
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::withQueryBuffer<T, decltype(D)::value>(a.dimension(), [&](T* query)
+        {
+            return std::sqrt(static_cast<double>(Hausdorff::detail::directedPacked<T, decltype(D)::value>(a.packed(), a.size(), b.packed(), b.size(), a.dimension(), query)));
+        });
+    });
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two prepared trajectories in one pass.
+   @param[in] a First prepared trajectory
+   @param[in] b Second prepared trajectory
+   @returns The symmetric Hausdorff distance between a and b
+*/
+template <typename T>
+double symmetricHausdorffDistance(const Hausdorff::PreparedTrajectory<T>& a, const Hausdorff::PreparedTrajectory<T>& b)
+{
+    Hausdorff::detail::checkInputs(a, b);
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::withQueryBuffer<T, decltype(D)::value>(a.dimension(), [&](T* query)
+        {
+            return std::sqrt(static_cast<double>(Hausdorff::detail::symmetricPacked<T, decltype(D)::value>(a.packed(), a.size(), b.packed(), b.size(), a.dimension(), query)));
+        });
+    });
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories, giving up as soon as it is known to exceed cutoff.
+ *
+ * Intended for nearest-trajectory searches, where cutoff is the current k-th best distance: the bounding boxes are
+ * compared first, and the scan over a stops at the first point whose nearest-point distance exceeds cutoff.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] cutoff Largest distance of interest
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that is greater than cutoff
+*/
+template <typename T>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, double cutoff, Hausdorff::Workspace<T>& workspace)
+{
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::directedDistance<T, decltype(D)::value>(a, b, cutoff, workspace);
+    });
+}
+
+/* @brief Computes the Hausdorff distance between two trajectories, giving up as soon as it is known to exceed cutoff.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] cutoff Largest distance of interest
+   @returns The Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that is greater than cutoff
+*/
+template <typename T>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, double cutoff)
+{
+    return hausdorffDistance(a, b, cutoff, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the Hausdorff distance between two vectors a and b, giving up as soon as it is known to exceed cutoff.
+   @param[in] a Vector of vector of points
+   @param[in] b Vector of vector of points
+   @param[in] cutoff Largest distance of interest
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that is greater than cutoff
+*/
+template <typename T>
+double hausdorffDistance(const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b, double cutoff, Hausdorff::Workspace<T>& workspace)
+{
+    const DistanceMetrics::NestedView<T> viewA(a), viewB(b);
+    return DistanceMetrics::dispatchDimension(viewA.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::directedDistance<T, decltype(D)::value>(viewA, viewB, cutoff, workspace);
+    });
+}
+
+/* @brief Computes the Hausdorff distance between two vectors a and b, giving up as soon as it is known to exceed cutoff.
+   @param[in] a Vector of vector of points
+   @param[in] b Vector of vector of points
+   @param[in] cutoff Largest distance of interest
+   @returns The Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that is greater than cutoff
+*/
+template <typename T>
+double hausdorffDistance(const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b, double cutoff)
+{
+    return hausdorffDistance(a, b, cutoff, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two trajectories, giving up as soon as it is known to exceed cutoff.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] cutoff Largest distance of interest
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls
+   @returns The symmetric Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that is greater than cutoff
+*/
+template <typename T>
+double symmetricHausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, double cutoff, Hausdorff::Workspace<T>& workspace)
+{
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::symmetricDistance<T, decltype(D)::value>(a, b, cutoff, workspace);
+    });
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two trajectories, giving up as soon as it is known to exceed cutoff.
+   @param[in] a View of the first trajectory
+   @param[in] b View of the second trajectory
+   @param[in] cutoff Largest distance of interest
+   @returns The symmetric Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that is greater than cutoff
+*/
+template <typename T>
+double symmetricHausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, double cutoff)
+{
+    return symmetricHausdorffDistance(a, b, cutoff, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the Hausdorff distance between two prepared trajectories, giving up as soon as it is known to exceed
+ *        cutoff. The stored bounding boxes reject distant pairs without touching a single point.
+   @param[in] a First prepared trajectory
+   @param[in] b Second prepared trajectory
+   @param[in] cutoff Largest distance of interest
+   @returns The Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that is greater than cutoff
+*/
+template <typename T>
+double hausdorffDistance(const Hausdorff::PreparedTrajectory<T>& a, const Hausdorff::PreparedTrajectory<T>& b, double cutoff)
+{
+    Hausdorff::detail::checkInputs(a, b);
+    const T bound = Hausdorff::detail::boxLowerBound(a.lower(), a.upper(), b.lower(), b.upper(), a.dimension());
+    const T cutoffSquared = Hausdorff::detail::squaredCutoff<T>(cutoff);
+    if (bound > cutoffSquared) return std::sqrt(static_cast<double>(bound));
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::withQueryBuffer<T, decltype(D)::value>(a.dimension(), [&](T* query)
+        {
+            return std::sqrt(static_cast<double>(Hausdorff::detail::directedPacked<T, decltype(D)::value>(a.packed(), a.size(), b.packed(), b.size(), a.dimension(),
+                                                                                                           query, T(0), cutoffSquared)));
+        });
+    });
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two prepared trajectories, giving up as soon as it is known
+ *        to exceed cutoff.
+   @param[in] a First prepared trajectory
+   @param[in] b Second prepared trajectory
+   @param[in] cutoff Largest distance of interest
+   @returns The symmetric Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that is greater than cutoff
+*/
+template <typename T>
+double symmetricHausdorffDistance(const Hausdorff::PreparedTrajectory<T>& a, const Hausdorff::PreparedTrajectory<T>& b, double cutoff)
+{
+    Hausdorff::detail::checkInputs(a, b);
+    const T bound = std::max(Hausdorff::detail::boxLowerBound(a.lower(), a.upper(), b.lower(), b.upper(), a.dimension()),
+                             Hausdorff::detail::boxLowerBound(b.lower(), b.upper(), a.lower(), a.upper(), a.dimension()));
+    const T cutoffSquared = Hausdorff::detail::squaredCutoff<T>(cutoff);
+    if (bound > cutoffSquared) return std::sqrt(static_cast<double>(bound));
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return Hausdorff::detail::withQueryBuffer<T, decltype(D)::value>(a.dimension(), [&](T* query)
+        {
+            return std::sqrt(static_cast<double>(Hausdorff::detail::symmetricPacked<T, decltype(D)::value>(a.packed(), a.size(), b.packed(), b.size(), a.dimension(),
+                                                                                                            query, cutoffSquared)));
+        });
+    });
 }
 #endif
@@ -0,0 +1,280 @@
+#ifndef __HAUSDORFF_INDEX_H__
+#define __HAUSDORFF_INDEX_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "Hausdorff.hpp"
+
+namespace Hausdorff
+{
+    /* @brief k-d tree over one trajectory, built once and reused to answer the nearest-point searches of many
+     *        hausdorffDistance queries against it.
+     *
+     * Points are reordered so that every leaf is a contiguous run of a structure-of-arrays buffer, which lets the leaves
+     * be scanned with the same SIMD kernel as the brute-force search. Each node keeps its bounding box, so a subtree is
+     * skipped as soon as the box is further from the query than the best distance found so far.
+     */
+    template <typename T>
+    class KdTree
+    {
+    public:
+        /* @brief Builds the tree over any point set exposing size(), dimension() and operator()(i, k).
+           @param[in] points Points to index; copied into the tree.
+           @param[in] leafSize Maximum number of points in a leaf.
+        */
+        template <typename PointSet>
+        explicit KdTree(const PointSet& points, std::size_t leafSize = 32)
+            : size_(points.size()), dimension_(points.dimension()), leafSize_(std::max<std::size_t>(1, leafSize))
+        {
+            if (points.empty())
+            {
+                throw std::runtime_error("The trajectory passed to KdTree is empty.");
+            }
+            std::vector<T> rowMajor(size_ * dimension_);
+            for (std::size_t i = 0; i < size_; ++i)
+            {
+                for (std::size_t k = 0; k < dimension_; ++k) rowMajor[i * dimension_ + k] = points(i, k);
+            }
+            std::vector<std::size_t> order(size_);
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            build(rowMajor, order, 0, size_);
+
+            packed_.resize(size_ * dimension_);
+            for (std::size_t t = 0; t < size_; ++t)
+            {
+                for (std::size_t k = 0; k < dimension_; ++k) packed_[k * size_ + t] = rowMajor[order[t] * dimension_ + k];
+            }
+        }
+
+        explicit KdTree(const std::vector<std::vector<T>>& points, std::size_t leafSize = 32) : KdTree(DistanceMetrics::NestedView<T>(points), leafSize) {}
+
+        std::size_t size() const { return size_; }
+        std::size_t dimension() const { return dimension_; }
+        bool empty() const { return size_ == 0; }
+
+        /* @brief Coordinate k of the i-th indexed point, in tree order. */
+        const T& operator()(std::size_t i, std::size_t k) const { return packed_[k * size_ + i]; }
+
+        /* @brief Squared distance from query to its nearest indexed point, stopping early if a point closer than threshold exists.
+           @returns The squared nearest-point distance, or an unspecified value below threshold if brokeEarly is set.
+           @param[in] query Pointer to dimension() coordinates.
+           @param[in] threshold Early-termination threshold (squared); the running cMax of a Hausdorff scan.
+           @param[out] brokeEarly Set if a point closer than threshold was found.
+        */
+        template <std::size_t D = DistanceMetrics::DynamicDimension>
+        T nearestSquared(const T* query, T threshold, bool& brokeEarly) const
+        {
+            T best = std::numeric_limits<T>::infinity();
+            std::size_t stack[128];
+            std::size_t top = 0;
+            stack[top++] = 0;
+            brokeEarly = false;
+            while (top > 0)
+            {
+                const Node& node = nodes_[stack[--top]];
+                if (boxDistance(node, query) >= best) continue;
+                if (node.left == 0) /* Leaf */
+                {
+                    T d = DistanceMetrics::simd::minSquaredDistance<T, D>(query, dimension_, packed_.data() + node.begin, size_,
+                                                                          node.end - node.begin, threshold, brokeEarly);
+                    if (brokeEarly) return d;
+                    best = std::min(best, d);
+                    continue;
+                }
+                /* Visit the child on the query's side of the split first */
+                const bool lowerFirst = query[node.axis] < node.split;
+                stack[top++] = lowerFirst ? node.right : node.left;
+                stack[top++] = lowerFirst ? node.left : node.right;
+            }
+            return best;
+        }
+
+    private:
+        struct Node
+        {
+            std::size_t begin, end;     // Range of points in tree order
+            std::size_t left, right;    // Children; left == 0 marks a leaf (the root is never a child)
+            std::size_t axis;
+            T split;
+        };
+
+        /* @brief Squared distance from query to the bounding box of node; zero inside the box. */
+        T boxDistance(const Node& node, const T* query) const
+        {
+            const std::size_t index = static_cast<std::size_t>(&node - nodes_.data());
+            const T* lower = lower_.data() + index * dimension_;
+            const T* upper = upper_.data() + index * dimension_;
+            T sum = 0.0;
+            for (std::size_t k = 0; k < dimension_; ++k)
+            {
+                T excess = std::max(lower[k] - query[k], query[k] - upper[k]);
+                if (excess > 0) sum += excess * excess;
+            }
+            return sum;
+        }
+
+        /* @brief Recursively splits order[begin, end) at the median of its widest coordinate. */
+        std::size_t build(const std::vector<T>& points, std::vector<std::size_t>& order, std::size_t begin, std::size_t end)
+        {
+            const std::size_t index = nodes_.size();
+            nodes_.push_back(Node { begin, end, 0, 0, 0, T(0) });
+            lower_.resize(lower_.size() + dimension_, std::numeric_limits<T>::infinity());
+            upper_.resize(upper_.size() + dimension_, -std::numeric_limits<T>::infinity());
+            for (std::size_t t = begin; t < end; ++t)
+            {
+                for (std::size_t k = 0; k < dimension_; ++k)
+                {
+                    const T value = points[order[t] * dimension_ + k];
+                    lower_[index * dimension_ + k] = std::min(lower_[index * dimension_ + k], value);
+                    upper_[index * dimension_ + k] = std::max(upper_[index * dimension_ + k], value);
+                }
+            }
+            if (end - begin <= leafSize_) return index;
+
+            std::size_t axis = 0;
+            for (std::size_t k = 1; k < dimension_; ++k)
+            {
+                if (upper_[index * dimension_ + k] - lower_[index * dimension_ + k] > upper_[index * dimension_ + axis] - lower_[index * dimension_ + axis]) axis = k;
+            }
+            const std::size_t middle = begin + (end - begin) / 2;
+            std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&](std::size_t x, std::size_t y)
+            {
+                return points[x * dimension_ + axis] < points[y * dimension_ + axis];
+            });
+            const T split = points[order[middle] * dimension_ + axis];
+            const std::size_t left = build(points, order, begin, middle);
+            const std::size_t right = build(points, order, middle, end);
+            nodes_[index].left = left;
+            nodes_[index].right = right;
+            nodes_[index].axis = axis;
+            nodes_[index].split = split;
+            return index;
+        }
+
+        std::size_t size_;
+        std::size_t dimension_;
+        std::size_t leafSize_;
+        std::vector<Node> nodes_;
+        std::vector<T> lower_, upper_;   // Bounding box of each node, dimension_ values per node
+        std::vector<T> packed_;          // Points in tree order, structure-of-arrays
+    };
+
+    namespace detail
+    {
+        /* @brief Raises cMax by scanning the queries in a random order against a k-d tree, stopping as soon as cMax
+         *        exceeds the squared cutoff. The order is drawn into workspace.indicesA from workspace.rngGenerator.
+        */
+        template <typename T, std::size_t D, typename PointSet>
+        T directedIndexed(const PointSet& a, const KdTree<T>& tree, Workspace<T>& workspace, T cMax, T cutoff = std::numeric_limits<T>::infinity())
+        {
+            checkInputs(a, tree);
+            shuffledIndices(a.size(), workspace.indicesA, workspace.rngGenerator);
+            workspace.query.resize(a.dimension());
+            T* query = workspace.query.data();
+            for (int index : workspace.indicesA)
+            {
+                if (cMax > cutoff) break;
+                bool haveWeBroken = false;
+                loadPoint(a, index, static_cast<const T*>(nullptr), query);
+                T cMin = tree.template nearestSquared<D>(query, cMax, haveWeBroken);
+                if ( !haveWeBroken && cMin >= cMax ) cMax = cMin;
+            }
+            return cMax;
+        }
+    };
+};
+
+/* @brief Computes the Hausdorff distance from a to the points indexed by a k-d tree. Building the tree costs
+ *        O(m log m) once; each query point then costs roughly O(log m) instead of O(m) in the worst case.
+   @param[in] a View of the query trajectory
+   @param[in] tree k-d tree over the second trajectory
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls; seed it for a reproducible query order
+   @returns The Hausdorff distance between a and the indexed trajectory
+*/
+template <typename T>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const Hausdorff::KdTree<T>& tree, Hausdorff::Workspace<T>& workspace)
+{
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        return std::sqrt(static_cast<double>(Hausdorff::detail::directedIndexed<T, decltype(D)::value>(a, tree, workspace, T(0))));
+    });
+}
+
+/* @brief Computes the Hausdorff distance from a to the points indexed by a k-d tree.
+   @param[in] a View of the query trajectory
+   @param[in] tree k-d tree over the second trajectory
+   @returns The Hausdorff distance between a and the indexed trajectory
+*/
+template <typename T>
+double hausdorffDistance(const DistanceMetrics::TrajectoryView<T>& a, const Hausdorff::KdTree<T>& tree)
+{
+    return hausdorffDistance(a, tree, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two indexed trajectories. The second direction starts
+ *        from the result of the first as its early-termination threshold.
+   @param[in] a k-d tree over the first trajectory
+   @param[in] b k-d tree over the second trajectory
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls; seed it for a reproducible query order
+   @returns The symmetric Hausdorff distance between the two trajectories
+*/
+template <typename T>
+double symmetricHausdorffDistance(const Hausdorff::KdTree<T>& a, const Hausdorff::KdTree<T>& b, Hausdorff::Workspace<T>& workspace)
+{
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        T cMax = Hausdorff::detail::directedIndexed<T, decltype(D)::value>(a, b, workspace, T(0));
+        return std::sqrt(static_cast<double>(Hausdorff::detail::directedIndexed<T, decltype(D)::value>(b, a, workspace, cMax)));
+    });
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two indexed trajectories.
+   @param[in] a k-d tree over the first trajectory
+   @param[in] b k-d tree over the second trajectory
+   @returns The symmetric Hausdorff distance between the two trajectories
+*/
+template <typename T>
+double symmetricHausdorffDistance(const Hausdorff::KdTree<T>& a, const Hausdorff::KdTree<T>& b)
+{
+    return symmetricHausdorffDistance(a, b, Hausdorff::detail::threadWorkspace<T>());
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two indexed trajectories, giving up as soon as it is known
+ *        to exceed cutoff.
+   @param[in] a k-d tree over the first trajectory
+   @param[in] b k-d tree over the second trajectory
+   @param[in] cutoff Distance beyond which the exact value is not needed
+   @param[inout] workspace Caller-owned scratch storage, reusable across calls; seed it for a reproducible query order
+   @returns The symmetric Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that exceeds cutoff
+*/
+template <typename T>
+double symmetricHausdorffDistance(const Hausdorff::KdTree<T>& a, const Hausdorff::KdTree<T>& b, double cutoff, Hausdorff::Workspace<T>& workspace)
+{
+    const T cutoffSquared = Hausdorff::detail::squaredCutoff<T>(cutoff);
+    return DistanceMetrics::dispatchDimension(a.dimension(), [&](auto D)
+    {
+        T cMax = Hausdorff::detail::directedIndexed<T, decltype(D)::value>(a, b, workspace, T(0), cutoffSquared);
+        if (cMax <= cutoffSquared) cMax = Hausdorff::detail::directedIndexed<T, decltype(D)::value>(b, a, workspace, cMax, cutoffSquared);
+        return std::sqrt(static_cast<double>(cMax));
+    });
+}
+
+/* @brief Computes the symmetric Hausdorff distance between two indexed trajectories, giving up as soon as it is known
+ *        to exceed cutoff.
+   @param[in] a k-d tree over the first trajectory
+   @param[in] b k-d tree over the second trajectory
+   @param[in] cutoff Distance beyond which the exact value is not needed
+   @returns The symmetric Hausdorff distance if it is at most cutoff, otherwise a lower bound on it that exceeds cutoff
+*/
+template <typename T>
+double symmetricHausdorffDistance(const Hausdorff::KdTree<T>& a, const Hausdorff::KdTree<T>& b, double cutoff)
+{
+    return symmetricHausdorffDistance(a, b, cutoff, Hausdorff::detail::threadWorkspace<T>());
+}
+#endif
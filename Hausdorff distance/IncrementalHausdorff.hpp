@@ -0,0 +1,215 @@
+#ifndef __INCREMENTAL_HAUSDORFF_H__
+#define __INCREMENTAL_HAUSDORFF_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Hausdorff.hpp"
+
+namespace Hausdorff
+{
+    namespace detail
+    {
+        /* @brief Growable structure-of-arrays point buffer: coordinate k of point j is at data[k * capacity + j]. */
+        template <typename T>
+        class GrowingPoints
+        {
+        public:
+            explicit GrowingPoints(std::size_t dimension) : dimension_(dimension) {}
+
+            void push_back(const T* point)
+            {
+                if (size_ == capacity_)
+                {
+                    /* Double the capacity and repack the coordinate arrays at the new stride */
+                    const std::size_t capacity = std::max<std::size_t>(16, 2 * capacity_);
+                    std::vector<T> data(capacity * dimension_);
+                    for (std::size_t k = 0; k < dimension_; ++k)
+                    {
+                        std::copy(data_.begin() + k * capacity_, data_.begin() + k * capacity_ + size_, data.begin() + k * capacity);
+                    }
+                    data_.swap(data);
+                    capacity_ = capacity;
+                }
+                for (std::size_t k = 0; k < dimension_; ++k) data_[k * capacity_ + size_] = point[k];
+                ++size_;
+            }
+
+            const T* coordinate(std::size_t k) const { return data_.data() + k * capacity_; }
+            std::size_t size() const { return size_; }
+
+        private:
+            std::size_t dimension_;
+            std::size_t size_ = 0;
+            std::size_t capacity_ = 0;
+            std::vector<T> data_;
+        };
+    };
+
+    /* @brief Directed and symmetric Hausdorff distances between two point sets that grow over time.
+     *
+     * For every point of A the squared distance to its nearest point of B is cached, and vice versa. Appending a point
+     * to A computes its distances to all of B once: their minimum is the new point's entry, and each of them may lower
+     * the cached entry of a point of B. Appending k points to either set therefore costs O(k * (n + m)) instead of
+     * the O(n * m) of a fresh scan, and the distances are read straight from the caches.
+     */
+    template <typename T>
+    class IncrementalHausdorff
+    {
+    public:
+        explicit IncrementalHausdorff(std::size_t dimension) : dimension_(dimension), a_(dimension), b_(dimension)
+        {
+            if (dimension == 0)
+            {
+                throw std::runtime_error("The dimension passed to IncrementalHausdorff is zero.");
+            }
+        }
+
+        /* @brief Starts from two point sets exposing size(), dimension() and operator()(i, k); either may be empty. */
+        template <typename PointSetA, typename PointSetB>
+        IncrementalHausdorff(const PointSetA& a, const PointSetB& b) : IncrementalHausdorff(a.empty() ? b.dimension() : a.dimension())
+        {
+            appendA(a);
+            appendB(b);
+        }
+
+        /* @brief Adds one point of dimension() coordinates to A, in O(n + m). */
+        void appendA(const T* point)
+        {
+            append(point, a_, nearestA_, b_, nearestB_, maxA_, maxB_);
+        }
+
+        /* @brief Adds one point of dimension() coordinates to B, in O(n + m). */
+        void appendB(const T* point)
+        {
+            append(point, b_, nearestB_, a_, nearestA_, maxB_, maxA_);
+        }
+
+        void appendA(const std::vector<T>& point)
+        {
+            checkDimension(point.size());
+            appendA(point.data());
+        }
+
+        void appendB(const std::vector<T>& point)
+        {
+            checkDimension(point.size());
+            appendB(point.data());
+        }
+
+        /* @brief Adds the k points of a point set to A, in O(k * (n + m)). */
+        template <typename PointSet, typename = decltype(std::declval<const PointSet&>().dimension())>
+        void appendA(const PointSet& points)
+        {
+            forEachPoint(points, [&](const T* point) { appendA(point); });
+        }
+
+        /* @brief Adds the k points of a point set to B, in O(k * (n + m)). */
+        template <typename PointSet, typename = decltype(std::declval<const PointSet&>().dimension())>
+        void appendB(const PointSet& points)
+        {
+            forEachPoint(points, [&](const T* point) { appendB(point); });
+        }
+
+        /* @brief Directed Hausdorff distance from A to B. */
+        double directedDistanceAB() const
+        {
+            checkInputs();
+            return std::sqrt(static_cast<double>(maxA_));
+        }
+
+        /* @brief Directed Hausdorff distance from B to A. */
+        double directedDistanceBA() const
+        {
+            checkInputs();
+            return std::sqrt(static_cast<double>(maxB_));
+        }
+
+        /* @brief Symmetric Hausdorff distance, max(h(A, B), h(B, A)). */
+        double symmetricDistance() const
+        {
+            checkInputs();
+            return std::sqrt(static_cast<double>(std::max(maxA_, maxB_)));
+        }
+
+        /* @brief Squared distance from each point of A to its nearest point of B (infinity while B is empty). */
+        const std::vector<T>& nearestA() const { return nearestA_; }
+
+        /* @brief Squared distance from each point of B to its nearest point of A (infinity while A is empty). */
+        const std::vector<T>& nearestB() const { return nearestB_; }
+
+        std::size_t sizeA() const { return a_.size(); }
+        std::size_t sizeB() const { return b_.size(); }
+        std::size_t dimension() const { return dimension_; }
+
+    private:
+        void checkDimension(std::size_t dimension) const
+        {
+            if (dimension != dimension_)
+            {
+                throw std::runtime_error("The point passed to IncrementalHausdorff has the wrong dimension.");
+            }
+        }
+
+        void checkInputs() const
+        {
+            if (a_.size() == 0 || b_.size() == 0)
+            {
+                throw std::runtime_error("One of the point sets held by IncrementalHausdorff is empty.");
+            }
+        }
+
+        template <typename PointSet, typename Function>
+        void forEachPoint(const PointSet& points, Function&& f)
+        {
+            if (points.empty()) return;
+            checkDimension(points.dimension());
+            std::vector<T> point(dimension_);
+            for (std::size_t i = 0; i < points.size(); ++i)
+            {
+                for (std::size_t k = 0; k < dimension_; ++k) point[k] = points(i, k);
+                f(point.data());
+            }
+        }
+
+        /* @brief Appends point to own, updating the caches of both sets and the two running maxima. */
+        void append(const T* point, detail::GrowingPoints<T>& own, std::vector<T>& ownNearest, const detail::GrowingPoints<T>& other,
+                    std::vector<T>& otherNearest, T& ownMax, T& otherMax)
+        {
+            using A = DistanceMetrics::AccumulatorType<T>;
+            const std::size_t count = other.size();
+            /* Squared distances from the new point to every point of the other set, one coordinate array at a time */
+            sums_.assign(count, A(0));
+            for (std::size_t k = 0; k < dimension_; ++k)
+            {
+                const A x = point[k];
+                const T* column = other.coordinate(k);
+                for (std::size_t j = 0; j < count; ++j) sums_[j] += (x - static_cast<A>(column[j])) * (x - static_cast<A>(column[j]));
+            }
+            T nearest = std::numeric_limits<T>::infinity();
+            otherMax = 0.0;
+            for (std::size_t j = 0; j < count; ++j)
+            {
+                const T d = static_cast<T>(sums_[j]);
+                nearest = std::min(nearest, d);
+                otherNearest[j] = std::min(otherNearest[j], d);
+                otherMax = std::max(otherMax, otherNearest[j]);
+            }
+            own.push_back(point);
+            ownNearest.push_back(nearest);
+            /* Until the other set has points, the directed distance from this one is undefined; keep the maximum finite */
+            if (count > 0) ownMax = std::max(ownMax, nearest);
+        }
+
+        std::size_t dimension_;
+        detail::GrowingPoints<T> a_, b_;
+        std::vector<T> nearestA_, nearestB_;
+        T maxA_ = 0.0, maxB_ = 0.0;         // Squared directed distances A -> B and B -> A
+        std::vector<DistanceMetrics::AccumulatorType<T>> sums_;
+    };
+};
+#endif
@@ -0,0 +1,351 @@
+/*  MPI-distributed pairwise distances
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __PAIRWISE_MPI_H__
+#define __PAIRWISE_MPI_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <mpi.h>
+#include "../Common/Trajectory.hpp"
+#include "../Common/Pairwise.hpp"
+#include "../Common/TrajectoryStore.hpp"
+#include "../Hausdorff distance/Hausdorff.hpp"
+#include "../Frechet_distance/Frechet.hpp"
+
+/* The condensed matrix is cut into tiles by the same makeTiles as the shared-memory engine; a tile is one row of the
+ * matrix over a run of columns, so its results are contiguous in the condensed layout. The tiling only depends on the
+ * trajectory sizes and Options::tiles, never on the number of ranks or threads, so a checkpoint written by one job can
+ * be resumed by a job of any size.
+ *
+ * Every rank computes the same tiling and the same assignment, so no work is ever exchanged. Each rank reads the
+ * trajectories its tiles touch straight from a memory-mapped TrajectoryStore on the shared filesystem, so only those
+ * pages are ever brought into its memory, and writes each finished tile at its offset of the shared output file.
+ */
+namespace DistanceMetrics
+{
+    namespace mpi
+    {
+        /* @brief Tuning and restart settings of pairwiseDistancesToFile. */
+        struct Options
+        {
+            unsigned threads = 0;               // Threads per rank; 0 uses every hardware thread
+            std::size_t tiles = 1 << 16;        // Approximate number of tiles the whole matrix is cut into
+            std::size_t batch = 64;             // Tiles computed between two checkpoints
+            std::string checkpoint;             // Prefix of the per-rank checkpoint files; empty disables checkpointing
+        };
+
+        /* @brief What one rank did in a call of pairwiseDistancesToFile. */
+        struct Progress
+        {
+            std::size_t tiles = 0;              // Tiles of the whole matrix
+            std::size_t resumed = 0;            // Tiles already completed by an earlier job
+            std::size_t computed = 0;           // Tiles computed by this rank
+        };
+
+        namespace detail
+        {
+            /* Checkpoint files are a header followed by one record per completed tile, appended as tiles are written */
+            struct CheckpointHeader
+            {
+                char magic[8];                  // "DMCKPT01"
+                std::uint64_t count;            // Number of trajectories
+                std::uint64_t tiles;            // Number of tiles in the tiling
+                std::uint64_t metric;           // The Metric, as an integer
+            };
+
+            struct CheckpointRecord
+            {
+                std::uint64_t row;
+                std::uint64_t columnBegin;
+            };
+
+            constexpr char checkpointMagic[8] = { 'D', 'M', 'C', 'K', 'P', 'T', '0', '1' };
+
+            inline std::string checkpointPath(const std::string& prefix, int rank)
+            {
+                return prefix + ".rank" + std::to_string(rank);
+            }
+
+            inline void check(int status, const std::string& what)
+            {
+                if (status != MPI_SUCCESS) throw std::runtime_error(what);
+            }
+
+            /* @brief Reads every checkpoint file of the prefix, of this job's ranks or of an earlier job's, into done.
+             *        Records of a partially written tail are ignored.
+            */
+            inline void readCheckpoints(const std::string& prefix, const CheckpointHeader& expected, std::vector<CheckpointRecord>& done)
+            {
+                for (int rank = 0; ; ++rank)
+                {
+                    std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(checkpointPath(prefix, rank).c_str(), "rb"), &std::fclose);
+                    if (!file) return;
+                    CheckpointHeader header;
+                    if (std::fread(&header, sizeof(header), 1, file.get()) != 1) continue;
+                    if (std::memcmp(&header, &expected, sizeof(header)) != 0)
+                    {
+                        throw std::runtime_error("The checkpoint " + checkpointPath(prefix, rank) + " belongs to a different job.");
+                    }
+                    CheckpointRecord record;
+                    while (std::fread(&record, sizeof(record), 1, file.get()) == 1) done.push_back(record);
+                }
+            }
+
+            /* @brief Opens this rank's checkpoint for appending, writing the header if the file is new and dropping any
+             *        partially written record at its end.
+            */
+            inline std::FILE* openCheckpoint(const std::string& path, const CheckpointHeader& header)
+            {
+                std::error_code error;
+                const std::uintmax_t bytes = std::filesystem::file_size(path, error);
+                if (!error && bytes >= sizeof(CheckpointHeader))
+                {
+                    const std::uintmax_t whole = bytes - (bytes - sizeof(CheckpointHeader)) % sizeof(CheckpointRecord);
+                    if (whole != bytes) std::filesystem::resize_file(path, whole);
+                    std::FILE* file = std::fopen(path.c_str(), "ab");
+                    if (!file) throw std::runtime_error("Could not open " + path + " for appending.");
+                    return file;
+                }
+                std::FILE* file = std::fopen(path.c_str(), "wb");
+                if (!file || std::fwrite(&header, sizeof(header), 1, file) != 1 || std::fflush(file) != 0)
+                {
+                    if (file) std::fclose(file);
+                    throw std::runtime_error("Could not create " + path + ".");
+                }
+                return file;
+            }
+
+            /* @brief Longest-processing-time assignment: tiles, most expensive first, each go to the least loaded rank.
+               @returns The positions in tiles of the tiles assigned to rank, most expensive first.
+            */
+            inline std::vector<std::size_t> assignTiles(const std::vector<DistanceMetrics::detail::PairTile>& tiles, const std::vector<std::size_t>& pending,
+                                                        int ranks, int rank)
+            {
+                using Load = std::pair<double, int>;
+                std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+                for (int r = 0; r < ranks; ++r) loads.push(Load(0.0, r));
+                std::vector<std::size_t> assigned;
+                for (std::size_t position : pending)
+                {
+                    Load least = loads.top();
+                    loads.pop();
+                    if (least.second == rank) assigned.push_back(position);
+                    least.first += tiles[position].cost;
+                    loads.push(least);
+                }
+                return assigned;
+            }
+        };
+
+        /* @brief Computes the symmetric Hausdorff or the Frechet distance for every pair of trajectories across the
+         *        ranks of comm, writing the condensed matrix to a shared file.
+         *
+         * The output is the condensed matrix of scipy.spatial.distance.pdist as raw native doubles, N (N - 1) / 2 of
+         * them with pair (i, j) at condensedIndex(N, i, j), so it can be read back with numpy.fromfile or mapped.
+         * The tiles still to be done are assigned to ranks by estimated cost (n * m per pair), largest first to the
+         * least loaded rank, and each rank spreads its tiles across threads a batch at a time. After every batch the
+         * results are synced to disk and the batch's tiles are appended to the rank's checkpoint file; a later call
+         * with the same checkpoint prefix skips every tile recorded there, whatever the number of ranks.
+         *
+         * Collective over comm; every rank must pass the same trajectories (typically the same TrajectoryStore) and
+         * options. MPI only has to provide MPI_THREAD_FUNNELED, as only the calling thread makes MPI calls.
+           @returns This rank's share of the work.
+           @param[in] trajectories The N trajectories.
+           @param[in] metric Which distance to compute.
+           @param[in] output Path of the shared output file, created if needed and never truncated when resuming.
+           @param[in] options Threads, granularity and checkpointing.
+           @param[in] comm The communicator whose ranks share the work.
+        */
+        template <typename T>
+        Progress pairwiseDistancesToFile(const std::vector<TrajectoryView<T>>& trajectories, Metric metric, const std::string& output,
+                                         const Options& options = Options(), MPI_Comm comm = MPI_COMM_WORLD)
+        {
+            int rank = 0, ranks = 1;
+            MPI_Comm_rank(comm, &rank);
+            MPI_Comm_size(comm, &ranks);
+            const std::size_t count = trajectories.size();
+            const unsigned threads = DistanceMetrics::detail::resolveThreads(options.threads);
+            const std::vector<std::size_t> sizes = DistanceMetrics::detail::trajectorySizes(trajectories);
+            const std::vector<DistanceMetrics::detail::PairTile> tiles = DistanceMetrics::detail::makeTiles(sizes, std::max<std::size_t>(1, options.tiles), 1);
+
+            Progress progress;
+            progress.tiles = tiles.size();
+            detail::CheckpointHeader header;
+            std::memcpy(header.magic, detail::checkpointMagic, sizeof(header.magic));
+            header.count = count;
+            header.tiles = tiles.size();
+            header.metric = static_cast<std::uint64_t>(metric);
+
+            /* Which tiles are done. Every rank reads every checkpoint before any of them is appended to */
+            std::vector<detail::CheckpointRecord> done;
+            int failed = 0;
+            std::string failure;
+            try
+            {
+                if (!options.checkpoint.empty()) detail::readCheckpoints(options.checkpoint, header, done);
+            }
+            catch (const std::exception& error)
+            {
+                failed = 1;
+                failure = error.what();
+            }
+            MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, comm);
+            if (failed) throw std::runtime_error(failure.empty() ? "Reading the checkpoints failed on another rank." : failure);
+
+            auto key = [](std::uint64_t row, std::uint64_t columnBegin) { return std::make_pair(row, columnBegin); };
+            std::vector<std::pair<std::uint64_t, std::uint64_t>> doneKeys;
+            doneKeys.reserve(done.size());
+            for (const detail::CheckpointRecord& record : done) doneKeys.push_back(key(record.row, record.columnBegin));
+            std::sort(doneKeys.begin(), doneKeys.end());
+            std::vector<std::size_t> pending;
+            for (std::size_t position = 0; position < tiles.size(); ++position)
+            {
+                if (std::binary_search(doneKeys.begin(), doneKeys.end(), key(tiles[position].row, tiles[position].columnBegin))) ++progress.resumed;
+                else pending.push_back(position);
+            }
+            const std::vector<std::size_t> assigned = detail::assignTiles(tiles, pending, ranks, rank);
+
+            /* Rank 0 sizes the output; afterwards every rank writes its own tiles through its own handle, so that it can
+             * sync them to disk on its own before recording them in its checkpoint.
+             */
+            const MPI_Offset outputBytes = static_cast<MPI_Offset>(condensedSize(count) * sizeof(double));
+            if (rank == 0)
+            {
+                MPI_File file;
+                failed = MPI_File_open(MPI_COMM_SELF, output.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS;
+                if (!failed)
+                {
+                    failed = MPI_File_set_size(file, outputBytes) != MPI_SUCCESS;
+                    MPI_File_close(&file);
+                }
+            }
+            MPI_Bcast(&failed, 1, MPI_INT, 0, comm);
+            if (failed) throw std::runtime_error("Could not create " + output + ".");
+
+            try
+            {
+                MPI_File file;
+                detail::check(MPI_File_open(MPI_COMM_SELF, output.c_str(), MPI_MODE_WRONLY, MPI_INFO_NULL, &file), "Could not open " + output + ".");
+                std::unique_ptr<MPI_File, int (*)(MPI_File*)> fileGuard(&file, &MPI_File_close);
+                std::unique_ptr<std::FILE, int (*)(std::FILE*)> checkpoint(nullptr, &std::fclose);
+                if (!options.checkpoint.empty()) checkpoint.reset(detail::openCheckpoint(detail::checkpointPath(options.checkpoint, rank), header));
+
+                std::vector<Frechet::Workspace<T>> workspaces(metric == Metric::Frechet ? threads : 0);
+                std::unordered_map<std::size_t, std::unique_ptr<Hausdorff::PreparedTrajectory<T>>> prepared;
+                std::vector<std::size_t> touched;
+                std::vector<std::vector<double>> results;
+                const std::size_t batch = std::max<std::size_t>(1, options.batch);
+                for (std::size_t first = 0; first < assigned.size(); first += batch)
+                {
+                    const std::size_t last = std::min(assigned.size(), first + batch);
+                    /* Hausdorff packs and shuffles each trajectory of the batch once, and drops them again afterwards */
+                    if (metric == Metric::Hausdorff)
+                    {
+                        touched.clear();
+                        for (std::size_t position = first; position < last; ++position)
+                        {
+                            const DistanceMetrics::detail::PairTile& tile = tiles[assigned[position]];
+                            touched.push_back(tile.row);
+                            for (std::size_t j = tile.columnBegin; j < tile.columnEnd; ++j) touched.push_back(j);
+                        }
+                        std::sort(touched.begin(), touched.end());
+                        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+                        prepared.clear();
+                        for (std::size_t t : touched) prepared[t] = nullptr;
+                        DistanceMetrics::detail::parallelFor(touched.size(), threads, [&](unsigned, std::size_t index)
+                        {
+                            prepared.find(touched[index])->second.reset(new Hausdorff::PreparedTrajectory<T>(trajectories[touched[index]]));
+                        });
+                    }
+
+                    results.resize(last - first);
+                    DistanceMetrics::detail::parallelFor(last - first, threads, [&](unsigned worker, std::size_t index)
+                    {
+                        const DistanceMetrics::detail::PairTile& tile = tiles[assigned[first + index]];
+                        std::vector<double>& values = results[index];
+                        values.resize(tile.columnEnd - tile.columnBegin);
+                        for (std::size_t j = tile.columnBegin; j < tile.columnEnd; ++j)
+                        {
+                            values[j - tile.columnBegin] = (metric == Metric::Hausdorff)
+                                ? symmetricHausdorffDistance(*prepared.find(tile.row)->second, *prepared.find(j)->second)
+                                : static_cast<double>(Frechet::frechetDistance(trajectories[tile.row], trajectories[j], workspaces[worker]));
+                        }
+                    });
+
+                    for (std::size_t position = first; position < last; ++position)
+                    {
+                        const DistanceMetrics::detail::PairTile& tile = tiles[assigned[position]];
+                        const std::vector<double>& values = results[position - first];
+                        const MPI_Offset offset = static_cast<MPI_Offset>(condensedIndex(count, tile.row, tile.columnBegin) * sizeof(double));
+                        detail::check(MPI_File_write_at(file, offset, values.data(), static_cast<int>(values.size()), MPI_DOUBLE, MPI_STATUS_IGNORE),
+                                      "Writing to " + output + " failed.");
+                    }
+                    progress.computed += last - first;
+                    if (checkpoint)
+                    {
+                        /* Only tiles whose results have reached the disk are recorded as done */
+                        detail::check(MPI_File_sync(file), "Syncing " + output + " failed.");
+                        for (std::size_t position = first; position < last; ++position)
+                        {
+                            const DistanceMetrics::detail::PairTile& tile = tiles[assigned[position]];
+                            const detail::CheckpointRecord record { tile.row, tile.columnBegin };
+                            if (std::fwrite(&record, sizeof(record), 1, checkpoint.get()) != 1) throw std::runtime_error("Writing the checkpoint failed.");
+                        }
+                        if (std::fflush(checkpoint.get()) != 0) throw std::runtime_error("Writing the checkpoint failed.");
+                    }
+                }
+            }
+            catch (const std::exception& error)
+            {
+                failed = 1;
+                failure = error.what();
+            }
+            /* No rank returns before every tile is written, and a failure anywhere fails the call everywhere */
+            MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, comm);
+            if (failed) throw std::runtime_error(failure.empty() ? "The distributed pairwise computation failed on another rank." : failure);
+            return progress;
+        }
+
+        /* @brief Computes every pairwise distance of the trajectories of a store across the ranks of comm.
+           @returns This rank's share of the work.
+           @param[in] store The trajectories, opened by every rank from a shared filesystem.
+           @param[in] metric Which distance to compute.
+           @param[in] output Path of the shared output file.
+           @param[in] options Threads, granularity and checkpointing.
+           @param[in] comm The communicator whose ranks share the work.
+        */
+        template <typename T>
+        Progress pairwiseDistancesToFile(const TrajectoryStore<T>& store, Metric metric, const std::string& output,
+                                         const Options& options = Options(), MPI_Comm comm = MPI_COMM_WORLD)
+        {
+            return pairwiseDistancesToFile(store.views(), metric, output, options, comm);
+        }
+    };
+};
+#endif
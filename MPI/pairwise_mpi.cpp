@@ -0,0 +1,144 @@
+/*  MPI pairwise distance driver
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <mpi.h>
+#include "MPI/PairwiseMpi.hpp"
+
+/* Usage: mpirun -n <ranks> pairwise_mpi <store> <output> [options]
+ *
+ *   --metric hausdorff|frechet   Distance to compute (default hausdorff, the symmetric Hausdorff distance)
+ *   --threads N                  Threads per rank (default: every hardware thread)
+ *   --tiles N                    Approximate number of tiles the matrix is cut into (default 65536)
+ *   --batch N                    Tiles per rank between checkpoints (default 64)
+ *   --checkpoint PREFIX          Write PREFIX.rank<r> checkpoints, and resume from any that already exist
+ *
+ * The store is a Common/TrajectoryStore.hpp file of float or double points; the output is the raw condensed matrix.
+ */
+namespace
+{
+    void usage()
+    {
+        std::fprintf(stderr, "usage: pairwise_mpi <store> <output> [--metric hausdorff|frechet] [--threads N] [--tiles N] [--batch N] [--checkpoint PREFIX]\n");
+    }
+
+    /* @brief Element size of a trajectory store, read from its header, or 0 if it cannot be read; the store's own
+     *        constructor then reports the problem on every rank.
+    */
+    std::uint32_t storeScalarSize(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        DistanceMetrics::detail::StoreHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return 0;
+        return header.scalarSize;
+    }
+
+    template <typename T>
+    DistanceMetrics::mpi::Progress run(const std::string& store, DistanceMetrics::Metric metric, const std::string& output,
+                                       const DistanceMetrics::mpi::Options& options)
+    {
+        /* Every rank opens the store itself; if any of them cannot, none may go on to the collective calls */
+        std::unique_ptr<DistanceMetrics::TrajectoryStore<T>> trajectories;
+        std::string failure;
+        try
+        {
+            trajectories.reset(new DistanceMetrics::TrajectoryStore<T>(store));
+        }
+        catch (const std::exception& error)
+        {
+            failure = error.what();
+        }
+        int failed = !trajectories;
+        MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        if (failed) throw std::runtime_error(failure.empty() ? "Another rank could not open " + store + "." : failure);
+        return DistanceMetrics::mpi::pairwiseDistancesToFile(*trajectories, metric, output, options);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    if (argc < 3)
+    {
+        if (rank == 0) usage();
+        MPI_Finalize();
+        return 1;
+    }
+    const std::string store = argv[1], output = argv[2];
+    DistanceMetrics::Metric metric = DistanceMetrics::Metric::Hausdorff;
+    DistanceMetrics::mpi::Options options;
+    for (int arg = 3; arg < argc; ++arg)
+    {
+        const std::string flag = argv[arg];
+        if (arg + 1 >= argc)
+        {
+            if (rank == 0) usage();
+            MPI_Finalize();
+            return 1;
+        }
+        const std::string value = argv[++arg];
+        bool valid = true;
+        try
+        {
+            if (flag == "--metric" && (value == "hausdorff" || value == "frechet"))
+            {
+                metric = (value == "frechet") ? DistanceMetrics::Metric::Frechet : DistanceMetrics::Metric::Hausdorff;
+            }
+            else if (flag == "--threads") options.threads = static_cast<unsigned>(std::stoul(value));
+            else if (flag == "--tiles") options.tiles = std::stoull(value);
+            else if (flag == "--batch") options.batch = std::stoull(value);
+            else if (flag == "--checkpoint") options.checkpoint = value;
+            else valid = false;
+        }
+        catch (const std::exception&)
+        {
+            valid = false;
+        }
+        if (!valid)
+        {
+            if (rank == 0) usage();
+            MPI_Finalize();
+            return 1;
+        }
+    }
+
+    int status = 0;
+    try
+    {
+        /* Every rank reads the same header, so they all take the same branch */
+        const DistanceMetrics::mpi::Progress progress = (storeScalarSize(store) == sizeof(float))
+            ? run<float>(store, metric, output, options)
+            : run<double>(store, metric, output, options);
+        std::printf("rank %d: %zu of %zu tiles computed, %zu resumed from checkpoints\n", rank, progress.computed, progress.tiles, progress.resumed);
+    }
+    catch (const std::exception& error)
+    {
+        std::fprintf(stderr, "rank %d: %s\n", rank, error.what());
+        status = 1;
+    }
+    MPI_Finalize();
+    return status;
+}
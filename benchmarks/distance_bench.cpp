@@ -0,0 +1,169 @@
+/*  Distance metric benchmarks
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "Common/Trajectory.hpp"
+#include "Hausdorff distance/Hausdorff.hpp"
+#include "Frechet_distance/Frechet.hpp"
+
+/* Every benchmark takes the arguments (n, m, dimension, overlap): the two trajectory lengths, the number of coordinates
+ * per point and how much of the second trajectory lies on top of the first, in percent. High overlap makes the
+ * Hausdorff early break fire almost immediately; low overlap lets the Frechet diagonal bound prune more cells.
+ */
+namespace
+{
+    const double pi = std::acos(-1.0);
+
+    /* @brief Smooth pseudo-random curve of n points: every coordinate is a sum of three sinusoids of random phase,
+     *        shifted along the first axis by offset.
+    */
+    template <typename T>
+    DistanceMetrics::Trajectory<T> smoothCurve(std::size_t n, std::size_t dimension, double offset, unsigned seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<double> phase(0.0, 2.0 * pi);
+        DistanceMetrics::Trajectory<T> curve(n, dimension);
+        for (std::size_t k = 0; k < dimension; ++k)
+        {
+            const double p1 = phase(generator), p2 = phase(generator), p3 = phase(generator);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const double s = 2.0 * pi * static_cast<double>(i) / static_cast<double>(n);
+                curve(i, k) = static_cast<T>(0.6 * std::sin(s + p1) + 0.3 * std::sin(3.0 * s + p2) + 0.1 * std::sin(7.0 * s + p3) + (k == 0 ? offset : 0.0));
+            }
+        }
+        return curve;
+    }
+
+    /* @brief One period of a two-body Kepler orbit sampled uniformly in time, in canonical units (mu = 1).
+     *
+     * Dimension 2 gives the planar position, 3 the position and 6 the full state (position and velocity).
+       @param[in] semiMajorAxis Semi-major axis of the orbit.
+       @param[in] eccentricity Eccentricity, in [0, 1).
+       @param[in] inclination Inclination about the x-axis, in radians.
+    */
+    template <typename T>
+    DistanceMetrics::Trajectory<T> keplerOrbit(std::size_t n, std::size_t dimension, double semiMajorAxis, double eccentricity, double inclination)
+    {
+        DistanceMetrics::Trajectory<T> orbit(n, dimension);
+        const double meanMotion = std::sqrt(1.0 / (semiMajorAxis * semiMajorAxis * semiMajorAxis));
+        const double semiMinorAxis = semiMajorAxis * std::sqrt(1.0 - eccentricity * eccentricity);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const double meanAnomaly = 2.0 * pi * static_cast<double>(i) / static_cast<double>(n);
+            double E = meanAnomaly;
+            for (int iteration = 0; iteration < 20; ++iteration) E -= (E - eccentricity * std::sin(E) - meanAnomaly) / (1.0 - eccentricity * std::cos(E));
+            const double rate = meanMotion / (1.0 - eccentricity * std::cos(E));
+            const double state[6] = { semiMajorAxis * (std::cos(E) - eccentricity), semiMinorAxis * std::sin(E), 0.0,
+                                      -semiMajorAxis * std::sin(E) * rate, semiMinorAxis * std::cos(E) * rate, 0.0 };
+            /* Rotate the orbital plane about the x-axis */
+            const double rotated[6] = { state[0], state[1] * std::cos(inclination), state[1] * std::sin(inclination),
+                                        state[3], state[4] * std::cos(inclination), state[4] * std::sin(inclination) };
+            for (std::size_t k = 0; k < dimension; ++k) orbit(i, k) = static_cast<T>(rotated[k]);
+        }
+        return orbit;
+    }
+
+    template <typename T>
+    DistanceMetrics::Trajectory<T> firstCurve(const benchmark::State& state)
+    {
+        return smoothCurve<T>(state.range(0), state.range(2), 0.0, 1);
+    }
+
+    template <typename T>
+    DistanceMetrics::Trajectory<T> secondCurve(const benchmark::State& state)
+    {
+        return smoothCurve<T>(state.range(1), state.range(2), 2.0 * (1.0 - state.range(3) / 100.0), 2);
+    }
+
+    template <typename T>
+    DistanceMetrics::Trajectory<T> firstOrbit(const benchmark::State& state)
+    {
+        return keplerOrbit<T>(state.range(0), state.range(2), 1.0, 0.1, 0.0);
+    }
+
+    /* The second orbit is larger and more inclined as the overlap decreases */
+    template <typename T>
+    DistanceMetrics::Trajectory<T> secondOrbit(const benchmark::State& state)
+    {
+        const double separation = 1.0 - state.range(3) / 100.0;
+        return keplerOrbit<T>(state.range(1), state.range(2), 1.0 + 0.5 * separation, 0.1 + 0.2 * separation, 0.3 * separation);
+    }
+
+    /* @brief Reports throughput as point pairs (n * m) per second. */
+    void setPairCounter(benchmark::State& state)
+    {
+        state.counters["pairs/s"] = benchmark::Counter(static_cast<double>(state.range(0) * state.range(1)), benchmark::Counter::kIsIterationInvariantRate);
+    }
+
+    template <typename T>
+    void BM_Hausdorff(benchmark::State& state)
+    {
+        const DistanceMetrics::Trajectory<T> a = firstCurve<T>(state), b = secondCurve<T>(state);
+        Hausdorff::Workspace<T> workspace(42);
+        for (auto _ : state) benchmark::DoNotOptimize(hausdorffDistance(a.view(), b.view(), workspace));
+        setPairCounter(state);
+    }
+
+    template <typename T>
+    void BM_Frechet(benchmark::State& state)
+    {
+        const DistanceMetrics::Trajectory<T> a = firstCurve<T>(state), b = secondCurve<T>(state);
+        Frechet::Workspace<T> workspace;
+        for (auto _ : state) benchmark::DoNotOptimize(Frechet::frechetDistance(a.view(), b.view(), workspace));
+        setPairCounter(state);
+    }
+
+    template <typename T>
+    void BM_HausdorffOrbit(benchmark::State& state)
+    {
+        const DistanceMetrics::Trajectory<T> a = firstOrbit<T>(state), b = secondOrbit<T>(state);
+        Hausdorff::Workspace<T> workspace(42);
+        for (auto _ : state) benchmark::DoNotOptimize(hausdorffDistance(a.view(), b.view(), workspace));
+        setPairCounter(state);
+    }
+
+    template <typename T>
+    void BM_FrechetOrbit(benchmark::State& state)
+    {
+        const DistanceMetrics::Trajectory<T> a = firstOrbit<T>(state), b = secondOrbit<T>(state);
+        Frechet::Workspace<T> workspace;
+        for (auto _ : state) benchmark::DoNotOptimize(Frechet::frechetDistance(a.view(), b.view(), workspace));
+        setPairCounter(state);
+    }
+
+    void sweep(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->ArgNames({ "n", "m", "dim", "overlap" })
+                 ->ArgsProduct({ { 256, 4096 }, { 256, 4096 }, { 2, 3, 6 }, { 0, 50, 100 } })
+                 ->Unit(benchmark::kMicrosecond);
+    }
+};
+
+BENCHMARK_TEMPLATE(BM_Hausdorff, double)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_Hausdorff, float)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_Frechet, double)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_Frechet, float)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_HausdorffOrbit, double)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_HausdorffOrbit, float)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_FrechetOrbit, double)->Apply(sweep);
+BENCHMARK_TEMPLATE(BM_FrechetOrbit, float)->Apply(sweep);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,183 @@
+/*  Python bindings
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include "Common/Trajectory.hpp"
+#include "Common/Pairwise.hpp"
+#include "Common/Library.hpp"
+#include "Hausdorff distance/Hausdorff.hpp"
+#include "Frechet_distance/Frechet.hpp"
+
+namespace py = pybind11;
+
+/* Trajectories are (points, dimension) NumPy arrays. float64 and float32 arrays are viewed in place through their
+ * strides, so C- and Fortran-ordered arrays and slices are never copied; anything else is converted to float64 first.
+ * The double overloads are registered before the float ones so that such conversions never narrow to float32.
+ * Every binding releases the GIL for the computation itself, so Python threads can run distances concurrently and the
+ * threaded engines use every core.
+ */
+namespace
+{
+    template <typename T>
+    using Array = py::array_t<T, py::array::forcecast>;
+
+    /* @brief Views a two-dimensional NumPy array of points in place, whatever its strides. */
+    template <typename T>
+    DistanceMetrics::TrajectoryView<T> viewOf(const Array<T>& array)
+    {
+        if (array.ndim() != 2)
+        {
+            throw std::runtime_error("Trajectories must be two-dimensional arrays of shape (points, dimension).");
+        }
+        return DistanceMetrics::makeBufferView(array.data(), static_cast<std::size_t>(array.shape(0)), static_cast<std::size_t>(array.shape(1)),
+                                               static_cast<std::ptrdiff_t>(array.strides(0)), static_cast<std::ptrdiff_t>(array.strides(1)));
+    }
+
+    template <typename T>
+    std::vector<DistanceMetrics::TrajectoryView<T>> viewsOf(const std::vector<Array<T>>& arrays)
+    {
+        std::vector<DistanceMetrics::TrajectoryView<T>> views;
+        views.reserve(arrays.size());
+        for (const Array<T>& array : arrays) views.push_back(viewOf(array));
+        return views;
+    }
+
+    /* @brief Runs f with the GIL released. The arrays f reads stay alive, as they are arguments of the calling binding. */
+    template <typename Function>
+    auto withoutGil(Function&& f)
+    {
+        py::gil_scoped_release release;
+        return f();
+    }
+
+    /* @brief Hands a vector to NumPy without copying it; the array owns the vector from then on. */
+    py::array_t<double> toArray(std::vector<double>&& values)
+    {
+        std::vector<double>* owned = new std::vector<double>(std::move(values));
+        py::capsule owner(owned, [](void* pointer) { delete static_cast<std::vector<double>*>(pointer); });
+        return py::array_t<double>(static_cast<py::ssize_t>(owned->size()), owned->data(), owner);
+    }
+
+    /* @brief Registers every function for one element type, and the Library class under libraryName. */
+    template <typename T>
+    void bindPrecision(py::module_& m, const char* libraryName)
+    {
+        m.def("directed_hausdorff", [](const Array<T>& u, const Array<T>& v, std::uint64_t seed)
+        {
+            const DistanceMetrics::TrajectoryView<T> a = viewOf(u), b = viewOf(v);
+            const Hausdorff::Witness witness = withoutGil([&]
+            {
+                Hausdorff::Workspace<T> workspace(seed);
+                return hausdorffWitness(a, b, workspace);
+            });
+            return py::make_tuple(witness.distance, witness.indexA, witness.indexB);
+        }, py::arg("u"), py::arg("v"), py::arg("seed") = 0,
+        "Directed Hausdorff distance from u to v, as the tuple (d, index_u, index_v) of scipy.spatial.distance.directed_hausdorff.");
+
+        m.def("hausdorff_distance", [](const Array<T>& u, const Array<T>& v, std::uint64_t seed)
+        {
+            const DistanceMetrics::TrajectoryView<T> a = viewOf(u), b = viewOf(v);
+            return withoutGil([&]
+            {
+                Hausdorff::Workspace<T> workspace(seed);
+                return hausdorffDistance(a, b, workspace);
+            });
+        }, py::arg("u"), py::arg("v"), py::arg("seed") = 0, "Directed Hausdorff distance from u to v.");
+
+        m.def("symmetric_hausdorff_distance", [](const Array<T>& u, const Array<T>& v, std::uint64_t seed)
+        {
+            const DistanceMetrics::TrajectoryView<T> a = viewOf(u), b = viewOf(v);
+            return withoutGil([&]
+            {
+                Hausdorff::Workspace<T> workspace(seed);
+                return symmetricHausdorffDistance(a, b, workspace);
+            });
+        }, py::arg("u"), py::arg("v"), py::arg("seed") = 0, "Symmetric Hausdorff distance, max(h(u, v), h(v, u)).");
+
+        m.def("frechet_distance", [](const Array<T>& u, const Array<T>& v)
+        {
+            const DistanceMetrics::TrajectoryView<T> a = viewOf(u), b = viewOf(v);
+            return withoutGil([&] { return static_cast<double>(Frechet::frechetDistance(a, b)); });
+        }, py::arg("u"), py::arg("v"), "Discrete Frechet distance between u and v.");
+
+        m.def("frechet_within", [](const Array<T>& u, const Array<T>& v, double eps)
+        {
+            const DistanceMetrics::TrajectoryView<T> a = viewOf(u), b = viewOf(v);
+            return withoutGil([&] { return Frechet::frechetWithin(a, b, eps); });
+        }, py::arg("u"), py::arg("v"), py::arg("eps"), "Whether the discrete Frechet distance between u and v is at most eps.");
+
+        m.def("pairwise_distances", [](const std::vector<Array<T>>& trajectories, DistanceMetrics::Metric metric, unsigned threads)
+        {
+            const std::vector<DistanceMetrics::TrajectoryView<T>> views = viewsOf(trajectories);
+            return toArray(withoutGil([&] { return DistanceMetrics::pairwiseDistances(views, metric, threads); }));
+        }, py::arg("trajectories"), py::arg("metric") = DistanceMetrics::Metric::Hausdorff, py::arg("threads") = 0,
+        "Condensed distance matrix of a list of trajectories, in the layout of scipy.spatial.distance.pdist. "
+        "Hausdorff is the symmetric distance; threads = 0 uses every hardware thread.");
+
+        m.def("nearest_neighbours", [](const Array<T>& query, const std::vector<Array<T>>& references, std::size_t k, DistanceMetrics::Metric metric)
+        {
+            const DistanceMetrics::TrajectoryView<T> q = viewOf(query);
+            const std::vector<DistanceMetrics::TrajectoryView<T>> views = viewsOf(references);
+            return withoutGil([&] { return DistanceMetrics::nearestNeighbours(q, views, k, metric); });
+        }, py::arg("query"), py::arg("references"), py::arg("k"), py::arg("metric") = DistanceMetrics::Metric::Hausdorff,
+        "The k references nearest to query as (index, distance) pairs, nearest first, pruned by lower bounds.");
+
+        using Library = DistanceMetrics::Library<T>;
+        py::class_<Library>(m, libraryName, "Reference trajectories pre-processed once for many one-to-many queries.")
+            .def(py::init([](const std::vector<Array<T>>& references, std::size_t indexThreshold, std::uint64_t seed)
+            {
+                const std::vector<DistanceMetrics::TrajectoryView<T>> views = viewsOf(references);
+                return withoutGil([&] { return new Library(views, indexThreshold, seed); });
+            }), py::arg("references"), py::arg("index_threshold") = 1024, py::arg("seed") = 0)
+            .def("nearest", [](const Library& library, const Array<T>& query, std::size_t k, DistanceMetrics::Metric metric, unsigned threads)
+            {
+                const DistanceMetrics::TrajectoryView<T> q = viewOf(query);
+                return withoutGil([&] { return library.nearest(q, k, metric, threads); });
+            }, py::arg("query"), py::arg("k"), py::arg("metric") = DistanceMetrics::Metric::Hausdorff, py::arg("threads") = 0,
+            "The k references nearest to query as (index, distance) pairs, nearest first.")
+            .def("__len__", &Library::size)
+            .def_property_readonly("dimension", &Library::dimension);
+    }
+};
+
+PYBIND11_MODULE(distance_metrics, m)
+{
+    m.doc() = "Hausdorff and Frechet distances between trajectories, with zero-copy NumPy input.";
+
+    py::enum_<DistanceMetrics::Metric>(m, "Metric")
+        .value("Hausdorff", DistanceMetrics::Metric::Hausdorff)
+        .value("Frechet", DistanceMetrics::Metric::Frechet);
+
+    py::class_<DistanceMetrics::Neighbour>(m, "Neighbour")
+        .def_readonly("index", &DistanceMetrics::Neighbour::index)
+        .def_readonly("distance", &DistanceMetrics::Neighbour::distance)
+        .def("__iter__", [](const DistanceMetrics::Neighbour& neighbour) { return py::iter(py::make_tuple(neighbour.index, neighbour.distance)); })
+        .def("__repr__", [](const DistanceMetrics::Neighbour& neighbour)
+        {
+            return "Neighbour(index=" + std::to_string(neighbour.index) + ", distance=" + std::to_string(neighbour.distance) + ")";
+        });
+
+    bindPrecision<double>(m, "Library");
+    bindPrecision<float>(m, "LibraryFloat32");
+}
@@ -0,0 +1,361 @@
+/*  Brute-force references for the distance metric tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __TEST_REFERENCE_H__
+#define __TEST_REFERENCE_H__
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Common/Trajectory.hpp"
+
+/* Every engine is checked against the textbook O(n * m) definition of its distance, evaluated in double on the same
+ * points. The references favour obviousness over speed; they are only ever run on small random trajectories.
+ */
+namespace Reference
+{
+    /* Dimensions every engine is exercised in: the specialised 2, 3 and 6 and the run-time path for the others */
+    const std::size_t dimensions[] = { 1, 2, 3, 4, 6 };
+
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    /* @brief Records a failed check, printing what was being checked. */
+    inline void check(bool condition, const std::string& what)
+    {
+        if (condition) return;
+        ++failures();
+        if (failures() <= 50) std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+    }
+
+    /* @brief Prints the outcome of a test program. @returns Its exit status. */
+    inline int report(const char* program)
+    {
+        if (failures() == 0) std::printf("%s: all checks passed\n", program);
+        else std::fprintf(stderr, "%s: %d checks failed\n", program, failures());
+        return failures() == 0 ? 0 : 1;
+    }
+
+    /* @brief Whether f throws the std::runtime_error the library reports invalid input with. */
+    template <typename F>
+    bool throws(F&& f)
+    {
+        try
+        {
+            f();
+        }
+        catch (const std::runtime_error&)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    /* @brief Relative tolerance for comparing an engine running in T with a reference running in double. */
+    template <typename T>
+    double tolerance()
+    {
+        return std::is_same<T, float>::value ? 1e-5 : 1e-12;
+    }
+
+    /* @brief Whether actual matches expected to within the tolerance of T, relative to scale. */
+    template <typename T>
+    bool close(double expected, double actual, double scale = 1.0)
+    {
+        if (expected == actual) return true;
+        return std::abs(expected - actual) <= tolerance<T>() * 4 * std::max({ 1.0, std::abs(expected), scale });
+    }
+
+    /* @brief Describes a case for failure messages. */
+    template <typename T>
+    std::string describe(const std::string& what, std::size_t n, std::size_t m, std::size_t dimension)
+    {
+        return what + " (" + (std::is_same<T, float>::value ? "float" : "double") + ", n = " + std::to_string(n) + ", m = " + std::to_string(m) +
+               ", dimension = " + std::to_string(dimension) + ")";
+    }
+
+    /* @brief Checks the contract of the engines taking a cutoff against exact, the same engine's distance without one:
+     *        exactly that distance when it is at most cutoff, otherwise a value strictly greater than cutoff.
+    */
+    template <typename T>
+    void checkCutoff(double expected, double exact, double result, double cutoff, const std::string& what)
+    {
+        check(close<T>(expected, exact), what + ": the distance without a cutoff");
+        if (exact <= cutoff) check(result == exact, what + ": within the cutoff");
+        else check(result > cutoff, what + ": beyond the cutoff");
+    }
+
+    /* @brief Random walk of n points with steps uniform in [-1, 1] per coordinate, started at offset on every axis. */
+    template <typename T>
+    DistanceMetrics::Trajectory<T> randomWalk(std::size_t n, std::size_t dimension, std::mt19937& generator, double offset = 0.0)
+    {
+        std::uniform_real_distribution<double> step(-1.0, 1.0);
+        DistanceMetrics::Trajectory<T> walk(n, dimension);
+        std::vector<double> position(dimension, offset);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t k = 0; k < dimension; ++k)
+            {
+                position[k] += step(generator);
+                walk(i, k) = static_cast<T>(position[k]);
+            }
+        }
+        return walk;
+    }
+
+    /* @brief Number of points of a random trajectory: mostly short, sometimes a single point. */
+    inline std::size_t randomSize(std::mt19937& generator, std::size_t largest = 40)
+    {
+        std::uniform_int_distribution<std::size_t> size(1, largest);
+        return (generator() % 8 == 0) ? 1 : size(generator);
+    }
+
+    /* @brief A pair of random walks of up to largest points each, the second started up to separation off the first
+     *        on every axis.
+    */
+    template <typename T>
+    void randomPair(std::size_t dimension, std::mt19937& generator, DistanceMetrics::Trajectory<T>& a, DistanceMetrics::Trajectory<T>& b,
+                    double separation = 3.0, std::size_t largest = 40)
+    {
+        std::uniform_real_distribution<double> offset(0.0, separation);
+        a = randomWalk<T>(randomSize(generator, largest), dimension, generator);
+        b = randomWalk<T>(randomSize(generator, largest), dimension, generator, offset(generator));
+    }
+
+    template <typename T>
+    std::vector<std::vector<T>> toNested(const DistanceMetrics::TrajectoryView<T>& view)
+    {
+        std::vector<std::vector<T>> nested(view.size(), std::vector<T>(view.dimension()));
+        for (std::size_t i = 0; i < view.size(); ++i)
+        {
+            for (std::size_t k = 0; k < view.dimension(); ++k) nested[i][k] = view(i, k);
+        }
+        return nested;
+    }
+
+    template <std::size_t D, typename T>
+    std::vector<std::array<T, D>> toArrays(const DistanceMetrics::TrajectoryView<T>& view)
+    {
+        std::vector<std::array<T, D>> points(view.size());
+        for (std::size_t i = 0; i < view.size(); ++i)
+        {
+            for (std::size_t k = 0; k < D; ++k) points[i][k] = view(i, k);
+        }
+        return points;
+    }
+
+    /* @brief Euclidean distance between point i of a and point j of b. */
+    template <typename T>
+    double euclidean(const DistanceMetrics::TrajectoryView<T>& a, std::size_t i, const DistanceMetrics::TrajectoryView<T>& b, std::size_t j)
+    {
+        double sum = 0.0;
+        for (std::size_t k = 0; k < a.dimension(); ++k)
+        {
+            const double difference = static_cast<double>(a(i, k)) - static_cast<double>(b(j, k));
+            sum += difference * difference;
+        }
+        return std::sqrt(sum);
+    }
+
+    template <typename T>
+    double squaredEuclidean(const DistanceMetrics::TrajectoryView<T>& a, std::size_t i, const DistanceMetrics::TrajectoryView<T>& b, std::size_t j)
+    {
+        const double distance = euclidean(a, i, b, j);
+        return distance * distance;
+    }
+
+    /* @brief Euclidean distance with coordinate k scaled by the square root of weights[k]. */
+    template <typename T>
+    struct Weighted
+    {
+        double operator()(const DistanceMetrics::TrajectoryView<T>& a, std::size_t i, const DistanceMetrics::TrajectoryView<T>& b, std::size_t j) const
+        {
+            double sum = 0.0;
+            for (std::size_t k = 0; k < a.dimension(); ++k)
+            {
+                const double difference = static_cast<double>(a(i, k)) - static_cast<double>(b(j, k));
+                sum += static_cast<double>(weights[k]) * difference * difference;
+            }
+            return std::sqrt(sum);
+        }
+
+        std::vector<T> weights;
+    };
+
+    /* @brief Minimum-image Euclidean distance; an axis of period 0 is not periodic. */
+    template <typename T>
+    struct Periodic
+    {
+        double operator()(const DistanceMetrics::TrajectoryView<T>& a, std::size_t i, const DistanceMetrics::TrajectoryView<T>& b, std::size_t j) const
+        {
+            double sum = 0.0;
+            for (std::size_t k = 0; k < a.dimension(); ++k)
+            {
+                double difference = std::abs(static_cast<double>(a(i, k)) - static_cast<double>(b(j, k)));
+                const double period = periods[k];
+                if (period > 0)
+                {
+                    difference = std::fmod(difference, period);
+                    difference = std::min(difference, period - difference);
+                }
+                sum += difference * difference;
+            }
+            return std::sqrt(sum);
+        }
+
+        std::vector<T> periods;
+    };
+
+    /* @brief Great-circle distance on the unit sphere between (latitude, longitude) points in radians. */
+    template <typename T>
+    double greatCircle(const DistanceMetrics::TrajectoryView<T>& a, std::size_t i, const DistanceMetrics::TrajectoryView<T>& b, std::size_t j)
+    {
+        const double latitudeA = a(i, 0), latitudeB = b(j, 0);
+        const double sinLatitude = std::sin((latitudeB - latitudeA) / 2);
+        const double sinLongitude = std::sin((static_cast<double>(b(j, 1)) - static_cast<double>(a(i, 1))) / 2);
+        const double h = sinLatitude * sinLatitude + std::cos(latitudeA) * std::cos(latitudeB) * sinLongitude * sinLongitude;
+        return 2 * std::asin(std::sqrt(std::min(1.0, h)));
+    }
+
+    /* @brief A random walk scaled down to small angles, as (latitude, longitude) points away from the antipodes,
+     *        where float loses the great-circle distance.
+    */
+    template <typename T>
+    DistanceMetrics::Trajectory<T> randomAngles(std::size_t n, std::mt19937& generator, double offset = 0.0)
+    {
+        DistanceMetrics::Trajectory<T> angles = randomWalk<T>(n, 2, generator, offset);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t k = 0; k < 2; ++k) angles(i, k) *= T(0.05);
+        }
+        return angles;
+    }
+
+    /* @brief Random weights in [0, 2) and periods in [1, 4), the first axis left non-periodic. */
+    template <typename T>
+    void randomWeightsAndPeriods(std::size_t dimension, std::mt19937& generator, std::vector<T>& weights, std::vector<T>& periods)
+    {
+        std::uniform_real_distribution<double> weight(0.0, 2.0), period(1.0, 4.0);
+        weights.resize(dimension);
+        periods.resize(dimension);
+        for (std::size_t k = 0; k < dimension; ++k)
+        {
+            weights[k] = static_cast<T>(weight(generator));
+            periods[k] = (k == 0) ? T(0) : static_cast<T>(period(generator));
+        }
+    }
+
+    /* @brief max over a of min over b of distance(a, i, b, j). */
+    template <typename T, typename Distance>
+    double directedHausdorff(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, Distance&& distance)
+    {
+        double result = 0.0;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            double nearest = std::numeric_limits<double>::infinity();
+            for (std::size_t j = 0; j < b.size(); ++j) nearest = std::min(nearest, distance(a, i, b, j));
+            result = std::max(result, nearest);
+        }
+        return result;
+    }
+
+    template <typename T>
+    double directedHausdorff(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b)
+    {
+        return directedHausdorff(a, b, euclidean<T>);
+    }
+
+    template <typename T>
+    double symmetricHausdorff(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b)
+    {
+        return std::max(directedHausdorff(a, b), directedHausdorff(b, a));
+    }
+
+    /* @brief The full discrete Frechet matrix; cell (i, j) is the distance between the first i + 1 points of a and
+     *        the first j + 1 points of b.
+    */
+    template <typename T, typename Distance>
+    std::vector<std::vector<double>> frechetMatrix(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, Distance&& distance)
+    {
+        const double infinity = std::numeric_limits<double>::infinity();
+        std::vector<std::vector<double>> matrix(a.size(), std::vector<double>(b.size(), infinity));
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            for (std::size_t j = 0; j < b.size(); ++j)
+            {
+                double previous = (i == 0 && j == 0) ? 0.0 : infinity;
+                if (i > 0) previous = std::min(previous, matrix[i - 1][j]);
+                if (j > 0) previous = std::min(previous, matrix[i][j - 1]);
+                if (i > 0 && j > 0) previous = std::min(previous, matrix[i - 1][j - 1]);
+                matrix[i][j] = std::max(previous, distance(a, i, b, j));
+            }
+        }
+        return matrix;
+    }
+
+    template <typename T, typename Distance>
+    double frechet(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, Distance&& distance)
+    {
+        return frechetMatrix(a, b, distance).back().back();
+    }
+
+    template <typename T>
+    double frechet(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b)
+    {
+        return frechet(a, b, euclidean<T>);
+    }
+
+    /* @brief Discrete Frechet distance over the couplings that stay within band columns of the almost diagonal of
+     *        Devogele et al. (2017), with a the longer trajectory.
+    */
+    template <typename T>
+    double bandedFrechet(const DistanceMetrics::TrajectoryView<T>& a, const DistanceMetrics::TrajectoryView<T>& b, std::size_t band)
+    {
+        const double infinity = std::numeric_limits<double>::infinity();
+        const std::size_t n = a.size(), m = b.size(), q = n / m, r = n % m;
+        auto inside = [&](std::size_t i, std::size_t j)
+        {
+            const std::size_t centre = (i <= r * (q + 1)) ? i / (q + 1) : (i - r) / q;
+            return (j > centre ? j - centre : centre - j) <= band;
+        };
+        std::vector<std::vector<double>> matrix(n, std::vector<double>(m, infinity));
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            for (std::size_t j = 0; j < m; ++j)
+            {
+                if (!inside(i, j)) continue;
+                double previous = (i == 0 && j == 0) ? 0.0 : infinity;
+                if (i > 0) previous = std::min(previous, matrix[i - 1][j]);
+                if (j > 0) previous = std::min(previous, matrix[i][j - 1]);
+                if (i > 0 && j > 0) previous = std::min(previous, matrix[i - 1][j - 1]);
+                matrix[i][j] = std::max(previous, euclidean(a, i, b, j));
+            }
+        }
+        return matrix[n - 1][m - 1];
+    }
+};
+#endif
@@ -0,0 +1,77 @@
+/*  Double-accumulation tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstddef>
+#include <random>
+#include <string>
+#include <type_traits>
+#include "Common/PointDistance.hpp"
+#include "Common/Trajectory.hpp"
+#include "Hausdorff distance/Hausdorff.hpp"
+#include "Frechet_distance/Frechet.hpp"
+#include "Frechet_distance/FrechetWavefront.hpp"
+#include "tests/Reference.hpp"
+
+/* Built with DISTANCE_METRICS_DOUBLE_ACCUMULATION defined, so float trajectories form every difference and sum in
+ * double. Every engine then rounds each squared distance once, from the same double sum, so the tiled wavefront must
+ * agree with the linear engine to the bit.
+ */
+namespace
+{
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+    using Reference::close;
+    using Reference::describe;
+
+    static_assert(std::is_same<DistanceMetrics::AccumulatorType<float>, double>::value, "float must accumulate in double");
+    static_assert(std::is_same<DistanceMetrics::AccumulatorType<double>, double>::value, "double accumulates in itself");
+
+    /* @brief The wavefront for several tilings against the linear engine, and both against the brute force. */
+    void testWavefront(std::mt19937& generator)
+    {
+        const std::size_t tileSizes[] = { 1, 3, 16, 256 };
+        std::uniform_real_distribution<double> offset(0.0, 3.0);
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 20; ++repeat)
+            {
+                /* Far from the origin, so that float sums of squares lose digits unless formed in double */
+                const double origin = 1000.0;
+                const Trajectory<float> a = Reference::randomWalk<float>(Reference::randomSize(generator, (repeat % 5 == 0) ? 300 : 40), dimension, generator, origin);
+                const Trajectory<float> b = Reference::randomWalk<float>(Reference::randomSize(generator), dimension, generator, origin + offset(generator));
+                const TrajectoryView<float> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const float linear = Frechet::frechetDistance(viewA, viewB);
+                check(close<float>(Reference::frechet(viewA, viewB), linear), describe<float>("frechetDistance with double accumulation", n, m, dimension));
+                for (std::size_t tileSize : tileSizes)
+                {
+                    check(Frechet::wavefrontFrechetDistance(viewA, viewB, 2, tileSize) == linear,
+                          describe<float>("wavefrontFrechetDistance with tiles of " + std::to_string(tileSize) + " matches frechetDistance", n, m, dimension));
+                }
+                check(close<float>(Reference::directedHausdorff(viewA, viewB), hausdorffDistance(viewA, viewB)),
+                      describe<float>("hausdorffDistance with double accumulation", n, m, dimension));
+            }
+        }
+    }
+};
+
+int main()
+{
+    std::mt19937 generator(20217);
+    testWavefront(generator);
+    return Reference::report("accumulation_test");
+}
@@ -0,0 +1,601 @@
+/*  Frechet distance tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "Common/Metric.hpp"
+#include "Common/Trajectory.hpp"
+#include "Frechet_distance/Frechet.hpp"
+#include "Frechet_distance/ContinuousFrechet.hpp"
+#include "Frechet_distance/FrechetApprox.hpp"
+#include "Frechet_distance/FrechetWavefront.hpp"
+#include "Frechet_distance/IncrementalFrechet.hpp"
+#include "tests/Reference.hpp"
+
+/* Checks every discrete Frechet engine and the continuous distance against the brute force. */
+namespace
+{
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+    using Reference::close;
+    using Reference::describe;
+    using Reference::randomPair;
+
+    constexpr double separation = 2.0;  // Largest offset of the second walk of a random pair from the first
+
+    /* @brief The distance of row-major views, structure-of-arrays views and nested vectors. */
+    template <typename T>
+    void testViews(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+
+                check(close<T>(expected, Frechet::frechetDistance(viewA, viewB)), describe<T>("frechetDistance of views", n, m, dimension));
+                const std::vector<std::vector<T>> nestedA = Reference::toNested(viewA), nestedB = Reference::toNested(viewB);
+                check(close<T>(expected, Frechet::frechetDistance(nestedA, nestedB)), describe<T>("frechetDistance of vectors", n, m, dimension));
+                const Trajectory<T> columnsA(viewA, DistanceMetrics::Layout::StructureOfArrays), columnsB(viewB, DistanceMetrics::Layout::StructureOfArrays);
+                check(close<T>(expected, Frechet::frechetDistance(columnsA.view(), columnsB.view())), describe<T>("frechetDistance of structure-of-arrays views", n, m, dimension));
+                check(close<T>(expected, Frechet::frechetDistance(columnsA.view(), viewB)), describe<T>("frechetDistance of mixed layouts", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief The std::array overloads, which skip the run-time dimension dispatch. */
+    template <typename T, std::size_t D>
+    void testArrays(std::mt19937& generator)
+    {
+        for (int repeat = 0; repeat < 30; ++repeat)
+        {
+            Trajectory<T> a, b;
+            randomPair(D, generator, a, b, separation);
+            const std::size_t n = a.size(), m = b.size();
+            const double expected = Reference::frechet(a.view(), b.view());
+            check(close<T>(expected, Frechet::frechetDistance(Reference::toArrays<D>(a.view()), Reference::toArrays<D>(b.view()))), describe<T>("frechetDistance of arrays", n, m, D));
+        }
+    }
+
+    /* @brief Both storage modes, and the dense Devogele matrices the full-matrix mode is built on. */
+    template <typename T>
+    void testModes(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+                const std::vector<std::vector<T>> nestedA = Reference::toNested(viewA), nestedB = Reference::toNested(viewB);
+
+                check(close<T>(expected, Frechet::frechetDistance(viewA, viewB, Frechet::Mode::LinearMemory)), describe<T>("frechetDistance with linear memory", n, m, dimension));
+                check(close<T>(expected, Frechet::frechetDistance(viewA, viewB, Frechet::Mode::FullMatrix)), describe<T>("frechetDistance with the full matrix", n, m, dimension));
+                check(close<T>(expected, Frechet::frechetDistance(nestedA, nestedB, Frechet::Mode::FullMatrix)),
+                      describe<T>("frechetDistance of vectors with the full matrix", n, m, dimension));
+
+                std::vector<std::vector<T>> distances, frechet;
+                const double diagonal = Frechet::computeDistanceMatrix(nestedA, nestedB, distances);
+                check(diagonal >= expected * (1 - Reference::tolerance<T>()), describe<T>("computeDistanceMatrix diagonal bound", n, m, dimension));
+                Frechet::computeFrechetMatrix(nestedA, nestedB, frechet);
+                const std::vector<std::vector<double>> prefixes = Reference::frechetMatrix(viewA, viewB, Reference::euclidean<T>);
+                bool shapes = distances.size() == n && frechet.size() == n, cellsMatch = true, prefixesBound = true;
+                for (std::size_t i = 0; i < n && shapes; ++i)
+                {
+                    shapes = distances[i].size() == m && frechet[i].size() == m;
+                    for (std::size_t j = 0; j < m && shapes; ++j)
+                    {
+                        /* Cells outside the region reachable within the diagonal bound hold infinity */
+                        if (!std::isinf(distances[i][j])) cellsMatch = cellsMatch && close<T>(Reference::euclidean(viewA, i, viewB, j), distances[i][j]);
+                        prefixesBound = prefixesBound && frechet[i][j] >= prefixes[i][j] * (1 - Reference::tolerance<T>());
+                    }
+                }
+                check(shapes, describe<T>("dense matrices are n x m", n, m, dimension));
+                check(cellsMatch, describe<T>("computeDistanceMatrix cells are the point distances", n, m, dimension));
+                check(prefixesBound, describe<T>("computeFrechetMatrix cells bound the prefix distances", n, m, dimension));
+                check(shapes && close<T>(expected, frechet[n - 1][m - 1]), describe<T>("computeFrechetMatrix last cell", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief One workspace reused across pairs of every size and dimension, and the arena it is built on. */
+    template <typename T>
+    void testWorkspace(std::mt19937& generator)
+    {
+        Frechet::Workspace<T> workspace;
+        for (int repeat = 0; repeat < 30; ++repeat)
+        {
+            for (std::size_t dimension : Reference::dimensions)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+                check(close<T>(expected, Frechet::frechetDistance(viewA, viewB, workspace)), describe<T>("frechetDistance with a workspace", n, m, dimension));
+                check(close<T>(expected, Frechet::frechetDistance(Reference::toNested(viewA), Reference::toNested(viewB), workspace)),
+                      describe<T>("frechetDistance of vectors reusing a workspace", n, m, dimension));
+            }
+        }
+
+        /* The overloads that take no workspace draw their rows from the thread's own, which keeps its buffer */
+        const Trajectory<T> walkA = Reference::randomWalk<T>(20, 2, generator), walkB = Reference::randomWalk<T>(30, 2, generator, 0.5);
+        const T distance = Frechet::frechetDistance(walkA.view(), walkB.view());
+        check(Frechet::frechetDistance(walkA.view(), walkB.view()) == distance, "frechetDistance repeated on the thread's workspace");
+        const std::size_t capacity = Frechet::detail::threadWorkspace<T>().capacity();
+        check(capacity > 0 && Frechet::frechetDistance(walkA.view(), walkB.view()) == distance && Frechet::detail::threadWorkspace<T>().capacity() == capacity,
+              "frechetDistance reuses the thread's workspace");
+
+        /* Blocks beyond the buffer come from overflow, and the next reset grows the buffer to the high-water mark */
+        Frechet::Workspace<T> arena(8);
+        T* first = arena.allocate(6);
+        T* second = arena.allocate(6);
+        check(arena.capacity() == 8 && first != second, "Workspace serves a request beyond its buffer");
+        arena.reset();
+        check(arena.capacity() == 12 && arena.allocate(12) != nullptr && arena.capacity() == 12, "Workspace grows to its high-water mark on reset");
+    }
+
+    /* @brief The distance is symmetric in its arguments and never reorders the caller's trajectories. */
+    template <typename T>
+    void testArgumentOrder(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+                check(close<T>(expected, Frechet::frechetDistance(viewB, viewA)), describe<T>("frechetDistance of swapped views", m, n, dimension));
+                check(close<T>(expected, Frechet::frechetDistance(viewB, viewA, Frechet::Mode::FullMatrix)), describe<T>("frechetDistance of swapped views with the full matrix", m, n, dimension));
+
+                std::vector<std::vector<T>> nestedA = Reference::toNested(viewA), nestedB = Reference::toNested(viewB);
+                const std::vector<std::vector<T>> originalA = nestedA, originalB = nestedB;
+                Frechet::frechetDistance(nestedA, nestedB);
+                Frechet::frechetDistance(nestedA, nestedB, Frechet::Mode::FullMatrix);
+                Frechet::frechetDistance(nestedB, nestedA, Frechet::Mode::FullMatrix);
+                check(nestedA == originalA && nestedB == originalB, describe<T>("frechetDistance leaves the caller's vectors in place", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief The decision procedure accepts the engine's own distance and rejects the next value below it. */
+    template <typename T>
+    void testWithin(std::mt19937& generator)
+    {
+        Frechet::Workspace<T> workspace;
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const std::vector<std::vector<T>> nestedA = Reference::toNested(viewA), nestedB = Reference::toNested(viewB);
+                const T distance = Frechet::frechetDistance(viewA, viewB, workspace);
+                check(Frechet::frechetWithin(viewA, viewB, distance), describe<T>("frechetWithin at the distance", n, m, dimension));
+                check(Frechet::frechetWithin(viewB, viewA, distance, workspace), describe<T>("frechetWithin of swapped views at the distance", m, n, dimension));
+                check(Frechet::frechetWithin(nestedA, nestedB, distance), describe<T>("frechetWithin of vectors at the distance", n, m, dimension));
+                check(Frechet::frechetWithin(viewA, viewB, 2 * distance + 1), describe<T>("frechetWithin well above the distance", n, m, dimension));
+                /* The threshold is a double whatever T is, and for float this one is usually not representable */
+                const double above = std::nextafter(static_cast<double>(distance), std::numeric_limits<double>::infinity());
+                check(Frechet::frechetWithin(viewA, viewB, above, workspace), describe<T>("frechetWithin just above the distance", n, m, dimension));
+                if (distance > 0)
+                {
+                    const T below = std::nextafter(distance, T(0));
+                    check(!Frechet::frechetWithin(viewA, viewB, below, workspace), describe<T>("frechetWithin just below the distance", n, m, dimension));
+                    check(!Frechet::frechetWithin(nestedA, nestedB, distance / 2), describe<T>("frechetWithin of vectors below the distance", n, m, dimension));
+                }
+            }
+        }
+    }
+
+    /* @brief The cutoff contract, for cutoffs on both sides of the distance. */
+    template <typename T>
+    void testCutoffs(std::mt19937& generator)
+    {
+        const double fractions[] = { 0.0, 0.5, 0.9, 1.0, 1.1, 2.0 };
+        Frechet::Workspace<T> workspace;
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+                const double exact = Frechet::frechetDistance(viewA, viewB, workspace), swapped = Frechet::frechetDistance(viewB, viewA);
+                for (double fraction : fractions)
+                {
+                    /* The cutoff is a double whatever T is, and for float it is usually not representable */
+                    const double cutoff = fraction * expected;
+                    Reference::checkCutoff<T>(expected, exact, Frechet::frechetDistance(viewA, viewB, cutoff, workspace), cutoff,
+                                              describe<T>("frechetDistance with a cutoff", n, m, dimension));
+                    Reference::checkCutoff<T>(expected, swapped, Frechet::frechetDistance(viewB, viewA, cutoff), cutoff,
+                                              describe<T>("frechetDistance of swapped views with a cutoff", m, n, dimension));
+                }
+                /* A cutoff equal to the engine's own result must give that result back exactly */
+                const T distance = Frechet::frechetDistance(viewA, viewB, workspace);
+                check(Frechet::frechetDistance(viewA, viewB, distance, workspace) == distance, describe<T>("frechetDistance with its own distance as the cutoff", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief Simplified trajectories stay within their error, approximations within their bound, and coarse-to-fine is exact. */
+    template <typename T>
+    void testApproximation(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 20; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation, 80);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+                /* The tolerances are doubles whatever T is, and for float 0.05 is not representable */
+                const double tolerances[] = { 0.05, 0.5, 2.0 };
+                for (double tolerance : tolerances)
+                {
+                    const double slack = Reference::tolerance<T>() * 4 * std::max(1.0, expected);
+                    Trajectory<T> simplified;
+                    const T error = Frechet::simplify(viewA, tolerance, simplified);
+                    check(simplified.size() >= 1 && simplified.size() <= n && error <= DistanceMetrics::detail::roundedUp<T>(tolerance), describe<T>("simplify keeps its error within the tolerance", n, simplified.size(), dimension));
+                    check(Reference::frechet(viewA, simplified.view()) <= error + slack, describe<T>("simplify stays within its error", n, simplified.size(), dimension));
+
+                    const Frechet::Approximation<T> approximation = Frechet::approximateFrechetDistance(viewA, viewB, tolerance);
+                    check(std::abs(approximation.value - expected) <= approximation.errorBound + slack, describe<T>("approximateFrechetDistance within its error bound", n, m, dimension));
+                    check(approximation.errorBound <= 2 * tolerance + slack, describe<T>("approximateFrechetDistance error bound", n, m, dimension));
+                    check(close<T>(expected, Frechet::coarseToFineFrechetDistance(viewA, viewB, tolerance)), describe<T>("coarseToFineFrechetDistance", n, m, dimension));
+                }
+            }
+        }
+    }
+
+    /* @brief Bands of every width against the banded brute force, which they must also bound the exact distance by. */
+    template <typename T>
+    void testBands(std::mt19937& generator)
+    {
+        Frechet::Workspace<T> workspace;
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+                const TrajectoryView<T> longer = (n < m) ? viewB : viewA, shorter = (n < m) ? viewA : viewB;
+
+                const std::size_t bands[] = { 0, 1, 2, 5, std::max(n, m) };
+                for (std::size_t band : bands)
+                {
+                    const std::string width = " with a band of " + std::to_string(band);
+                    const double banded = Frechet::bandedFrechetDistance(viewA, viewB, band);
+                    check(close<T>(Reference::bandedFrechet(longer, shorter, band), banded), describe<T>("bandedFrechetDistance" + width, n, m, dimension));
+                    check(banded >= expected * (1 - Reference::tolerance<T>()), describe<T>("bandedFrechetDistance is an upper bound" + width, n, m, dimension));
+                    if (band >= std::min(n, m)) check(close<T>(expected, banded), describe<T>("bandedFrechetDistance with a full band", n, m, dimension));
+                    check(Frechet::bandedFrechetDistance(viewB, viewA, band, workspace) == banded, describe<T>("bandedFrechetDistance of swapped views" + width, m, n, dimension));
+                    check(Frechet::bandedFrechetDistance(Reference::toNested(viewA), Reference::toNested(viewB), band) == banded,
+                          describe<T>("bandedFrechetDistance of vectors" + width, n, m, dimension));
+                }
+            }
+        }
+    }
+
+    /* @brief The tiled wavefront for tiles from one cell to larger than the matrix, on one thread and several. */
+    template <typename T>
+    void testWavefront(std::mt19937& generator)
+    {
+        const unsigned threadCounts[] = { 1, 3 };
+        const std::size_t tileSizes[] = { 1, 3, 16, 256 };
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 20; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation, (repeat % 5 == 0) ? 300 : 40);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+                for (unsigned threads : threadCounts)
+                {
+                    for (std::size_t tileSize : tileSizes)
+                    {
+                        const std::string tiling = " with " + std::to_string(threads) + " threads and tiles of " + std::to_string(tileSize);
+                        check(close<T>(expected, Frechet::wavefrontFrechetDistance(viewA, viewB, threads, tileSize)), describe<T>("wavefrontFrechetDistance" + tiling, n, m, dimension));
+                    }
+                }
+                check(close<T>(expected, Frechet::wavefrontFrechetDistance(viewB, viewA)), describe<T>("wavefrontFrechetDistance of swapped views", m, n, dimension));
+            }
+        }
+    }
+
+    /* @brief The sparse Devogele matrices hold the point distances and bound the prefix distances over their spans. */
+    template <typename T>
+    void testSparseMatrices(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double expected = Reference::frechet(viewA, viewB);
+                const std::vector<std::vector<double>> prefixes = Reference::frechetMatrix(viewA, viewB, Reference::euclidean<T>);
+
+                Frechet::SparseMatrix<T> distances, frechet;
+                const double diagonal = Frechet::computeDistanceMatrix(viewA, viewB, distances);
+                check(diagonal >= expected * (1 - Reference::tolerance<T>()), describe<T>("computeDistanceMatrix diagonal bound", n, m, dimension));
+                Frechet::computeFrechetMatrix(viewA, viewB, frechet);
+                check(distances.rows() == n && frechet.rows() == n, describe<T>("sparse matrices have a row per point", n, m, dimension));
+                bool cellsMatch = true, prefixesBound = true, spansValid = true;
+                for (std::size_t i = 0; i < distances.rows(); ++i)
+                {
+                    spansValid = spansValid && distances.rowBegin(i) <= distances.rowEnd(i) && distances.rowEnd(i) <= m;
+                    for (std::size_t j = distances.rowBegin(i); j < distances.rowEnd(i); ++j)
+                    {
+                        if (distances.contains(i, j)) cellsMatch = cellsMatch && close<T>(Reference::euclidean(viewA, i, viewB, j), distances(i, j));
+                    }
+                }
+                for (std::size_t i = 0; i < frechet.rows(); ++i)
+                {
+                    for (std::size_t j = frechet.rowBegin(i); j < frechet.rowEnd(i); ++j)
+                    {
+                        if (frechet.contains(i, j)) prefixesBound = prefixesBound && frechet(i, j) >= prefixes[i][j] * (1 - Reference::tolerance<T>());
+                    }
+                }
+                check(spansValid, describe<T>("computeDistanceMatrix spans lie within the columns", n, m, dimension));
+                check(cellsMatch, describe<T>("computeDistanceMatrix cells are the point distances", n, m, dimension));
+                check(prefixesBound, describe<T>("computeFrechetMatrix cells bound the prefix distances", n, m, dimension));
+                check(close<T>(expected, frechet(n - 1, m - 1)), describe<T>("computeFrechetMatrix last cell", n, m, dimension));
+
+                std::vector<std::vector<T>> dense;
+                Frechet::computeFrechetMatrix(Reference::toNested(viewA), Reference::toNested(viewB), dense);
+                check(dense.size() == n && close<T>(expected, dense[n - 1][m - 1]), describe<T>("dense computeFrechetMatrix last cell", n, m, dimension));
+
+                // Identical points are at distance zero, which must not read as a cell that was never computed
+                Frechet::computeFrechetMatrix(viewA, viewA, frechet);
+                check(frechet.contains(n - 1, n - 1) && frechet(n - 1, n - 1) == 0, describe<T>("computeFrechetMatrix of a trajectory with itself", n, n, dimension));
+            }
+        }
+    }
+
+    /* @brief A trajectory grown one point at a time against the brute force of every prefix. */
+    template <typename T>
+    void testIncremental(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 10; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const std::size_t n = a.size(), m = b.size();
+                const double final = Reference::frechet(a.view(), b.view());
+                const T eps = static_cast<T>(final * 0.8);
+                Frechet::IncrementalFrechet<T> incremental(b.view());
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    incremental.append(a.view().point(i));
+                    const std::vector<std::vector<double>> prefixes = Reference::frechetMatrix(a.view().subView(0, i + 1), b.view(), Reference::euclidean<T>);
+                    check(close<T>(prefixes[i][m - 1], incremental.distance()), describe<T>("IncrementalFrechet distance", i + 1, m, dimension));
+                    const std::vector<T> frontier = incremental.frontier();
+                    bool frontierMatches = frontier.size() == m;
+                    for (std::size_t j = 0; j < m && frontierMatches; ++j) frontierMatches = close<T>(prefixes[i][j], frontier[j]);
+                    check(frontierMatches, describe<T>("IncrementalFrechet frontier", i + 1, m, dimension));
+                    check(incremental.frontierMinimum() <= final * (1 + Reference::tolerance<T>()), describe<T>("IncrementalFrechet frontier minimum is a lower bound", i + 1, m, dimension));
+                    if (incremental.alreadyExceeds(eps)) check(final > eps, describe<T>("IncrementalFrechet alreadyExceeds", i + 1, m, dimension));
+                }
+                check(close<T>(final, incremental.distance()), describe<T>("IncrementalFrechet of the whole trajectory", n, m, dimension));
+                incremental.reset();
+                incremental.append(a.view());
+                check(close<T>(final, incremental.distance()) && incremental.size() == n, describe<T>("IncrementalFrechet after reset", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief Every segment of l cut into pieces equal parts, in double. */
+    template <typename T>
+    Trajectory<double> upsample(const TrajectoryView<T>& l, std::size_t pieces, double& longestPiece)
+    {
+        Trajectory<double> dense((l.size() - 1) * pieces + 1, l.dimension());
+        for (std::size_t i = 0; i + 1 < l.size(); ++i)
+        {
+            longestPiece = std::max(longestPiece, Reference::euclidean(l, i, l, i + 1) / pieces);
+            for (std::size_t p = 0; p < pieces; ++p)
+            {
+                const double t = static_cast<double>(p) / pieces;
+                for (std::size_t k = 0; k < l.dimension(); ++k) dense(i * pieces + p, k) = (1 - t) * l(i, k) + t * l(i + 1, k);
+            }
+        }
+        for (std::size_t k = 0; k < l.dimension(); ++k) dense(dense.size() - 1, k) = l(l.size() - 1, k);
+        return dense;
+    }
+
+    /* @brief The continuous distance lies between the endpoint distances and the discrete distance, and matches the
+     *        discrete distance of finely upsampled curves to within the sampling step (Eiter and Mannila, 1994).
+    */
+    template <typename T>
+    void testContinuous(std::mt19937& generator)
+    {
+        const std::size_t pieces = 24;
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 15; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation, 8);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double discrete = Reference::frechet(viewA, viewB);
+                const double endpoints = std::max(Reference::euclidean(viewA, 0, viewB, 0), Reference::euclidean(viewA, n - 1, viewB, m - 1));
+                const double continuous = Frechet::continuousFrechetDistance(viewA, viewB);
+                const double slack = Reference::tolerance<T>() * 4 * std::max(1.0, discrete);
+                check(continuous >= endpoints - slack && continuous <= discrete + slack, describe<T>("continuousFrechetDistance between its bounds", n, m, dimension));
+                check(close<T>(continuous, Frechet::continuousFrechetDistance(Reference::toNested(viewA), Reference::toNested(viewB))),
+                      describe<T>("continuousFrechetDistance of vectors", n, m, dimension));
+
+                double longestPiece = 0.0;
+                const Trajectory<double> denseA = upsample(viewA, pieces, longestPiece), denseB = upsample(viewB, pieces, longestPiece);
+                const double sampled = Reference::frechet(denseA.view(), denseB.view());
+                /* The default bisection tolerance is the square root of machine epsilon relative to the discrete distance */
+                const double bisection = discrete * std::sqrt(std::numeric_limits<T>::epsilon());
+                check(continuous <= sampled + bisection + slack, describe<T>("continuousFrechetDistance at most the upsampled distance", n, m, dimension));
+                check(sampled <= continuous + longestPiece + slack, describe<T>("continuousFrechetDistance within a sampling step", n, m, dimension));
+
+                check(Frechet::continuousFrechetWithin(viewA, viewB, continuous), describe<T>("continuousFrechetWithin at the distance", n, m, dimension));
+                if (endpoints > 0)
+                {
+                    check(!Frechet::continuousFrechetWithin(viewA, viewB, endpoints * 0.999), describe<T>("continuousFrechetWithin below the endpoints", n, m, dimension));
+                }
+            }
+        }
+    }
+
+    /* @brief Every metric policy against the brute force with the policy's own point distance. */
+    template <typename T>
+    void testMetrics(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 10; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, separation);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+
+                check(close<T>(Reference::frechet(viewA, viewB, Reference::squaredEuclidean<T>), Frechet::frechetDistance(viewA, viewB, DistanceMetrics::metrics::SquaredEuclidean<T>())),
+                      describe<T>("frechetDistance with SquaredEuclidean", n, m, dimension));
+
+                Reference::Weighted<T> weighted;
+                Reference::Periodic<T> periodic;
+                Reference::randomWeightsAndPeriods(dimension, generator, weighted.weights, periodic.periods);
+                const DistanceMetrics::metrics::WeightedEuclidean<T> weightedMetric(weighted.weights);
+                const T weightedDistance = Frechet::frechetDistance(viewA, viewB, weightedMetric);
+                check(close<T>(Reference::frechet(viewA, viewB, weighted), weightedDistance), describe<T>("frechetDistance with WeightedEuclidean", n, m, dimension));
+                check(Frechet::frechetWithin(viewA, viewB, weightedDistance, weightedMetric), describe<T>("frechetWithin with WeightedEuclidean at the distance", n, m, dimension));
+                const DistanceMetrics::metrics::Periodic<T> periodicMetric(periodic.periods);
+                check(close<T>(Reference::frechet(viewA, viewB, periodic), Frechet::frechetDistance(viewA, viewB, periodicMetric)),
+                      describe<T>("frechetDistance with Periodic", n, m, dimension));
+
+                if (dimension == 2)
+                {
+                    const Trajectory<T> anglesA = Reference::randomAngles<T>(n, generator), anglesB = Reference::randomAngles<T>(m, generator, 1.0);
+                    const DistanceMetrics::metrics::GreatCircle<T> sphere;
+                    const T greatCircleDistance = Frechet::frechetDistance(anglesA.view(), anglesB.view(), sphere);
+                    check(close<T>(Reference::frechet(anglesA.view(), anglesB.view(), Reference::greatCircle<T>), greatCircleDistance),
+                          describe<T>("frechetDistance with GreatCircle", n, m, dimension));
+                    check(Frechet::frechetWithin(anglesA.view(), anglesB.view(), greatCircleDistance, sphere), describe<T>("frechetWithin with GreatCircle at the distance", n, m, dimension));
+                }
+            }
+        }
+    }
+
+    /* @brief Inputs every entry point must reject. */
+    template <typename T>
+    void testInvalidInputs(std::mt19937& generator)
+    {
+        const Trajectory<T> plane = Reference::randomWalk<T>(5, 2, generator), space = Reference::randomWalk<T>(5, 3, generator), none(3);
+        const TrajectoryView<T> a = plane.view(), b = space.view();
+        const std::string what = describe<T>("rejects trajectories of different dimensions", 5, 5, 2);
+        check(Reference::throws([&] { Frechet::frechetDistance(a, b); }), "frechetDistance " + what);
+        check(Reference::throws([&] { Frechet::frechetDistance(Reference::toNested(a), Reference::toNested(b)); }), "frechetDistance of vectors " + what);
+        check(Reference::throws([&] { Frechet::frechetDistance(a, b, Frechet::Mode::FullMatrix); }), "frechetDistance with the full matrix " + what);
+        check(Reference::throws([&] { Frechet::frechetWithin(a, b, T(1)); }), "frechetWithin " + what);
+        check(Reference::throws([&] { Frechet::frechetDistance(a, b, T(1)); }), "frechetDistance with a cutoff " + what);
+        check(Reference::throws([&] { Frechet::approximateFrechetDistance(a, b, T(0.1)); }), "approximateFrechetDistance " + what);
+        check(Reference::throws([&] { Frechet::bandedFrechetDistance(a, b, 2); }), "bandedFrechetDistance " + what);
+        check(Reference::throws([&] { Frechet::wavefrontFrechetDistance(a, b, 1); }), "wavefrontFrechetDistance " + what);
+        check(Reference::throws([&] { Frechet::SparseMatrix<T> matrix; Frechet::computeDistanceMatrix(a, b, matrix); }), "computeDistanceMatrix " + what);
+        check(Reference::throws([&] { Frechet::continuousFrechetDistance(a, b); }), "continuousFrechetDistance " + what);
+        check(Reference::throws([&] { Frechet::IncrementalFrechet<T> incremental(a); incremental.append(b); }), describe<T>("IncrementalFrechet rejects points of another dimension", 5, 5, 2));
+        check(Reference::throws([&] { Frechet::IncrementalFrechet<T> incremental(a); incremental.distance(); }), describe<T>("IncrementalFrechet has no distance before an append", 0, 5, 2));
+        check(Reference::throws([&] { Frechet::IncrementalFrechet<T> incremental(none.view()); }), describe<T>("IncrementalFrechet rejects an empty reference", 0, 0, 3));
+        check(Reference::throws([&] { Frechet::frechetDistance(b, b, DistanceMetrics::metrics::Periodic<T>(std::vector<T>(2, T(1)))); }),
+              describe<T>("frechetDistance with a period per coordinate missing throws", 5, 5, 3));
+        check(Reference::throws([&] { Frechet::frechetWithin(b, b, T(1), DistanceMetrics::metrics::GreatCircle<T>()); }),
+              describe<T>("frechetWithin with GreatCircle in three dimensions throws", 5, 5, 3));
+        check(Reference::throws([&] { Frechet::frechetDistance(b, none.view()); }), describe<T>("frechetDistance rejects an empty trajectory", 5, 0, 3));
+    }
+};
+
+int main()
+{
+    std::mt19937 generator(20212);
+    testViews<float>(generator);
+    testViews<double>(generator);
+    testArrays<float, 1>(generator);
+    testArrays<double, 1>(generator);
+    testArrays<float, 2>(generator);
+    testArrays<double, 2>(generator);
+    testArrays<float, 3>(generator);
+    testArrays<double, 3>(generator);
+    testArrays<float, 4>(generator);
+    testArrays<double, 4>(generator);
+    testArrays<float, 6>(generator);
+    testArrays<double, 6>(generator);
+    testModes<float>(generator);
+    testModes<double>(generator);
+    testWorkspace<float>(generator);
+    testWorkspace<double>(generator);
+    testArgumentOrder<float>(generator);
+    testArgumentOrder<double>(generator);
+    testWithin<float>(generator);
+    testWithin<double>(generator);
+    testCutoffs<float>(generator);
+    testCutoffs<double>(generator);
+    testApproximation<float>(generator);
+    testApproximation<double>(generator);
+    testBands<float>(generator);
+    testBands<double>(generator);
+    testWavefront<float>(generator);
+    testWavefront<double>(generator);
+    testSparseMatrices<float>(generator);
+    testSparseMatrices<double>(generator);
+    testIncremental<float>(generator);
+    testIncremental<double>(generator);
+    testContinuous<float>(generator);
+    testContinuous<double>(generator);
+    testMetrics<float>(generator);
+    testMetrics<double>(generator);
+    testInvalidInputs<float>(generator);
+    testInvalidInputs<double>(generator);
+    return Reference::report("frechet_test");
+}
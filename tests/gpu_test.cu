@@ -0,0 +1,81 @@
+/*  CUDA pairwise distance tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <cuda_runtime.h>
+#include "Common/Trajectory.hpp"
+#include "Common/Pairwise.hpp"
+#include "GPU/PairwiseGpu.cuh"
+#include "tests/Reference.hpp"
+
+/* Checks gpu::pairwiseDistances against the CPU pairwiseDistances for both metrics, with chunks small enough that
+ * several launches are needed. Exits with 77, which ctest reports as skipped, when there is no CUDA device.
+ */
+namespace
+{
+    using DistanceMetrics::Metric;
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+
+    template <typename T>
+    void testPairwise(std::mt19937& generator)
+    {
+        const std::size_t pairsPerLaunch[] = { 1, 7, 1 << 16 };
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            const std::size_t count = 2 + generator() % 12;
+            std::vector<Trajectory<T>> set;
+            std::uniform_real_distribution<double> offset(0.0, 3.0);
+            /* Some trajectories longer than a block, so that the wavefronts and the query loops wrap */
+            for (std::size_t t = 0; t < count; ++t) set.push_back(Reference::randomWalk<T>(Reference::randomSize(generator, (t % 4 == 0) ? 600 : 40), dimension, generator, offset(generator)));
+            std::vector<TrajectoryView<T>> views;
+            for (const Trajectory<T>& trajectory : set) views.push_back(trajectory.view());
+            const DistanceMetrics::TrajectoryBatch<T> batch(views);
+
+            for (Metric metric : { Metric::Hausdorff, Metric::Frechet })
+            {
+                const std::vector<double> expected = DistanceMetrics::pairwiseDistances(views, metric, 2);
+                for (std::size_t pairs : pairsPerLaunch)
+                {
+                    const std::vector<double> result = DistanceMetrics::gpu::pairwiseDistances(batch, metric, 0, pairs);
+                    bool matches = result.size() == expected.size();
+                    for (std::size_t index = 0; index < result.size() && matches; ++index) matches = Reference::close<T>(expected[index], result[index]);
+                    check(matches, Reference::describe<T>(std::string("gpu::pairwiseDistances ") + (metric == Metric::Frechet ? "Frechet" : "Hausdorff") +
+                                                          " with " + std::to_string(pairs) + " pairs per launch", count, count, dimension));
+                }
+            }
+        }
+    }
+};
+
+int main()
+{
+    int devices = 0;
+    if (cudaGetDeviceCount(&devices) != cudaSuccess || devices == 0)
+    {
+        std::printf("gpu_test: no CUDA device, skipped\n");
+        return 77;
+    }
+    std::mt19937 generator(20218);
+    testPairwise<float>(generator);
+    testPairwise<double>(generator);
+    return Reference::report("gpu_test");
+}
@@ -0,0 +1,488 @@
+/*  Hausdorff distance tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Common/Metric.hpp"
+#include "Common/Trajectory.hpp"
+#include "Hausdorff distance/Hausdorff.hpp"
+#include "Hausdorff distance/HausdorffIndex.hpp"
+#include "Hausdorff distance/IncrementalHausdorff.hpp"
+#include "tests/Reference.hpp"
+
+/* Checks every Hausdorff engine against the brute-force definition. */
+namespace
+{
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+    using Reference::close;
+    using Reference::describe;
+    using Reference::randomPair;
+
+    std::vector<int> randomPermutation(std::size_t size, std::mt19937& generator)
+    {
+        std::vector<int> permutation(size);
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::shuffle(permutation.begin(), permutation.end(), generator);
+        return permutation;
+    }
+
+    /* @brief The directed distance of row-major views, structure-of-arrays views and nested vectors. */
+    template <typename T>
+    void testViews(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double directed = Reference::directedHausdorff(viewA, viewB);
+
+                check(close<T>(directed, hausdorffDistance(viewA, viewB)), describe<T>("hausdorffDistance of views", n, m, dimension));
+                const std::vector<std::vector<T>> nestedA = Reference::toNested(viewA), nestedB = Reference::toNested(viewB);
+                check(close<T>(directed, hausdorffDistance(nestedA, nestedB)), describe<T>("hausdorffDistance of vectors", n, m, dimension));
+                const Trajectory<T> columnsA(viewA, DistanceMetrics::Layout::StructureOfArrays), columnsB(viewB, DistanceMetrics::Layout::StructureOfArrays);
+                check(close<T>(directed, hausdorffDistance(columnsA.view(), columnsB.view())), describe<T>("hausdorffDistance of structure-of-arrays views", n, m, dimension));
+                check(close<T>(directed, hausdorffDistance(viewA, columnsB.view())), describe<T>("hausdorffDistance of mixed layouts", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief The single-pass symmetric distance through every overload taking plain point sets. */
+    template <typename T>
+    void testSymmetric(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double symmetric = Reference::symmetricHausdorff(viewA, viewB);
+
+                check(close<T>(symmetric, symmetricHausdorffDistance(viewA, viewB)), describe<T>("symmetricHausdorffDistance of views", n, m, dimension));
+                check(close<T>(symmetric, symmetricHausdorffDistance(viewB, viewA)), describe<T>("symmetricHausdorffDistance of swapped views", m, n, dimension));
+                check(close<T>(symmetric, symmetricHausdorffDistance(Reference::toNested(viewA), Reference::toNested(viewB))),
+                      describe<T>("symmetricHausdorffDistance of vectors", n, m, dimension));
+                const Trajectory<T> columnsA(viewA, DistanceMetrics::Layout::StructureOfArrays), columnsB(viewB, DistanceMetrics::Layout::StructureOfArrays);
+                check(close<T>(symmetric, symmetricHausdorffDistance(columnsA.view(), columnsB.view())),
+                      describe<T>("symmetricHausdorffDistance of structure-of-arrays views", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief One caller-owned workspace reused across pairs of every size and dimension. */
+    template <typename T>
+    void testWorkspace(std::mt19937& generator)
+    {
+        Hausdorff::Workspace<T> workspace;
+        for (int repeat = 0; repeat < 30; ++repeat)
+        {
+            for (std::size_t dimension : Reference::dimensions)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double directed = Reference::directedHausdorff(viewA, viewB);
+                check(close<T>(directed, hausdorffDistance(viewA, viewB, workspace)), describe<T>("hausdorffDistance with a workspace", n, m, dimension));
+                check(close<T>(Reference::directedHausdorff(viewB, viewA), hausdorffDistance(viewB, viewA, workspace)),
+                      describe<T>("hausdorffDistance reusing a workspace", m, n, dimension));
+                check(close<T>(directed, hausdorffDistance(Reference::toNested(viewA), Reference::toNested(viewB), workspace)),
+                      describe<T>("hausdorffDistance of vectors with a workspace", n, m, dimension));
+
+                /* The directed engines read their queries in place and pack only the targets */
+                Hausdorff::Workspace<T> fresh;
+                hausdorffDistance(viewA, viewB, fresh);
+                hausdorffDistance(viewA, viewB, std::numeric_limits<T>::infinity(), fresh);
+                hausdorffWitness(viewA, viewB, fresh);
+                hausdorffDistance(viewA, viewB, DistanceMetrics::metrics::WeightedEuclidean<T>(std::vector<T>(dimension, T(2))), fresh);
+                check(fresh.packedA.empty() && fresh.packedB.size() == m * dimension && fresh.indicesA.size() == n,
+                      describe<T>("directed hausdorffDistance packs only the target set", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief Caller permutations, seeded workspaces and prepared trajectories: every order gives the brute-force
+     *        distance, and the same seed gives the same bits.
+    */
+    template <typename T>
+    void testPermutations(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double directed = Reference::directedHausdorff(viewA, viewB);
+                const double symmetric = Reference::symmetricHausdorff(viewA, viewB);
+
+                const std::vector<int> permutationA = randomPermutation(n, generator), permutationB = randomPermutation(m, generator);
+                check(close<T>(directed, hausdorffDistance(viewA, viewB, permutationA, permutationB)), describe<T>("hausdorffDistance with permutations", n, m, dimension));
+
+                const std::uint64_t seed = generator();
+                Hausdorff::Workspace<T> first(seed), second(seed);
+                bool reproducible = true;
+                for (int call = 0; call < 3; ++call) reproducible = reproducible && hausdorffDistance(viewA, viewB, first) == hausdorffDistance(viewA, viewB, second);
+                check(reproducible, describe<T>("hausdorffDistance with equally seeded workspaces", n, m, dimension));
+
+                const Hausdorff::PreparedTrajectory<T> preparedA(viewA, seed), preparedB(viewB, seed + 1);
+                check(preparedA.size() == n && preparedA.dimension() == dimension && preparedA.permutation() == Hausdorff::PreparedTrajectory<T>(viewA, seed).permutation(),
+                      describe<T>("PreparedTrajectory with a seed", n, m, dimension));
+                check(close<T>(directed, hausdorffDistance(preparedA, preparedB)), describe<T>("hausdorffDistance of prepared trajectories", n, m, dimension));
+                check(close<T>(symmetric, symmetricHausdorffDistance(preparedA, preparedB)), describe<T>("symmetricHausdorffDistance of prepared trajectories", n, m, dimension));
+                const Hausdorff::PreparedTrajectory<T> orderedA(viewA, permutationA), nestedB(Reference::toNested(viewB));
+                check(orderedA.permutation() == permutationA && close<T>(symmetric, symmetricHausdorffDistance(orderedA, nestedB)),
+                      describe<T>("prepared trajectories with a permutation and of vectors", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief k-d trees of small and single leaves, over sets large enough to be several levels deep. */
+    template <typename T>
+    void testKdTree(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 20; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b, 3.0, (repeat % 4 == 0) ? 300 : 40);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double directed = Reference::directedHausdorff(viewA, viewB);
+                const double symmetric = Reference::symmetricHausdorff(viewA, viewB);
+
+                const Hausdorff::KdTree<T> treeA(viewA, 4), treeB(viewB, 4);
+                check(treeB.size() == m && treeB.dimension() == dimension, describe<T>("KdTree size and dimension", n, m, dimension));
+                check(close<T>(directed, hausdorffDistance(viewA, treeB)), describe<T>("hausdorffDistance against a k-d tree", n, m, dimension));
+                check(close<T>(symmetric, symmetricHausdorffDistance(treeA, treeB)), describe<T>("symmetricHausdorffDistance of k-d trees", n, m, dimension));
+                const Hausdorff::KdTree<T> wideA(Reference::toNested(viewA)), wideB(viewB, 1000);
+                check(close<T>(symmetric, symmetricHausdorffDistance(wideA, wideB)), describe<T>("symmetricHausdorffDistance of single-leaf k-d trees", n, m, dimension));
+                const Hausdorff::KdTree<T> singletons(viewB, 1);
+                check(close<T>(directed, hausdorffDistance(viewA, singletons)), describe<T>("hausdorffDistance against a k-d tree of one-point leaves", n, m, dimension));
+
+                const std::uint64_t seed = generator();
+                Hausdorff::Workspace<T> first(seed), second(seed);
+                const double seeded = symmetricHausdorffDistance(treeA, treeB, first);
+                check(close<T>(symmetric, seeded) && seeded == symmetricHausdorffDistance(treeA, treeB, second),
+                      describe<T>("symmetricHausdorffDistance of k-d trees with equally seeded workspaces", n, m, dimension));
+                check(close<T>(directed, hausdorffDistance(viewA, treeB, first)) && first.indicesA.size() == n,
+                      describe<T>("hausdorffDistance against a k-d tree with a workspace", n, m, dimension));
+                check(close<T>(symmetric, symmetricHausdorffDistance(treeA, treeB, static_cast<T>(2 * symmetric), first)),
+                      describe<T>("symmetricHausdorffDistance of k-d trees with a cutoff and a workspace", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief The std::array overloads, which skip the run-time dimension dispatch. */
+    template <typename T, std::size_t D>
+    void testArrays(std::mt19937& generator)
+    {
+        for (int repeat = 0; repeat < 30; ++repeat)
+        {
+            Trajectory<T> a, b;
+            randomPair(D, generator, a, b);
+            const std::size_t n = a.size(), m = b.size();
+            const double directed = Reference::directedHausdorff(a.view(), b.view());
+            check(close<T>(directed, hausdorffDistance(Reference::toArrays<D>(a.view()), Reference::toArrays<D>(b.view()))), describe<T>("hausdorffDistance of arrays", n, m, D));
+            check(close<T>(Reference::symmetricHausdorff(a.view(), b.view()), symmetricHausdorffDistance(Reference::toArrays<D>(a.view()), Reference::toArrays<D>(b.view()))),
+                  describe<T>("symmetricHausdorffDistance of arrays", n, m, D));
+        }
+    }
+
+    /* @brief The squared cutoff is the largest T whose root is at most the cutoff, so the next T up exceeds it. */
+    template <typename T>
+    void testSquaredCutoff(std::mt19937& generator)
+    {
+        const char* type = std::is_same<T, float>::value ? "float" : "double";
+        std::uniform_real_distribution<double> cutoffs(0.0, 100.0);
+        for (int repeat = 0; repeat < 100000; ++repeat)
+        {
+            const double cutoff = cutoffs(generator);
+            const T squared = Hausdorff::detail::squaredCutoff<T>(cutoff);
+            const T next = std::nextafter(squared, std::numeric_limits<T>::infinity());
+            check(std::sqrt(static_cast<double>(squared)) <= cutoff && std::sqrt(static_cast<double>(next)) > cutoff,
+                  std::string("squaredCutoff (") + type + ", cutoff = " + std::to_string(cutoff) + ")");
+        }
+    }
+
+    /* @brief The cutoff contract of every overload that takes one, for cutoffs on both sides of the distance. */
+    template <typename T>
+    void testCutoffs(std::mt19937& generator)
+    {
+        const double fractions[] = { 0.0, 0.5, 0.9, 1.0, 1.1, 2.0 };
+        Hausdorff::Workspace<T> workspace;
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double directed = Reference::directedHausdorff(viewA, viewB);
+                const double symmetric = Reference::symmetricHausdorff(viewA, viewB);
+                const std::vector<std::vector<T>> nestedA = Reference::toNested(viewA), nestedB = Reference::toNested(viewB);
+                const std::uint64_t seed = generator();
+                const Hausdorff::PreparedTrajectory<T> preparedA(viewA, seed), preparedB(viewB, seed + 1);
+                const Hausdorff::KdTree<T> treeA(viewA, 4), treeB(viewB, 4);
+
+                /* The last bit of a distance can depend on the visiting order, so each engine is compared with its own
+                   distance without a cutoff under the same shuffle */
+                const std::uint64_t shuffleSeed = generator();
+                Hausdorff::Workspace<T>& shared = Hausdorff::detail::threadWorkspace<T>();
+                const auto reseeded = [shuffleSeed](Hausdorff::Workspace<T>& w) -> Hausdorff::Workspace<T>&
+                {
+                    w.rngGenerator.seed(static_cast<std::default_random_engine::result_type>(shuffleSeed));
+                    return w;
+                };
+                const double viewDirected = hausdorffDistance(viewA, viewB, reseeded(workspace)), viewSymmetric = symmetricHausdorffDistance(viewA, viewB, reseeded(workspace));
+                const double swappedSymmetric = symmetricHausdorffDistance(viewB, viewA, reseeded(workspace)), treeSymmetric = symmetricHausdorffDistance(treeA, treeB);
+
+                /* A cutoff equal to the engine's own result must give that result back exactly */
+                const double preparedDirected = hausdorffDistance(preparedA, preparedB), preparedSymmetric = symmetricHausdorffDistance(preparedA, preparedB);
+                check(hausdorffDistance(preparedA, preparedB, preparedDirected) == preparedDirected,
+                      describe<T>("prepared hausdorffDistance with its own distance as the cutoff", n, m, dimension));
+                check(symmetricHausdorffDistance(preparedA, preparedB, preparedSymmetric) == preparedSymmetric,
+                      describe<T>("prepared symmetricHausdorffDistance with its own distance as the cutoff", n, m, dimension));
+
+                for (double fraction : fractions)
+                {
+                    /* The cutoff is a double whatever T is, and for float it is usually not representable */
+                    const double c = fraction * symmetric;
+                    Reference::checkCutoff<T>(directed, viewDirected, (reseeded(shared), hausdorffDistance(viewA, viewB, c)), c, describe<T>("hausdorffDistance with a cutoff", n, m, dimension));
+                    Reference::checkCutoff<T>(directed, viewDirected, hausdorffDistance(viewA, viewB, c, reseeded(workspace)), c,
+                                              describe<T>("hausdorffDistance with a cutoff and a workspace", n, m, dimension));
+                    Reference::checkCutoff<T>(directed, viewDirected, (reseeded(shared), hausdorffDistance(nestedA, nestedB, c)), c, describe<T>("hausdorffDistance of vectors with a cutoff", n, m, dimension));
+                    Reference::checkCutoff<T>(directed, viewDirected, hausdorffDistance(nestedA, nestedB, c, reseeded(workspace)), c,
+                                              describe<T>("hausdorffDistance of vectors with a cutoff and a workspace", n, m, dimension));
+                    Reference::checkCutoff<T>(symmetric, viewSymmetric, (reseeded(shared), symmetricHausdorffDistance(viewA, viewB, c)), c,
+                                              describe<T>("symmetricHausdorffDistance with a cutoff", n, m, dimension));
+                    Reference::checkCutoff<T>(symmetric, swappedSymmetric, symmetricHausdorffDistance(viewB, viewA, c, reseeded(workspace)), c,
+                                              describe<T>("symmetricHausdorffDistance of swapped views with a cutoff", m, n, dimension));
+                    Reference::checkCutoff<T>(directed, preparedDirected, hausdorffDistance(preparedA, preparedB, c), c,
+                                              describe<T>("prepared hausdorffDistance with a cutoff", n, m, dimension));
+                    Reference::checkCutoff<T>(symmetric, preparedSymmetric, symmetricHausdorffDistance(preparedA, preparedB, c), c,
+                                              describe<T>("prepared symmetricHausdorffDistance with a cutoff", n, m, dimension));
+                    Reference::checkCutoff<T>(symmetric, treeSymmetric, symmetricHausdorffDistance(treeA, treeB, c), c,
+                                              describe<T>("k-d tree symmetricHausdorffDistance with a cutoff", n, m, dimension));
+                }
+                /* Cutoffs one step either side of the engine's own distance find the edge of the squared threshold */
+                const double infinity = std::numeric_limits<double>::infinity();
+                for (double c : { std::nextafter(viewDirected, 0.0), viewDirected, std::nextafter(viewDirected, infinity) })
+                    Reference::checkCutoff<T>(directed, viewDirected, hausdorffDistance(viewA, viewB, c, reseeded(workspace)), c,
+                                              describe<T>("hausdorffDistance with a cutoff next to its own distance", n, m, dimension));
+                for (double c : { std::nextafter(viewSymmetric, 0.0), viewSymmetric, std::nextafter(viewSymmetric, infinity) })
+                    Reference::checkCutoff<T>(symmetric, viewSymmetric, symmetricHausdorffDistance(viewA, viewB, c, reseeded(workspace)), c,
+                                              describe<T>("symmetricHausdorffDistance with a cutoff next to its own distance", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief Points appended to either set in random order, checked against the brute force of the prefixes. */
+    template <typename T>
+    void testIncremental(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 5; ++repeat)
+            {
+                const Trajectory<T> a = Reference::randomWalk<T>(Reference::randomSize(generator, 25), dimension, generator);
+                const Trajectory<T> b = Reference::randomWalk<T>(Reference::randomSize(generator, 25), dimension, generator, 1.0);
+                Hausdorff::IncrementalHausdorff<T> incremental(dimension);
+                std::size_t n = 0, m = 0;
+                while (n < a.size() || m < b.size())
+                {
+                    if (m == b.size() || (n < a.size() && generator() % 2 == 0)) incremental.appendA(a.view().point(n++));
+                    else incremental.appendB(b.view().point(m++));
+                    if (n == 0 || m == 0) continue;
+                    const TrajectoryView<T> prefixA = a.view().subView(0, n), prefixB = b.view().subView(0, m);
+                    check(close<T>(Reference::directedHausdorff(prefixA, prefixB), incremental.directedDistanceAB()), describe<T>("IncrementalHausdorff A to B", n, m, dimension));
+                    check(close<T>(Reference::directedHausdorff(prefixB, prefixA), incremental.directedDistanceBA()), describe<T>("IncrementalHausdorff B to A", n, m, dimension));
+                    check(close<T>(Reference::symmetricHausdorff(prefixA, prefixB), incremental.symmetricDistance()), describe<T>("IncrementalHausdorff symmetric", n, m, dimension));
+                }
+                const Hausdorff::IncrementalHausdorff<T> whole(a.view(), b.view());
+                check(close<T>(Reference::symmetricHausdorff(a.view(), b.view()), whole.symmetricDistance()), describe<T>("IncrementalHausdorff of whole sets", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief Every metric policy against the same brute force with the policy's own point distance. */
+    template <typename T>
+    void testMetrics(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 10; ++repeat)
+            {
+                const Trajectory<T> a = Reference::randomWalk<T>(Reference::randomSize(generator), dimension, generator);
+                const Trajectory<T> b = Reference::randomWalk<T>(Reference::randomSize(generator), dimension, generator, 1.0);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+
+                check(close<T>(Reference::directedHausdorff(viewA, viewB), hausdorffDistance(viewA, viewB, DistanceMetrics::metrics::Euclidean<T>())),
+                      describe<T>("hausdorffDistance with Euclidean", n, m, dimension));
+                check(close<T>(Reference::directedHausdorff(viewA, viewB, Reference::squaredEuclidean<T>),
+                               hausdorffDistance(viewA, viewB, DistanceMetrics::metrics::SquaredEuclidean<T>())),
+                      describe<T>("hausdorffDistance with SquaredEuclidean", n, m, dimension));
+
+                Reference::Weighted<T> weighted;
+                Reference::Periodic<T> periodic;
+                Reference::randomWeightsAndPeriods(dimension, generator, weighted.weights, periodic.periods);
+                const DistanceMetrics::metrics::WeightedEuclidean<T> weightedMetric(weighted.weights);
+                check(close<T>(Reference::directedHausdorff(viewA, viewB, weighted), hausdorffDistance(viewA, viewB, weightedMetric)),
+                      describe<T>("hausdorffDistance with WeightedEuclidean", n, m, dimension));
+                check(close<T>(std::max(Reference::directedHausdorff(viewA, viewB, weighted), Reference::directedHausdorff(viewB, viewA, weighted)),
+                               symmetricHausdorffDistance(viewA, viewB, weightedMetric)),
+                      describe<T>("symmetricHausdorffDistance with WeightedEuclidean", n, m, dimension));
+                const DistanceMetrics::metrics::Periodic<T> periodicMetric(periodic.periods);
+                check(close<T>(std::max(Reference::directedHausdorff(viewA, viewB, periodic), Reference::directedHausdorff(viewB, viewA, periodic)),
+                               symmetricHausdorffDistance(viewA, viewB, periodicMetric)),
+                      describe<T>("symmetricHausdorffDistance with Periodic", n, m, dimension));
+
+                if (dimension == 2)
+                {
+                    const Trajectory<T> anglesA = Reference::randomAngles<T>(n, generator), anglesB = Reference::randomAngles<T>(m, generator, 1.0);
+                    check(close<T>(Reference::directedHausdorff(anglesA.view(), anglesB.view(), Reference::greatCircle<T>),
+                                   hausdorffDistance(anglesA.view(), anglesB.view(), DistanceMetrics::metrics::GreatCircle<T>())),
+                          describe<T>("hausdorffDistance with GreatCircle", n, m, dimension));
+                }
+            }
+        }
+    }
+
+    /* @brief The witness pair attains the directed distance, its second point is the nearest to its first, and the
+     *        same seed gives the same pair.
+    */
+    template <typename T>
+    void testWitness(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 30; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const double directed = Reference::directedHausdorff(viewA, viewB);
+
+                const Hausdorff::Witness witness = hausdorffWitness(viewA, viewB);
+                check(close<T>(directed, witness.distance), describe<T>("hausdorffWitness distance", n, m, dimension));
+                check(witness.indexA < n && witness.indexB < m && close<T>(directed, Reference::euclidean(viewA, witness.indexA, viewB, witness.indexB)),
+                      describe<T>("hausdorffWitness points attain the distance", n, m, dimension));
+                double nearest = std::numeric_limits<double>::infinity();
+                for (std::size_t j = 0; j < m && witness.indexA < n; ++j) nearest = std::min(nearest, Reference::euclidean(viewA, witness.indexA, viewB, j));
+                check(close<T>(directed, nearest), describe<T>("hausdorffWitness point of a is the furthest from b", n, m, dimension));
+
+                const std::uint64_t seed = generator();
+                Hausdorff::Workspace<T> first(seed), second(seed);
+                const Hausdorff::Witness seeded = hausdorffWitness(viewA, viewB, first), repeated = hausdorffWitness(viewA, viewB, second);
+                check(seeded.distance == repeated.distance && seeded.indexA == repeated.indexA && seeded.indexB == repeated.indexB,
+                      describe<T>("hausdorffWitness with the same seed", n, m, dimension));
+                check(close<T>(Reference::directedHausdorff(viewB, viewA), hausdorffWitness(viewB, viewA, first).distance),
+                      describe<T>("hausdorffWitness of swapped views reusing a workspace", m, n, dimension));
+            }
+        }
+    }
+
+    /* @brief Inputs the engines must reject. */
+    template <typename T>
+    void testInvalidInputs(std::mt19937& generator)
+    {
+        const Trajectory<T> plane = Reference::randomWalk<T>(5, 2, generator), space = Reference::randomWalk<T>(5, 3, generator), none(3);
+        check(Reference::throws([&] { hausdorffDistance(plane.view(), space.view()); }), describe<T>("hausdorffDistance of different dimensions throws", 5, 5, 2));
+        check(Reference::throws([&] { hausdorffDistance(space.view(), none.view()); }), describe<T>("hausdorffDistance of an empty trajectory throws", 5, 0, 3));
+        check(Reference::throws([&] { symmetricHausdorffDistance(plane.view(), space.view()); }), describe<T>("symmetricHausdorffDistance of different dimensions throws", 5, 5, 2));
+        check(Reference::throws([&] { symmetricHausdorffDistance(none.view(), space.view()); }), describe<T>("symmetricHausdorffDistance of an empty trajectory throws", 0, 5, 3));
+        const std::vector<int> repeated = { 0, 1, 1, 3, 4 }, shorter = { 0, 1, 2, 3 };
+        check(Reference::throws([&] { hausdorffDistance(space.view(), space.view(), repeated, shorter); }), describe<T>("hausdorffDistance with a repeated index throws", 5, 5, 3));
+        check(Reference::throws([&] { hausdorffDistance(space.view(), space.view(), shorter, shorter); }), describe<T>("hausdorffDistance with a short permutation throws", 5, 5, 3));
+        check(Reference::throws([&] { Hausdorff::PreparedTrajectory<T> prepared(space.view(), repeated); }), describe<T>("PreparedTrajectory with a repeated index throws", 5, 0, 3));
+        check(Reference::throws([&] { Hausdorff::KdTree<T> tree(none.view()); }), describe<T>("KdTree of an empty trajectory throws", 0, 0, 3));
+        check(Reference::throws([&] { hausdorffDistance(plane.view(), Hausdorff::KdTree<T>(space.view())); }), describe<T>("hausdorffDistance against a k-d tree of another dimension throws", 5, 5, 2));
+        check(Reference::throws([&] { Hausdorff::IncrementalHausdorff<T> incremental(2); incremental.appendA(space.view()); }),
+              describe<T>("IncrementalHausdorff rejects points of another dimension", 5, 0, 2));
+        check(Reference::throws([&] { Hausdorff::IncrementalHausdorff<T> incremental(plane.view(), none.view()); incremental.symmetricDistance(); }),
+              describe<T>("IncrementalHausdorff has no distance while a set is empty", 5, 0, 2));
+        check(Reference::throws([&] { Hausdorff::IncrementalHausdorff<T> incremental(0); }), describe<T>("IncrementalHausdorff of dimension zero throws", 0, 0, 0));
+        check(Reference::throws([&] { hausdorffWitness(plane.view(), space.view()); }), describe<T>("hausdorffWitness of different dimensions throws", 5, 5, 2));
+        check(Reference::throws([&] { hausdorffDistance(space.view(), space.view(), DistanceMetrics::metrics::WeightedEuclidean<T>(std::vector<T>(2, T(1)))); }),
+              describe<T>("hausdorffDistance with a weight per coordinate missing throws", 5, 5, 3));
+        check(Reference::throws([&] { DistanceMetrics::metrics::WeightedEuclidean<T>(std::vector<T>{ T(1), T(-1) }); }), describe<T>("WeightedEuclidean with a negative weight throws", 0, 0, 2));
+        check(Reference::throws([&] { symmetricHausdorffDistance(space.view(), space.view(), DistanceMetrics::metrics::GreatCircle<T>()); }),
+              describe<T>("symmetricHausdorffDistance with GreatCircle in three dimensions throws", 5, 5, 3));
+        check(Reference::throws([&] { hausdorffDistance(Reference::toNested(plane.view()), Reference::toNested(space.view())); }),
+              describe<T>("hausdorffDistance of vectors of different dimensions throws", 5, 5, 2));
+    }
+};
+
+int main()
+{
+    std::mt19937 generator(20211);
+    testViews<float>(generator);
+    testViews<double>(generator);
+    testSymmetric<float>(generator);
+    testSymmetric<double>(generator);
+    testWorkspace<float>(generator);
+    testWorkspace<double>(generator);
+    testPermutations<float>(generator);
+    testPermutations<double>(generator);
+    testKdTree<float>(generator);
+    testKdTree<double>(generator);
+    testArrays<float, 1>(generator);
+    testArrays<double, 1>(generator);
+    testArrays<float, 2>(generator);
+    testArrays<double, 2>(generator);
+    testArrays<float, 3>(generator);
+    testArrays<double, 3>(generator);
+    testArrays<float, 4>(generator);
+    testArrays<double, 4>(generator);
+    testArrays<float, 6>(generator);
+    testArrays<double, 6>(generator);
+    testSquaredCutoff<float>(generator);
+    testSquaredCutoff<double>(generator);
+    testCutoffs<float>(generator);
+    testCutoffs<double>(generator);
+    testIncremental<float>(generator);
+    testIncremental<double>(generator);
+    testMetrics<float>(generator);
+    testMetrics<double>(generator);
+    testWitness<float>(generator);
+    testWitness<double>(generator);
+    testInvalidInputs<float>(generator);
+    testInvalidInputs<double>(generator);
+    return Reference::report("hausdorff_test");
+}
@@ -0,0 +1,150 @@
+/*  Point distance kernel tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "Common/PointDistance.hpp"
+#include "Common/SimdKernels.hpp"
+#include "Common/Trajectory.hpp"
+#include "tests/Reference.hpp"
+
+/* Checks the point distance kernels the engines are built on, scalar and SIMD, against the brute force. */
+namespace
+{
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+    using Reference::close;
+    using Reference::describe;
+
+    /* @brief The unrolled kernels of dimension D agree with the run-time loop and the reference. */
+    template <typename T, std::size_t D>
+    void testSquaredDistance(std::mt19937& generator)
+    {
+        const Trajectory<T> a = Reference::randomWalk<T>(20, D, generator), b = Reference::randomWalk<T>(20, D, generator, 1.0);
+        const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+        const std::vector<std::array<T, D>> arrayA = Reference::toArrays<D>(viewA), arrayB = Reference::toArrays<D>(viewB);
+        bool matches = true;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            for (std::size_t j = 0; j < b.size(); ++j)
+            {
+                const double expected = Reference::squaredEuclidean(viewA, i, viewB, j);
+                const T dynamic = DistanceMetrics::squaredDistance<T>(viewA, i, viewB, j);
+                matches = matches && close<T>(expected, dynamic) && close<T>(expected, DistanceMetrics::squaredDistance<T, D>(viewA, i, viewB, j)) &&
+                          close<T>(expected, DistanceMetrics::squaredDistance(arrayA[i], arrayB[j]));
+            }
+        }
+        check(matches, describe<T>("squaredDistance unrolled", a.size(), b.size(), D));
+
+        const TrajectoryView<T> arrayView = DistanceMetrics::makeView(arrayA);
+        bool same = arrayView.size() == a.size() && arrayView.dimension() == D && arrayView.isRowMajor();
+        for (std::size_t i = 0; i < a.size() && same; ++i)
+        {
+            for (std::size_t k = 0; k < D && same; ++k) same = arrayView(i, k) == a(i, k) && &arrayView(i, k) == &arrayA[i][k];
+        }
+        check(same, describe<T>("makeView of arrays views them in place", a.size(), 0, D));
+    }
+
+    /* @brief Every one-to-many kernel this machine can run, for target counts covering whole blocks and tails. */
+    template <typename T, std::size_t D>
+    void testOneToMany(std::size_t dimension, std::mt19937& generator)
+    {
+        using DistanceMetrics::simd::InstructionSet;
+        std::vector<InstructionSet> instructionSets = { InstructionSet::Scalar };
+        const InstructionSet active = DistanceMetrics::simd::activeInstructionSet();
+        if (active == InstructionSet::AVX512) instructionSets.push_back(InstructionSet::AVX2);
+        if (active != InstructionSet::Scalar) instructionSets.push_back(active);
+
+        for (InstructionSet instructionSet : instructionSets)
+        {
+            const DistanceMetrics::simd::OneToManyKernel<T> kernel = DistanceMetrics::simd::detail::selectKernel<T, D>(instructionSet);
+            const std::string name = "one-to-many kernel " + std::to_string(static_cast<int>(instructionSet));
+            for (std::size_t count = 1; count <= 67; ++count)
+            {
+                const Trajectory<T> query = Reference::randomWalk<T>(1, dimension, generator, 2.0);
+                const Trajectory<T> targets(Reference::randomWalk<T>(count, dimension, generator).view(), DistanceMetrics::Layout::StructureOfArrays);
+                /* Padding between the coordinate arrays checks that the kernels honour the stride */
+                const std::size_t stride = count + 5;
+                std::vector<T> padded(stride * dimension, std::numeric_limits<T>::quiet_NaN());
+                for (std::size_t k = 0; k < dimension; ++k)
+                {
+                    for (std::size_t j = 0; j < count; ++j) padded[k * stride + j] = targets(j, k);
+                }
+                double minimum = std::numeric_limits<double>::infinity();
+                for (std::size_t j = 0; j < count; ++j) minimum = std::min(minimum, Reference::squaredEuclidean(query.view(), 0, targets.view(), j));
+
+                bool brokeEarly = true;
+                const T full = kernel(query.data(), dimension, padded.data(), stride, count, -std::numeric_limits<T>::infinity(), brokeEarly);
+                check(!brokeEarly && close<T>(minimum, full), describe<T>(name + " minimum", 1, count, dimension));
+                kernel(query.data(), dimension, padded.data(), stride, count, std::numeric_limits<T>::infinity(), brokeEarly);
+                check(brokeEarly, describe<T>(name + " breaks below an infinite threshold", 1, count, dimension));
+                kernel(query.data(), dimension, padded.data(), stride, count, static_cast<T>(minimum * 1.5), brokeEarly);
+                check(brokeEarly, describe<T>(name + " breaks above the minimum", 1, count, dimension));
+                const T below = kernel(query.data(), dimension, padded.data(), stride, count, static_cast<T>(minimum * 0.5), brokeEarly);
+                check(!brokeEarly && close<T>(minimum, below), describe<T>(name + " runs to the end below the minimum", 1, count, dimension));
+            }
+        }
+        bool brokeEarly = true;
+        const Trajectory<T> query = Reference::randomWalk<T>(1, dimension, generator);
+        check(std::isinf(DistanceMetrics::simd::minSquaredDistance<T, D>(query.data(), dimension, query.data(), 1, 0, T(0), brokeEarly)) && !brokeEarly,
+              describe<T>("minSquaredDistance of no targets", 1, 0, dimension));
+    }
+
+    /* @brief dispatchDimension routes 2, 3 and 6 to their specialised kernels and every other dimension to the loop. */
+    void testDispatch()
+    {
+        for (std::size_t dimension = 1; dimension <= 8; ++dimension)
+        {
+            const std::size_t routed = DistanceMetrics::dispatchDimension(dimension, [](auto D) { return decltype(D)::value; });
+            const bool specialised = dimension == 2 || dimension == 3 || dimension == 6;
+            check(routed == (specialised ? dimension : DistanceMetrics::DynamicDimension), "dispatchDimension of " + std::to_string(dimension));
+        }
+    }
+};
+
+int main()
+{
+    std::mt19937 generator(20215);
+    testSquaredDistance<float, 1>(generator);
+    testSquaredDistance<double, 1>(generator);
+    testSquaredDistance<float, 2>(generator);
+    testSquaredDistance<double, 2>(generator);
+    testSquaredDistance<float, 3>(generator);
+    testSquaredDistance<double, 3>(generator);
+    testSquaredDistance<float, 4>(generator);
+    testSquaredDistance<double, 4>(generator);
+    testSquaredDistance<float, 6>(generator);
+    testSquaredDistance<double, 6>(generator);
+    testOneToMany<float, DistanceMetrics::DynamicDimension>(1, generator);
+    testOneToMany<double, DistanceMetrics::DynamicDimension>(1, generator);
+    testOneToMany<float, DistanceMetrics::DynamicDimension>(4, generator);
+    testOneToMany<double, DistanceMetrics::DynamicDimension>(4, generator);
+    testOneToMany<float, 2>(2, generator);
+    testOneToMany<double, 2>(2, generator);
+    testOneToMany<float, 3>(3, generator);
+    testOneToMany<double, 3>(3, generator);
+    testOneToMany<float, 6>(6, generator);
+    testOneToMany<double, 6>(6, generator);
+    testDispatch();
+    return Reference::report("kernel_test");
+}
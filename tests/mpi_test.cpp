@@ -0,0 +1,211 @@
+/*  MPI pairwise distance and checkpoint tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "MPI/PairwiseMpi.hpp"
+#include "tests/Reference.hpp"
+
+/* Runs pairwiseDistancesToFile across the ranks of the job, checks its output against the shared-memory engine, and
+ * checks that an interrupted job resumes from its checkpoints: recorded tiles are kept, the others recomputed.
+ * Launched through mpiexec by ctest; every rank reaches every collective call, and only rank 0 touches the files.
+ */
+namespace
+{
+    using DistanceMetrics::Metric;
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+
+    std::vector<double> readOutput(const std::string& path, std::size_t count)
+    {
+        std::vector<double> values(count);
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(count * sizeof(double)));
+        if (!file) values.clear();
+        return values;
+    }
+
+    void writeOutput(const std::string& path, const std::vector<double>& values)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(double)));
+    }
+
+    /* @brief Whether the file holds the expected matrix; the Hausdorff engines shuffle at random, so the last bit of
+     *        each distance may differ between runs. Entries never written are NaN and never match.
+    */
+    template <typename T>
+    bool matches(const std::string& path, const std::vector<double>& expected)
+    {
+        const std::vector<double> values = readOutput(path, expected.size());
+        if (values.size() != expected.size()) return false;
+        for (std::size_t index = 0; index < values.size(); ++index)
+        {
+            if (!Reference::close<T>(expected[index], values[index])) return false;
+        }
+        return true;
+    }
+
+    /* @brief Sum of a count over the ranks. */
+    std::size_t total(std::size_t count)
+    {
+        unsigned long long value = count;
+        MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        return static_cast<std::size_t>(value);
+    }
+
+    /* @brief Simulates a job killed part-way: keeps the first half of every checkpoint's records plus a torn record,
+     *        and leaves results only for the tiles still recorded, every other entry of the output being NaN.
+       @returns The number of tiles still recorded.
+    */
+    std::size_t interrupt(const std::string& output, const std::string& prefix, const std::vector<DistanceMetrics::detail::PairTile>& tiles,
+                          std::size_t trajectories, const std::vector<double>& expected, int ranks)
+    {
+        using Record = DistanceMetrics::mpi::detail::CheckpointRecord;
+        const std::size_t headerBytes = sizeof(DistanceMetrics::mpi::detail::CheckpointHeader);
+        std::vector<double> values(expected.size(), std::numeric_limits<double>::quiet_NaN());
+        std::size_t kept = 0;
+        for (int rank = 0; rank < ranks; ++rank)
+        {
+            const std::string path = DistanceMetrics::mpi::detail::checkpointPath(prefix, rank);
+            std::vector<Record> records((std::filesystem::file_size(path) - headerBytes) / sizeof(Record));
+            {
+                std::ifstream file(path, std::ios::binary);
+                file.seekg(static_cast<std::streamoff>(headerBytes));
+                file.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record)));
+            }
+            records.resize(records.size() / 2);
+            std::filesystem::resize_file(path, headerBytes + records.size() * sizeof(Record) + sizeof(Record) / 2);
+            kept += records.size();
+            for (const Record& record : records)
+            {
+                for (const DistanceMetrics::detail::PairTile& tile : tiles)
+                {
+                    if (tile.row != record.row || tile.columnBegin != record.columnBegin) continue;
+                    for (std::size_t j = tile.columnBegin; j < tile.columnEnd; ++j)
+                    {
+                        const std::size_t index = DistanceMetrics::condensedIndex(trajectories, tile.row, j);
+                        values[index] = expected[index];
+                    }
+                }
+            }
+        }
+        writeOutput(output, values);
+        return kept;
+    }
+
+    template <typename T>
+    void testCheckpoints(Metric metric, std::uint64_t job, int rank, int ranks)
+    {
+        const std::string name = std::string(std::is_same<T, float>::value ? "float" : "double") + (metric == Metric::Hausdorff ? " Hausdorff" : " Frechet");
+        /* Every rank draws the same trajectories */
+        std::mt19937 generator(20214);
+        std::uniform_real_distribution<double> offset(-4.0, 4.0);
+        std::vector<Trajectory<T>> set;
+        for (int t = 0; t < 14; ++t) set.push_back(Reference::randomWalk<T>(Reference::randomSize(generator), 3, generator, offset(generator)));
+        std::vector<TrajectoryView<T>> views;
+        for (const Trajectory<T>& trajectory : set) views.push_back(trajectory.view());
+        const std::vector<double> expected = DistanceMetrics::pairwiseDistances(views, metric, 1);
+
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        const std::string stem = "distance_metrics_mpi_test_" + std::to_string(job) + "_" + std::to_string(static_cast<int>(metric)) + "_" + std::to_string(sizeof(T));
+        const std::string output = (directory / (stem + ".bin")).string(), checkpoint = (directory / stem).string();
+
+        DistanceMetrics::mpi::Options options;
+        options.threads = 2;
+        options.tiles = 40;
+        DistanceMetrics::mpi::Progress progress = DistanceMetrics::mpi::pairwiseDistancesToFile(views, metric, output, options);
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (rank == 0) check(matches<T>(output, expected), name + ": output without checkpoints");
+        check(total(progress.computed) == progress.tiles && progress.resumed == 0, name + ": every tile computed once");
+
+        /* A checkpointed job, then the same job again: everything is already recorded */
+        options.checkpoint = checkpoint;
+        options.batch = 1;
+        progress = DistanceMetrics::mpi::pairwiseDistancesToFile(views, metric, output, options);
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (rank == 0) check(matches<T>(output, expected), name + ": output with checkpoints");
+        progress = DistanceMetrics::mpi::pairwiseDistancesToFile(views, metric, output, options);
+        check(progress.resumed == progress.tiles && total(progress.computed) == 0, name + ": a finished job resumes with nothing to do");
+
+        /* An interrupted job recomputes exactly the tiles its checkpoints do not record */
+        unsigned long long kept = 0;
+        if (rank == 0)
+        {
+            const std::vector<DistanceMetrics::detail::PairTile> tiles = DistanceMetrics::detail::makeTiles(DistanceMetrics::detail::trajectorySizes(views), options.tiles, 1);
+            kept = interrupt(output, checkpoint, tiles, views.size(), expected, ranks);
+        }
+        MPI_Bcast(&kept, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+        progress = DistanceMetrics::mpi::pairwiseDistancesToFile(views, metric, output, options);
+        MPI_Barrier(MPI_COMM_WORLD);
+        check(progress.resumed == kept && total(progress.computed) == progress.tiles - kept, name + ": an interrupted job resumes from its checkpoints");
+        if (rank == 0) check(matches<T>(output, expected), name + ": output after resuming");
+
+        /* Checkpoints of another job are refused on every rank */
+        bool refused = false;
+        try
+        {
+            DistanceMetrics::mpi::pairwiseDistancesToFile(views, metric == Metric::Hausdorff ? Metric::Frechet : Metric::Hausdorff, output, options);
+        }
+        catch (const std::runtime_error&)
+        {
+            refused = true;
+        }
+        check(refused, name + ": checkpoints of another metric are refused");
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (rank == 0)
+        {
+            std::filesystem::remove(output);
+            for (int r = 0; r < ranks; ++r) std::filesystem::remove(DistanceMetrics::mpi::detail::checkpointPath(checkpoint, r));
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank = 0, ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+    /* Rank 0 names the files of this job */
+    unsigned long long job = (rank == 0) ? std::random_device()() : 0;
+    MPI_Bcast(&job, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+
+    testCheckpoints<float>(Metric::Hausdorff, job, rank, ranks);
+    testCheckpoints<double>(Metric::Hausdorff, job, rank, ranks);
+    testCheckpoints<float>(Metric::Frechet, job, rank, ranks);
+    testCheckpoints<double>(Metric::Frechet, job, rank, ranks);
+
+    int failures = Reference::failures();
+    MPI_Allreduce(MPI_IN_PLACE, &failures, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (rank != 0) Reference::failures() = 0;
+    else Reference::failures() = failures;
+    const int status = (rank == 0) ? Reference::report("mpi_test") : (failures == 0 ? 0 : 1);
+    MPI_Finalize();
+    return status;
+}
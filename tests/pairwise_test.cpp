@@ -0,0 +1,410 @@
+/*  Pairwise, nearest-neighbour, library, batch and store tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Common/Trajectory.hpp"
+#include "Common/Pairwise.hpp"
+#include "Common/LowerBounds.hpp"
+#include "Common/Library.hpp"
+#include "Common/TrajectoryStore.hpp"
+#include "tests/Reference.hpp"
+
+/* Checks the engines that work on whole sets of trajectories against the brute force: the tiled pairwise matrix,
+ * the filter-and-refine nearest-neighbour search, the reference library, the packed batch and the on-disk store.
+ */
+namespace
+{
+    using DistanceMetrics::Metric;
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+    using Reference::close;
+
+    /* @brief count random walks of mixed lengths, scattered so that their distances differ. */
+    template <typename T>
+    std::vector<Trajectory<T>> randomSet(std::size_t count, std::size_t dimension, std::mt19937& generator, std::size_t largest = 40)
+    {
+        std::uniform_real_distribution<double> offset(-4.0, 4.0);
+        std::vector<Trajectory<T>> set;
+        for (std::size_t t = 0; t < count; ++t) set.push_back(Reference::randomWalk<T>(Reference::randomSize(generator, largest), dimension, generator, offset(generator)));
+        return set;
+    }
+
+    template <typename T>
+    std::vector<TrajectoryView<T>> viewsOf(const std::vector<Trajectory<T>>& set)
+    {
+        std::vector<TrajectoryView<T>> views;
+        for (const Trajectory<T>& trajectory : set) views.push_back(trajectory.view());
+        return views;
+    }
+
+    template <typename T>
+    double referenceDistance(const TrajectoryView<T>& a, const TrajectoryView<T>& b, Metric metric)
+    {
+        return metric == Metric::Hausdorff ? Reference::symmetricHausdorff(a, b) : Reference::frechet(a, b);
+    }
+
+    template <typename T>
+    std::string describe(const std::string& what, std::size_t count, std::size_t dimension, Metric metric)
+    {
+        return what + " (" + (std::is_same<T, float>::value ? "float" : "double") + ", " + std::to_string(count) + " trajectories, dimension = " +
+               std::to_string(dimension) + ", " + (metric == Metric::Hausdorff ? "Hausdorff" : "Frechet") + ")";
+    }
+
+    /* @brief The tiles cover every pair of the upper triangle exactly once, whatever the requested granularity. */
+    void testTiles(std::mt19937& generator)
+    {
+        const std::size_t tileCounts[] = { 1, 4, 16, 1000 };
+        for (int repeat = 0; repeat < 20; ++repeat)
+        {
+            std::vector<std::size_t> sizes(generator() % 30);
+            for (std::size_t& size : sizes) size = Reference::randomSize(generator, 200);
+            const std::size_t count = sizes.size();
+            for (std::size_t tilesPerThread : tileCounts)
+            {
+                const unsigned threads = 1 + generator() % 4;
+                std::vector<int> covered(DistanceMetrics::condensedSize(count), 0);
+                bool ordered = true;
+                for (const DistanceMetrics::detail::PairTile& tile : DistanceMetrics::detail::makeTiles(sizes, tilesPerThread, threads))
+                {
+                    ordered = ordered && tile.row < tile.columnBegin && tile.columnBegin < tile.columnEnd && tile.columnEnd <= count;
+                    for (std::size_t j = tile.columnBegin; ordered && j < tile.columnEnd; ++j) ++covered[DistanceMetrics::condensedIndex(count, tile.row, j)];
+                }
+                bool once = ordered;
+                for (int times : covered) once = once && times == 1;
+                check(once, "makeTiles covers every pair once (" + std::to_string(count) + " trajectories, " + std::to_string(tilesPerThread) + " tiles per thread)");
+            }
+        }
+    }
+
+    /* @brief Every entry of the condensed matrix, for several thread counts. */
+    template <typename T>
+    void testPairwise(std::mt19937& generator)
+    {
+        const Metric metrics[] = { Metric::Hausdorff, Metric::Frechet };
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            const std::vector<Trajectory<T>> set = randomSet<T>(2 + generator() % 12, dimension, generator);
+            const std::vector<TrajectoryView<T>> views = viewsOf(set);
+            const std::size_t count = views.size();
+            check(DistanceMetrics::condensedSize(count) == count * (count - 1) / 2, describe<T>("condensedSize", count, dimension, Metric::Hausdorff));
+            for (Metric metric : metrics)
+            {
+                const unsigned threadCounts[] = { 1, 3 };
+                for (unsigned threads : threadCounts)
+                {
+                    const std::vector<double> condensed = DistanceMetrics::pairwiseDistances(views, metric, threads);
+                    bool matches = condensed.size() == DistanceMetrics::condensedSize(count);
+                    for (std::size_t i = 0; i < count && matches; ++i)
+                    {
+                        for (std::size_t j = i + 1; j < count && matches; ++j)
+                        {
+                            matches = close<T>(referenceDistance(views[i], views[j], metric), condensed[DistanceMetrics::condensedIndex(count, i, j)]);
+                        }
+                    }
+                    check(matches, describe<T>("pairwiseDistances with " + std::to_string(threads) + " threads", count, dimension, metric));
+                }
+            }
+            const std::vector<double> custom = DistanceMetrics::pairwiseDistances(views, [](const TrajectoryView<T>& a, const TrajectoryView<T>& b)
+            {
+                return static_cast<double>(a.size() * 1000 + b.size());
+            }, 2);
+            bool ordered = true;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                for (std::size_t j = i + 1; j < count; ++j) ordered = ordered && custom[DistanceMetrics::condensedIndex(count, i, j)] == views[i].size() * 1000.0 + views[j].size();
+            }
+            check(ordered, describe<T>("pairwiseDistances with a distance function", count, dimension, Metric::Hausdorff));
+        }
+    }
+
+    /* @brief Checks a nearest-neighbour result against the sorted brute-force distances: the same distances rank
+     *        by rank, each at the index it claims. Ties may be broken either way.
+    */
+    template <typename T>
+    bool matchesBruteForce(const std::vector<DistanceMetrics::Neighbour>& found, const TrajectoryView<T>& query, const std::vector<TrajectoryView<T>>& references,
+                           std::size_t k, Metric metric)
+    {
+        std::vector<double> distances;
+        for (const TrajectoryView<T>& reference : references) distances.push_back(referenceDistance(query, reference, metric));
+        std::vector<double> sorted = distances;
+        std::sort(sorted.begin(), sorted.end());
+        if (found.size() != std::min(k, references.size())) return false;
+        for (std::size_t rank = 0; rank < found.size(); ++rank)
+        {
+            if (found[rank].index >= references.size()) return false;
+            if (!close<T>(sorted[rank], found[rank].distance) || !close<T>(distances[found[rank].index], found[rank].distance)) return false;
+        }
+        return true;
+    }
+
+    /* @brief The lower bounds never exceed the distance, and the filter-and-refine search returns the brute-force
+     *        k nearest.
+    */
+    template <typename T>
+    void testNearest(std::mt19937& generator)
+    {
+        const Metric metrics[] = { Metric::Hausdorff, Metric::Frechet };
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            const std::vector<Trajectory<T>> set = randomSet<T>(1 + generator() % 30, dimension, generator);
+            const std::vector<TrajectoryView<T>> references = viewsOf(set);
+            const std::size_t count = references.size();
+            /* A threshold of 8 points indexes most references and queries with k-d trees; the default indexes none */
+            const DistanceMetrics::Library<T> indexed(references, 8, 7), plain(references);
+            check(indexed.size() == count && indexed.dimension() == dimension, describe<T>("Library size and dimension", count, dimension, Metric::Hausdorff));
+            for (int repeat = 0; repeat < 5; ++repeat)
+            {
+                const Trajectory<T> query = Reference::randomWalk<T>(Reference::randomSize(generator), dimension, generator, 1.0);
+                for (Metric metric : metrics)
+                {
+                    bool bounded = true;
+                    for (const TrajectoryView<T>& reference : references)
+                    {
+                        const double exact = referenceDistance(query.view(), reference, metric), slack = exact * (1 + Reference::tolerance<T>());
+                        bounded = bounded && DistanceMetrics::lowerBound(query.view(), reference, metric) <= slack &&
+                                  DistanceMetrics::boundingBoxLowerBound<T>(query.view(), reference) <= slack;
+                        if (metric == Metric::Frechet) bounded = bounded && DistanceMetrics::endpointLowerBound<T>(query.view(), reference) <= slack;
+                    }
+                    check(bounded, describe<T>("lowerBound is a lower bound", count, dimension, metric));
+
+                    const std::size_t ks[] = { 1, 3, count + 2 };
+                    for (std::size_t k : ks)
+                    {
+                        check(matchesBruteForce(DistanceMetrics::nearestNeighbours(query.view(), references, k, metric), query.view(), references, k, metric),
+                              describe<T>("nearestNeighbours for k = " + std::to_string(k), count, dimension, metric));
+                        check(matchesBruteForce(plain.nearest(query.view(), k, metric, 1), query.view(), references, k, metric),
+                              describe<T>("Library::nearest for k = " + std::to_string(k), count, dimension, metric));
+                        check(matchesBruteForce(indexed.nearest(query.view(), k, metric, 3), query.view(), references, k, metric),
+                              describe<T>("Library::nearest with k-d trees for k = " + std::to_string(k), count, dimension, metric));
+                    }
+                    check(DistanceMetrics::nearestNeighbours(query.view(), references, 0, metric).empty(), describe<T>("nearestNeighbours for k = 0", count, dimension, metric));
+                    check(indexed.nearest(query.view(), 0, metric).empty(), describe<T>("Library::nearest for k = 0", count, dimension, metric));
+                }
+            }
+            const Trajectory<T> other = Reference::randomWalk<T>(5, dimension + 1, generator);
+            check(Reference::throws([&] { indexed.nearest(other.view(), 1, Metric::Hausdorff); }),
+                  describe<T>("Library::nearest of a query of another dimension throws", count, dimension, Metric::Hausdorff));
+        }
+    }
+
+    /* @brief In float, the k-th best Hausdorff distance is a double that float cannot represent. Here it is sqrt(3),
+     *        which rounds down to float, so a cutoff rounded to T would abandon the candidates that tie with it.
+    */
+    void testFloatCutoff()
+    {
+        const std::vector<std::vector<float>> origin = { { 0.0f, 0.0f, 0.0f } };
+        const std::vector<std::vector<std::vector<float>>> points = {
+            { { 1.0f, 1.0f, 1.0f } },
+            { { 1.0f, 1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f } },
+            { { 2.0f, 0.0f, 0.0f } },
+            { { 0.0f, 0.0f, 2.0f }, { 1.0f, 1.0f, 1.0f } },
+            { { 1.0f, 1.0f, -1.0f }, { 1.0f, -1.0f, 1.0f } } };
+        const Trajectory<float> query(origin);
+        std::vector<Trajectory<float>> set;
+        for (const std::vector<std::vector<float>>& trajectory : points) set.emplace_back(trajectory);
+        const std::vector<TrajectoryView<float>> references = viewsOf(set);
+        const double root3 = std::sqrt(3.0);
+        check(static_cast<double>(static_cast<float>(root3)) < root3, "sqrt(3) rounds down to float");
+
+        for (Metric metric : { Metric::Hausdorff, Metric::Frechet })
+        {
+            std::vector<double> exact;
+            for (const TrajectoryView<float>& reference : references)
+            {
+                exact.push_back(metric == Metric::Hausdorff ? symmetricHausdorffDistance(query.view(), reference) : Frechet::frechetDistance(query.view(), reference));
+            }
+            std::vector<double> sorted = exact;
+            std::sort(sorted.begin(), sorted.end());
+            for (std::size_t k = 1; k <= references.size(); ++k)
+            {
+                const std::vector<DistanceMetrics::Neighbour> found = DistanceMetrics::nearestNeighbours(query.view(), references, k, metric);
+                bool same = found.size() == k;
+                for (std::size_t rank = 0; rank < found.size() && same; ++rank)
+                {
+                    same = found[rank].distance == sorted[rank] && found[rank].distance == exact[found[rank].index];
+                }
+                check(same, describe<float>("nearestNeighbours with a cutoff float cannot represent, k = " + std::to_string(k), references.size(), 3, metric));
+            }
+        }
+    }
+
+    /* @brief A batch packs its trajectories row-major behind an offset table, the layout the CUDA backend uploads in
+     *        one copy, and gives back views that every CPU engine treats like the originals.
+    */
+    template <typename T>
+    void testBatch(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            const std::vector<Trajectory<T>> set = randomSet<T>(1 + generator() % 20, dimension, generator);
+            /* Structure-of-arrays inputs check that the batch repacks rather than copies the buffers */
+            std::vector<Trajectory<T>> columns;
+            for (const Trajectory<T>& trajectory : set) columns.emplace_back(trajectory.view(), DistanceMetrics::Layout::StructureOfArrays);
+            const std::vector<TrajectoryView<T>> views = viewsOf(set);
+            const std::size_t count = views.size();
+            const DistanceMetrics::TrajectoryBatch<T> batch(viewsOf(columns));
+
+            bool layout = batch.size() == count && batch.dimension() == dimension && batch.offsets().size() == count + 1 && batch.offsets()[0] == 0;
+            std::size_t points = 0;
+            for (std::size_t t = 0; t < count && layout; ++t)
+            {
+                layout = batch.offsets()[t + 1] - batch.offsets()[t] == views[t].size();
+                points += views[t].size();
+                for (std::size_t i = 0; i < views[t].size() && layout; ++i)
+                {
+                    for (std::size_t k = 0; k < dimension && layout; ++k) layout = batch.data()[(batch.offsets()[t] + i) * dimension + k] == views[t](i, k);
+                }
+            }
+            check(layout && batch.points() == points, describe<T>("TrajectoryBatch layout", count, dimension, Metric::Hausdorff));
+
+            const std::vector<TrajectoryView<T>> batched = batch.views();
+            bool same = batched.size() == count;
+            for (std::size_t t = 0; t < count && same; ++t)
+            {
+                same = batched[t].size() == views[t].size() && batch[t].size() == views[t].size() && batch.view(t).isRowMajor();
+                for (std::size_t i = 0; i < views[t].size() && same; ++i)
+                {
+                    for (std::size_t k = 0; k < dimension && same; ++k) same = batched[t](i, k) == views[t](i, k) && batch[t](i, k) == views[t](i, k);
+                }
+            }
+            check(same, describe<T>("TrajectoryBatch views", count, dimension, Metric::Hausdorff));
+
+            const std::vector<double> fromBatch = DistanceMetrics::pairwiseDistances(batched, Metric::Hausdorff, 2);
+            const std::vector<double> fromViews = DistanceMetrics::pairwiseDistances(views, Metric::Hausdorff, 2);
+            bool hausdorffMatches = fromBatch.size() == fromViews.size();
+            for (std::size_t index = 0; index < fromBatch.size() && hausdorffMatches; ++index) hausdorffMatches = close<T>(fromViews[index], fromBatch[index]);
+            check(hausdorffMatches, describe<T>("pairwiseDistances over a TrajectoryBatch", count, dimension, Metric::Hausdorff));
+            check(DistanceMetrics::pairwiseDistances(batched, Metric::Frechet, 2) == DistanceMetrics::pairwiseDistances(views, Metric::Frechet, 2),
+                  describe<T>("pairwiseDistances over a TrajectoryBatch", count, dimension, Metric::Frechet));
+
+            DistanceMetrics::TrajectoryBatch<T> grown(dimension);
+            for (const TrajectoryView<T>& view : views) grown.push_back(view);
+            check(grown.offsets() == batch.offsets() && std::equal(grown.data(), grown.data() + grown.points() * dimension, batch.data()),
+                  describe<T>("TrajectoryBatch::push_back", count, dimension, Metric::Hausdorff));
+            bool rejected = false;
+            try
+            {
+                grown.push_back(Reference::randomWalk<T>(3, dimension + 1, generator).view());
+            }
+            catch (const std::runtime_error&)
+            {
+                rejected = true;
+            }
+            check(rejected && grown.size() == count, describe<T>("TrajectoryBatch::push_back of another dimension throws", count, dimension, Metric::Hausdorff));
+        }
+    }
+
+    /* @brief Writes a store file with the given header fields, the values in between and the offset table behind them. */
+    template <typename T>
+    void writeForgedStore(const std::string& path, std::uint64_t dimension, std::uint64_t count, std::uint64_t points,
+                          const std::vector<T>& values, const std::vector<std::uint64_t>& offsets)
+    {
+        DistanceMetrics::detail::StoreHeader header = {};
+        std::memcpy(header.magic, DistanceMetrics::detail::storeMagic, sizeof(header.magic));
+        header.version = DistanceMetrics::detail::storeVersion;
+        header.byteOrder = DistanceMetrics::detail::storeByteOrder;
+        header.scalarSize = sizeof(T);
+        header.dimension = dimension;
+        header.count = count;
+        header.points = points;
+        header.dataOffset = DistanceMetrics::detail::storeDataOffset;
+        header.offsetsOffset = DistanceMetrics::detail::storeOffsetsOffset(values.size() * sizeof(T));
+        char slot[DistanceMetrics::detail::storeDataOffset] = {};
+        std::memcpy(slot, &header, sizeof(header));
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(slot, sizeof(slot));
+        file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+        file.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(std::uint64_t)));
+    }
+
+    /* @brief A store written to disk and mapped back holds the same trajectories, and rejects other types and truncated files. */
+    template <typename T>
+    void testStore(std::mt19937& generator)
+    {
+        const std::string path = (std::filesystem::temp_directory_path() / ("distance_metrics_store_test_" + std::to_string(generator()) + ".bin")).string();
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            const std::vector<Trajectory<T>> set = randomSet<T>(1 + generator() % 20, dimension, generator);
+            const std::vector<TrajectoryView<T>> views = viewsOf(set);
+            DistanceMetrics::writeTrajectoryStore(path, views);
+            {
+                const DistanceMetrics::TrajectoryStore<T> store(path);
+                bool same = store.size() == views.size() && store.dimension() == dimension;
+                std::size_t points = 0;
+                for (std::size_t t = 0; t < views.size() && same; ++t)
+                {
+                    const TrajectoryView<T> stored = store.view(t);
+                    same = stored.size() == views[t].size();
+                    points += stored.size();
+                    for (std::size_t i = 0; i < stored.size() && same; ++i)
+                    {
+                        for (std::size_t k = 0; k < dimension && same; ++k) same = stored(i, k) == views[t](i, k);
+                    }
+                }
+                check(same && store.points() == points, describe<T>("TrajectoryStore round trip", views.size(), dimension, Metric::Hausdorff));
+                check(DistanceMetrics::pairwiseDistances(store.views(), Metric::Frechet, 2) == DistanceMetrics::pairwiseDistances(views, Metric::Frechet, 2),
+                      describe<T>("pairwiseDistances over a TrajectoryStore", views.size(), dimension, Metric::Frechet));
+            }
+            check(Reference::throws([&] { std::conditional_t<std::is_same<T, float>::value, DistanceMetrics::TrajectoryStore<double>, DistanceMetrics::TrajectoryStore<float>> wrong(path); }),
+                  describe<T>("TrajectoryStore of another floating-point type throws", views.size(), dimension, Metric::Hausdorff));
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+            check(Reference::throws([&] { DistanceMetrics::TrajectoryStore<T> truncated(path); }),
+                  describe<T>("TrajectoryStore of a truncated file throws", views.size(), dimension, Metric::Hausdorff));
+        }
+
+        /* Forged headers whose sizes wrap around 2^64 when multiplied out: a point count whose values would take
+         * exactly 2^64 bytes, so that the values seem to take none, and a trajectory count whose offset table would */
+        const std::uint64_t wrappingPoints = (std::uint64_t(1) << 63) / sizeof(T) * 2;
+        writeForgedStore<T>(path, 1, 1, wrappingPoints, {}, { 0, wrappingPoints });
+        check(Reference::throws([&] { DistanceMetrics::TrajectoryStore<T> forged(path); }),
+              describe<T>("TrajectoryStore with a point count that wraps the data size throws", 1, 1, Metric::Hausdorff));
+        writeForgedStore<T>(path, 1, (std::uint64_t(1) << 61) - 1, 1, { T(1) }, { 0, 1 });
+        check(Reference::throws([&] { DistanceMetrics::TrajectoryStore<T> forged(path); }),
+              describe<T>("TrajectoryStore with a trajectory count that wraps the offset table size throws", 1, 1, Metric::Hausdorff));
+        writeForgedStore<T>(path, 0, 1, 1, { T(1) }, { 0, 1 });
+        check(Reference::throws([&] { DistanceMetrics::TrajectoryStore<T> forged(path); }),
+              describe<T>("TrajectoryStore with points but no dimension throws", 1, 0, Metric::Hausdorff));
+        std::filesystem::remove(path);
+    }
+};
+
+int main()
+{
+    std::mt19937 generator(20213);
+    testTiles(generator);
+    testPairwise<float>(generator);
+    testPairwise<double>(generator);
+    testNearest<float>(generator);
+    testNearest<double>(generator);
+    testFloatCutoff();
+    testBatch<float>(generator);
+    testBatch<double>(generator);
+    testStore<float>(generator);
+    testStore<double>(generator);
+    return Reference::report("pairwise_test");
+}
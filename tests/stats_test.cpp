@@ -0,0 +1,176 @@
+/*  Instrumentation counter tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "Common/Stats.hpp"
+#include "Common/Trajectory.hpp"
+#include "Hausdorff distance/Hausdorff.hpp"
+#include "Frechet_distance/Frechet.hpp"
+#include "tests/Reference.hpp"
+
+/* Built with DISTANCE_METRICS_ENABLE_STATS defined. Checks that the counters add up for every call made inside a
+ * StatsScope, that calls outside one record nothing, and that the distances themselves are unchanged.
+ */
+namespace
+{
+    using DistanceMetrics::Stats;
+    using DistanceMetrics::StatsScope;
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+    using Reference::close;
+    using Reference::describe;
+    using Reference::randomPair;
+
+    /* @brief The Hausdorff counters: n * m possible distances per direction, one outer iteration per query point. */
+    template <typename T>
+    void testHausdorff(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 20; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const std::uint64_t cells = static_cast<std::uint64_t>(n) * m;
+
+                Stats directed;
+                double distance;
+                {
+                    StatsScope scope(directed);
+                    distance = hausdorffDistance(viewA, viewB);
+                }
+                check(close<T>(Reference::directedHausdorff(viewA, viewB), distance), describe<T>("hausdorffDistance with stats enabled", n, m, dimension));
+                check(directed.possibleEvaluations == cells, describe<T>("hausdorffDistance possibleEvaluations", n, m, dimension));
+                check(directed.distanceEvaluations >= m && directed.distanceEvaluations <= cells, describe<T>("hausdorffDistance distanceEvaluations", n, m, dimension));
+                check(directed.outerIterations >= 1 && directed.outerIterations <= n, describe<T>("hausdorffDistance outerIterations", n, m, dimension));
+                check(directed.earlyBreaks <= directed.outerIterations, describe<T>("hausdorffDistance earlyBreaks", n, m, dimension));
+                check(directed.peakMatrixBytes >= m * dimension * sizeof(T), describe<T>("hausdorffDistance peakMatrixBytes", n, m, dimension));
+                check(directed.evaluationRatio() <= 1.0 && directed.breakRate() <= 1.0, describe<T>("hausdorffDistance ratios", n, m, dimension));
+
+                Stats symmetric;
+                {
+                    StatsScope scope(symmetric);
+                    distance = symmetricHausdorffDistance(viewA, viewB);
+                }
+                check(close<T>(Reference::symmetricHausdorff(viewA, viewB), distance), describe<T>("symmetricHausdorffDistance with stats enabled", n, m, dimension));
+                check(symmetric.possibleEvaluations == 2 * cells, describe<T>("symmetricHausdorffDistance possibleEvaluations", n, m, dimension));
+                check(symmetric.distanceEvaluations <= 2 * cells, describe<T>("symmetricHausdorffDistance distanceEvaluations", n, m, dimension));
+                check(symmetric.outerIterations <= n + m && symmetric.earlyBreaks <= symmetric.outerIterations,
+                      describe<T>("symmetricHausdorffDistance outerIterations", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief The Frechet counters: every cell distance is counted, the diagonal walk included. */
+    template <typename T>
+    void testFrechet(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            for (int repeat = 0; repeat < 20; ++repeat)
+            {
+                Trajectory<T> a, b;
+                randomPair(dimension, generator, a, b);
+                const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+                const std::size_t n = a.size(), m = b.size();
+                const std::uint64_t cells = static_cast<std::uint64_t>(n) * m;
+                const double expected = Reference::frechet(viewA, viewB);
+
+                Stats linear;
+                T distance;
+                {
+                    StatsScope scope(linear);
+                    distance = Frechet::frechetDistance(viewA, viewB);
+                }
+                check(close<T>(expected, distance), describe<T>("frechetDistance with stats enabled", n, m, dimension));
+                check(linear.possibleEvaluations == cells, describe<T>("frechetDistance possibleEvaluations", n, m, dimension));
+                check(linear.distanceEvaluations >= std::max(n, m) && linear.distanceEvaluations <= cells + std::max(n, m),
+                      describe<T>("frechetDistance distanceEvaluations", n, m, dimension));
+                check(linear.offDiagonalCells <= linear.distanceEvaluations, describe<T>("frechetDistance offDiagonalCells", n, m, dimension));
+                check(linear.outerIterations == 0 && linear.earlyBreaks == 0, describe<T>("frechetDistance leaves the Hausdorff counters alone", n, m, dimension));
+
+                Stats sparse;
+                Frechet::SparseMatrix<T> matrix;
+                {
+                    StatsScope scope(sparse);
+                    Frechet::computeFrechetMatrix(viewA, viewB, matrix);
+                }
+                std::uint64_t computed = 0;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    for (std::size_t j = matrix.rowBegin(i); j < matrix.rowEnd(i); ++j) computed += matrix.contains(i, j);
+                }
+                check(close<T>(expected, matrix(n - 1, m - 1)), describe<T>("computeFrechetMatrix with stats enabled", n, m, dimension));
+                check(sparse.peakMatrixBytes >= matrix.storedCells() * sizeof(T), describe<T>("computeFrechetMatrix peakMatrixBytes", n, m, dimension));
+                check(sparse.distanceEvaluations >= computed && sparse.offDiagonalCells <= sparse.distanceEvaluations,
+                      describe<T>("computeFrechetMatrix distanceEvaluations", n, m, dimension));
+            }
+        }
+    }
+
+    /* @brief Scopes nest and restore their predecessor; calls outside every scope record nothing. */
+    template <typename T>
+    void testScopes(std::mt19937& generator)
+    {
+        Trajectory<T> a, b;
+        randomPair(3, generator, a, b);
+        const TrajectoryView<T> viewA = a.view(), viewB = b.view();
+        const std::uint64_t cells = static_cast<std::uint64_t>(a.size()) * b.size();
+
+        check(DistanceMetrics::activeStats() == nullptr, describe<T>("no stats are active outside a scope", a.size(), b.size(), 3));
+        Stats outer, inner;
+        {
+            StatsScope outerScope(outer);
+            hausdorffDistance(viewA, viewB);
+            {
+                StatsScope innerScope(inner);
+                check(DistanceMetrics::activeStats() == &inner, describe<T>("the innermost scope is active", a.size(), b.size(), 3));
+                hausdorffDistance(viewA, viewB);
+                hausdorffDistance(viewA, viewB);
+            }
+            check(DistanceMetrics::activeStats() == &outer, describe<T>("the outer scope is restored", a.size(), b.size(), 3));
+            hausdorffDistance(viewA, viewB);
+        }
+        hausdorffDistance(viewA, viewB);
+        check(DistanceMetrics::activeStats() == nullptr, describe<T>("no stats are active after the scopes", a.size(), b.size(), 3));
+        check(outer.possibleEvaluations == 2 * cells && inner.possibleEvaluations == 2 * cells,
+              describe<T>("each scope counts only the calls made while it was innermost", a.size(), b.size(), 3));
+
+        outer.reset();
+        check(outer.possibleEvaluations == 0 && outer.distanceEvaluations == 0 && outer.peakMatrixBytes == 0 && outer.evaluationRatio() == 0.0,
+              describe<T>("Stats::reset", a.size(), b.size(), 3));
+    }
+};
+
+int main()
+{
+    std::mt19937 generator(20216);
+    testHausdorff<float>(generator);
+    testHausdorff<double>(generator);
+    testFrechet<float>(generator);
+    testFrechet<double>(generator);
+    testScopes<float>(generator);
+    testScopes<double>(generator);
+    return Reference::report("stats_test");
+}
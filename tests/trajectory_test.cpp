@@ -0,0 +1,114 @@
+/*  Trajectory container and view tests
+    Copyright (C) 2021 J. Tyler
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Common/Trajectory.hpp"
+#include "tests/Reference.hpp"
+
+/* Checks that every way of building or viewing a trajectory addresses the same coordinates. */
+namespace
+{
+    using DistanceMetrics::Layout;
+    using DistanceMetrics::Trajectory;
+    using DistanceMetrics::TrajectoryView;
+    using Reference::check;
+
+    /* @brief Whether two point sets hold the same coordinates. */
+    template <typename T, typename PointSet>
+    bool sameCoordinates(const TrajectoryView<T>& expected, const PointSet& actual)
+    {
+        if (actual.size() != expected.size() || actual.dimension() != expected.dimension()) return false;
+        for (std::size_t i = 0; i < expected.size(); ++i)
+        {
+            for (std::size_t k = 0; k < expected.dimension(); ++k)
+            {
+                if (actual(i, k) != expected(i, k)) return false;
+            }
+        }
+        return true;
+    }
+
+    /* @brief The layouts, copies and adapters of one random trajectory per dimension. */
+    template <typename T>
+    void testLayouts(std::mt19937& generator)
+    {
+        for (std::size_t dimension : Reference::dimensions)
+        {
+            const Trajectory<T> walk = Reference::randomWalk<T>(1 + generator() % 30, dimension, generator);
+            const TrajectoryView<T> view = walk.view();
+            const std::size_t n = walk.size();
+            const std::string where = " (dimension = " + std::to_string(dimension) + ")";
+
+            check(view.isRowMajor() && view.pointStride() == static_cast<std::ptrdiff_t>(dimension) && view.point(n - 1) == &walk(n - 1, 0),
+                  "row-major view strides" + where);
+            const Trajectory<T> columns(view, Layout::StructureOfArrays);
+            check(columns.layout() == Layout::StructureOfArrays && sameCoordinates(view, columns) && sameCoordinates(view, columns.view()),
+                  "structure-of-arrays copy" + where);
+            check(sameCoordinates(view, DistanceMetrics::makeStructureOfArraysView(columns.data(), n, dimension)), "makeStructureOfArraysView" + where);
+            check(sameCoordinates(view, DistanceMetrics::makeView(walk.data(), n, dimension)), "makeView of a raw array" + where);
+            const std::ptrdiff_t size = static_cast<std::ptrdiff_t>(sizeof(T));
+            check(sameCoordinates(view, DistanceMetrics::makeBufferView(columns.data(), n, dimension, size, size * static_cast<std::ptrdiff_t>(n))),
+                  "makeBufferView of a column-major buffer" + where);
+            check(Reference::throws([&] { DistanceMetrics::makeBufferView(walk.data(), n, dimension, size + 1, size); }), "makeBufferView rejects a ragged stride" + where);
+
+            /* A view of every other point, and views of its parts */
+            const TrajectoryView<T> strided(walk.data(), (n + 1) / 2, dimension, 2 * static_cast<std::ptrdiff_t>(dimension), 1);
+            bool everyOther = strided.size() == (n + 1) / 2;
+            for (std::size_t i = 0; i < strided.size() && everyOther; ++i) everyOther = strided(i, dimension - 1) == walk(2 * i, dimension - 1);
+            check(everyOther, "strided view" + where);
+            const std::size_t first = n / 3, count = n - first;
+            const TrajectoryView<T> part = view.subView(first, count), columnPart = columns.view().subView(first, count);
+            bool parts = part.size() == count && columnPart.size() == count;
+            for (std::size_t i = 0; i < count && parts; ++i) parts = part(i, 0) == walk(first + i, 0) && columnPart(i, dimension - 1) == walk(first + i, dimension - 1);
+            check(parts, "subView of both layouts" + where);
+            bool outOfRange = false;
+            try
+            {
+                view.subView(first, count + 1);
+            }
+            catch (const std::out_of_range&)
+            {
+                outOfRange = true;
+            }
+            check(outOfRange, "subView past the end throws" + where);
+
+            const std::vector<std::vector<T>> nested = Reference::toNested(view);
+            check(sameCoordinates(view, DistanceMetrics::NestedView<T>(nested)) && sameCoordinates(view, Trajectory<T>(nested)), "nested vectors" + where);
+
+            Trajectory<T> grown(dimension);
+            grown.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) grown.push_back(view.point(i));
+            check(sameCoordinates(view, grown.view()), "push_back" + where);
+            check(Reference::throws([&] { grown.push_back(std::vector<T>(dimension + 1)); }) && grown.size() == n, "push_back of another dimension throws" + where);
+            Trajectory<T> columnsGrown(dimension, Layout::StructureOfArrays);
+            check(Reference::throws([&] { columnsGrown.push_back(view.point(0)); }), "push_back to a structure-of-arrays trajectory throws" + where);
+        }
+        std::vector<std::vector<T>> ragged = { { T(0), T(1) }, { T(2) } };
+        check(Reference::throws([&] { Trajectory<T> trajectory(ragged); }), "Trajectory of ragged vectors throws");
+    }
+};
+
+int main()
+{
+    std::mt19937 generator(20210);
+    testLayouts<float>(generator);
+    testLayouts<double>(generator);
+    return Reference::report("trajectory_test");
+}